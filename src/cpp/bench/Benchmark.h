@@ -0,0 +1,508 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "core/clock.h"
+#include "core/constants.h"
+#include "core/json.h"
+#include "core/types.h"
+
+#include <Poco/DateTimeFormat.h>
+#include <Poco/DateTimeFormatter.h>
+#include <Poco/Environment.h>
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+#include <Poco/RegularExpression.h>
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+/**
+ * Prevents the compiler from optimizing away the computation of \p value.
+ */
+template<typename T> inline void doNotOptimize(const T& value)
+{
+    __asm__ __volatile__ ("" : : "r" (&value) : "memory");
+}
+
+/**
+ * The iteration control and the measurements of a single benchmark run.
+ *
+ * A benchmark repeats its measured operation while keepRunning() returns
+ * true. The timer starts with the first call and stops with the last one, so
+ * the setup before the loop and the teardown after it are not measured.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class BenchmarkState
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param iterations The number of iterations of the run.
+     */
+    BenchmarkState(I64u iterations) :
+        _iterations(iterations),
+        _next(0),
+        _running(false),
+        _realStart(0),
+        _cpuStart(0),
+        _realNanos(0),
+        _cpuNanos(0),
+        _items(0),
+        _bytes(0),
+        _skipped(false)
+    {
+    }
+
+    /**
+     * Returns true while there are iterations left.
+     */
+    bool keepRunning()
+    {
+        if (_next < _iterations)
+        {
+            if (_next++ == 0)
+            {
+                resumeTiming();
+            }
+            return true;
+        }
+
+        pauseTiming();
+        return false;
+    }
+
+    /**
+     * Stops the timer, e.g. to exclude per-iteration setup from the
+     * measurement.
+     */
+    void pauseTiming()
+    {
+        if (_running)
+        {
+            _realNanos += monotonicNanos() - _realStart;
+            _cpuNanos += threadCpuNanos() - _cpuStart;
+            _running = false;
+        }
+    }
+
+    /**
+     * Restarts the timer stopped by pauseTiming().
+     */
+    void resumeTiming()
+    {
+        if (!_running)
+        {
+            _cpuStart = threadCpuNanos();
+            _realStart = monotonicNanos();
+            _running = true;
+        }
+    }
+
+    /**
+     * Returns the number of iterations of the run.
+     */
+    I64u iterations() const
+    {
+        return _iterations;
+    }
+
+    /**
+     * Sets the number of items (e.g. records) processed by the run.
+     */
+    void itemsProcessed(I64u items)
+    {
+        _items = items;
+    }
+
+    /**
+     * Sets the number of bytes processed by the run.
+     */
+    void bytesProcessed(I64u bytes)
+    {
+        _bytes = bytes;
+    }
+
+    /**
+     * Attaches a free-form label to the result of the run.
+     */
+    void label(const string& label)
+    {
+        _label = label;
+    }
+
+    /**
+     * Marks the benchmark as not applicable, e.g. because the measured
+     * component is not available on this host.
+     */
+    void skip(const string& reason)
+    {
+        _skipped = true;
+        _label = reason;
+    }
+
+    I64u realNanos() const
+    {
+        return _realNanos;
+    }
+
+    I64u cpuNanos() const
+    {
+        return _cpuNanos;
+    }
+
+    I64u items() const
+    {
+        return _items;
+    }
+
+    I64u bytes() const
+    {
+        return _bytes;
+    }
+
+    const string& label() const
+    {
+        return _label;
+    }
+
+    bool skipped() const
+    {
+        return _skipped;
+    }
+
+private:
+
+    I64u _iterations;
+
+    I64u _next;
+
+    bool _running;
+
+    I64u _realStart;
+
+    I64u _cpuStart;
+
+    I64u _realNanos;
+
+    I64u _cpuNanos;
+
+    I64u _items;
+
+    I64u _bytes;
+
+    string _label;
+
+    bool _skipped;
+};
+
+/**
+ * An abstract base for all benchmarks.
+ *
+ * Benchmark names are hierarchical, with '/' separating the measured
+ * component from the measured operation (e.g.
+ * <tt>random/HashRandomStream/next</tt>).
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class Benchmark
+{
+public:
+
+    Benchmark(const string& name) :
+        _name(name)
+    {
+    }
+
+    virtual ~Benchmark()
+    {
+    }
+
+    /**
+     * Returns the name of the benchmark.
+     */
+    const string& name() const
+    {
+        return _name;
+    }
+
+    /**
+     * Runs the benchmark for state.iterations() iterations.
+     */
+    virtual void run(BenchmarkState& state) = 0;
+
+private:
+
+    const string _name;
+};
+
+/**
+ * A collection of benchmarks that are run in the order they were added.
+ *
+ * The number of iterations of each benchmark is increased until a run takes
+ * at least the minimal time, then the benchmark is repeated with that number
+ * of iterations. The results are written as JSON in the format of the Google
+ * Benchmark library, so existing tools for comparing benchmark results can
+ * be used to detect regressions between two toolkit versions.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class BenchmarkSuite
+{
+public:
+
+    BenchmarkSuite()
+    {
+    }
+
+    ~BenchmarkSuite()
+    {
+        for (vector<Benchmark*>::iterator it = _benchmarks.begin(); it != _benchmarks.end(); ++it)
+        {
+            delete *it;
+        }
+    }
+
+    /**
+     * Adds a benchmark to the suite. The suite takes ownership of the
+     * benchmark.
+     */
+    void add(Benchmark* benchmark)
+    {
+        _benchmarks.push_back(benchmark);
+    }
+
+    /**
+     * Returns the number of benchmarks in the suite.
+     */
+    size_t size() const
+    {
+        return _benchmarks.size();
+    }
+
+    /**
+     * Runs all benchmarks whose name matches the \p filter regular expression
+     * (an empty filter matches all benchmarks) and writes the results to
+     * \p out.
+     *
+     * @param filter A regular expression selecting the benchmarks to run.
+     * @param minTime The minimal duration of a run in seconds.
+     * @param repetitions The number of measured runs of each benchmark.
+     * @param out The stream receiving the JSON results.
+     * @param logger A logger receiving a human-readable result summary.
+     */
+    void run(const string& filter, Decimal minTime, I32u repetitions, ostream& out, Logger& logger)
+    {
+        RegularExpression pattern(filter.empty() ? "." : filter);
+        repetitions = std::max(repetitions, static_cast<I32u>(1));
+
+        out << "{\n";
+        out << "  \"context\": {\n";
+        out << "    \"date\": " << jsonString(DateTimeFormatter::format(Timestamp(), DateTimeFormat::ISO8601_FORMAT)) << ",\n";
+        out << "    \"host_name\": " << jsonString(Environment::nodeName()) << ",\n";
+        out << "    \"num_cpus\": " << Environment::processorCount() << ",\n";
+        out << "    \"application\": " << jsonString(Constant::APP_NAME) << ",\n";
+        out << "    \"version\": " << jsonString(Constant::APP_VERSION) << "\n";
+        out << "  },\n";
+        out << "  \"benchmarks\": [";
+
+        bool first = true;
+        for (vector<Benchmark*>::iterator it = _benchmarks.begin(); it != _benchmarks.end(); ++it)
+        {
+            Benchmark& benchmark = **it;
+
+            RegularExpression::Match match;
+            if (pattern.match(benchmark.name(), 0, match) == 0)
+            {
+                continue;
+            }
+
+            // grow the number of iterations until a run takes long enough
+            I64u iterations = 1;
+            BenchmarkState probe(iterations);
+            benchmark.run(probe);
+
+            while (!probe.skipped() && probe.realNanos() < minTime * 1000000000.0 && iterations < MAX_ITERATIONS)
+            {
+                Decimal multiplier = minTime * 1400000000.0 / std::max(probe.realNanos(), static_cast<I64u>(1));
+                multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+                iterations = static_cast<I64u>(iterations * multiplier);
+                iterations = iterations < MAX_ITERATIONS ? iterations : MAX_ITERATIONS;
+
+                probe = BenchmarkState(iterations);
+                benchmark.run(probe);
+            }
+
+            if (probe.skipped())
+            {
+                logger.information(format("%-64s skipped (%s)", benchmark.name(), probe.label()));
+                continue;
+            }
+
+            // the last probe run counts as the first repetition
+            vector<BenchmarkState> runs(1, probe);
+            while (runs.size() < repetitions)
+            {
+                runs.push_back(BenchmarkState(iterations));
+                benchmark.run(runs.back());
+            }
+
+            for (size_t i = 0; i < runs.size(); i++)
+            {
+                const BenchmarkState& state = runs[i];
+                write(out, first, benchmark.name(), "iteration", "", i, runs.size(), state.iterations(), state.realNanos(), state.cpuNanos(), state.items(), state.bytes(), state.label());
+            }
+
+            if (runs.size() > 1)
+            {
+                writeAggregates(out, first, benchmark.name(), runs);
+            }
+
+            const BenchmarkState& state = runs.back();
+            Decimal nanos = state.realNanos() / static_cast<Decimal>(state.iterations());
+            Decimal seconds = std::max(state.realNanos(), static_cast<I64u>(1)) / 1000000000.0;
+            logger.information(format("%-64s %14.1f ns %14.0f items/s %10.1f MB/s", benchmark.name(), nanos, state.items() / seconds, state.bytes() / seconds / 1048576.0));
+        }
+
+        out << "\n  ]\n";
+        out << "}\n";
+    }
+
+private:
+
+    BenchmarkSuite(const BenchmarkSuite&);
+
+    BenchmarkSuite& operator=(const BenchmarkSuite&);
+
+    /**
+     * An upper bound for the number of iterations of a single run.
+     */
+    static const I64u MAX_ITERATIONS = 1000000000;
+
+    /**
+     * Writes the mean, median and standard deviation of the per-iteration
+     * times of the given \p runs.
+     */
+    static void writeAggregates(ostream& out, bool& first, const string& name, const vector<BenchmarkState>& runs)
+    {
+        vector<Decimal> real, cpu;
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            real.push_back(runs[i].realNanos() / static_cast<Decimal>(runs[i].iterations()));
+            cpu.push_back(runs[i].cpuNanos() / static_cast<Decimal>(runs[i].iterations()));
+        }
+
+        const BenchmarkState& last = runs.back();
+        Decimal scale = static_cast<Decimal>(last.iterations());
+
+        write(out, first, name, "aggregate", "mean", 0, runs.size(), last.iterations(), mean(real) * scale, mean(cpu) * scale, last.items(), last.bytes(), "");
+        write(out, first, name, "aggregate", "median", 0, runs.size(), last.iterations(), median(real) * scale, median(cpu) * scale, last.items(), last.bytes(), "");
+        write(out, first, name, "aggregate", "stddev", 0, runs.size(), last.iterations(), stddev(real) * scale, stddev(cpu) * scale, 0, 0, "");
+    }
+
+    /**
+     * Writes a single result object. Times are reported per iteration.
+     */
+    static void write(ostream& out, bool& first, const string& name, const string& type, const string& aggregate, size_t index, size_t repetitions, I64u iterations, Decimal realNanos, Decimal cpuNanos, I64u items, I64u bytes, const string& label)
+    {
+        string fullName = aggregate.empty() ? name : name + "_" + aggregate;
+        Decimal seconds = realNanos / 1000000000.0;
+
+        out << (first ? "\n" : ",\n");
+        out << "    {\n";
+        out << "      \"name\": " << jsonString(fullName) << ",\n";
+        out << "      \"run_name\": " << jsonString(name) << ",\n";
+        out << "      \"run_type\": " << jsonString(type) << ",\n";
+        if (!aggregate.empty())
+        {
+            out << "      \"aggregate_name\": " << jsonString(aggregate) << ",\n";
+        }
+        out << "      \"repetitions\": " << repetitions << ",\n";
+        out << "      \"repetition_index\": " << index << ",\n";
+        out << "      \"iterations\": " << iterations << ",\n";
+        out << "      \"real_time\": " << jsonNumber(realNanos / iterations) << ",\n";
+        out << "      \"cpu_time\": " << jsonNumber(cpuNanos / iterations) << ",\n";
+        out << "      \"time_unit\": \"ns\"";
+        if (items > 0 && seconds > 0)
+        {
+            out << ",\n      \"items_per_second\": " << jsonNumber(items / seconds);
+        }
+        if (bytes > 0 && seconds > 0)
+        {
+            out << ",\n      \"bytes_per_second\": " << jsonNumber(bytes / seconds);
+        }
+        if (!label.empty())
+        {
+            out << ",\n      \"label\": " << jsonString(label);
+        }
+        out << "\n    }";
+
+        first = false;
+    }
+
+    static Decimal mean(const vector<Decimal>& values)
+    {
+        Decimal sum = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            sum += values[i];
+        }
+        return sum / values.size();
+    }
+
+    static Decimal median(vector<Decimal> values)
+    {
+        sort(values.begin(), values.end());
+        size_t n = values.size();
+        return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    }
+
+    static Decimal stddev(const vector<Decimal>& values)
+    {
+        Decimal m = mean(values), sum = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            sum += (values[i] - m) * (values[i] - m);
+        }
+        return values.size() > 1 ? std::sqrt(sum / (values.size() - 1)) : 0;
+    }
+
+    vector<Benchmark*> _benchmarks;
+};
+
+/** @}*/// add to bench group
+} // namespace Myriad
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+
+#include "bench/Benchmark.h"
+#include "bench/BenchmarkFrontend.h"
+#include "bench/PrFunctionBenchmark.h"
+#include "bench/RandomStreamBenchmark.h"
+#include "communication/Notifications.h"
+#include "generator/GeneratorSubsystem.h"
+
+#include <string>
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Format.h>
+#include <Poco/Path.h>
+
+using std::string;
+using Poco::format;
+using Poco::Exception;
+using Poco::File;
+using Poco::FileOutputStream;
+using Poco::Path;
+using Poco::Util::Application;
+using Poco::Util::Option;
+using Poco::Util::OptionSet;
+
+namespace Myriad {
+
+BenchmarkFrontend::BenchmarkFrontend() :
+    Frontend()
+{
+}
+
+void BenchmarkFrontend::defineOptions(OptionSet& options)
+{
+    Frontend::defineOptions(options);
+
+    options.addOption(Option("bench", "b", "run the microbenchmarks matching the optional <regex>")
+	        .required(false)
+	        .repeatable(false)
+	        .argument("<regex>", false)
+	        .binding("application.bench"));
+}
+
+int BenchmarkFrontend::main(const std::vector<std::string>& args)
+{
+    if (_metaInfoRequested)
+    {
+        return Application::EXIT_OK;
+    }
+
+    if (_excCaught)
+    {
+        return Application::EXIT_SOFTWARE;
+    }
+
+    NotificationCenter& notificationCenter = NotificationCenter::defaultCenter();
+
+    try
+    {
+        GeneratorSubsystem& generatorSubsystem = getSubsystem<GeneratorSubsystem> ();
+        GeneratorConfig& config = generatorSubsystem.config();
+
+        BenchmarkSuite suite;
+
+        registerRandomStreamBenchmarks(suite);
+        registerPrFunctionBenchmarks(suite);
+        registerProjectBenchmarks(suite, config, generatorSubsystem.generatorPool());
+
+        Path path(config.benchOutput());
+        File(path.parent()).createDirectories();
+
+        FileOutputStream out(path.toString());
+        suite.run(config.benchFilter(), config.benchMinTime(), config.benchRepetitions(), out, _ui);
+        out.close();
+
+        _ui.information(format("Benchmark results written to `%s`", path.toString()));
+    }
+    catch (const Exception& exc)
+    {
+        notificationCenter.postNotification(new ChangeNodeState(NodeState::ABORTED));
+        _ui.fatal(format("Exception caught while running benchmarks: %s", exc.displayText()));
+        return Application::EXIT_SOFTWARE;
+    }
+    catch (const exception& exc)
+    {
+        notificationCenter.postNotification(new ChangeNodeState(NodeState::ABORTED));
+        _ui.fatal(format("Exception caught while running benchmarks: %s", string(exc.what())));
+        return Application::EXIT_SOFTWARE;
+    }
+    catch (...)
+    {
+        notificationCenter.postNotification(new ChangeNodeState(NodeState::ABORTED));
+        _ui.fatal("Exception caught while running benchmarks");
+        return Application::EXIT_SOFTWARE;
+    }
+
+    return Application::EXIT_OK;
+}
+
+} // Myriad namespace
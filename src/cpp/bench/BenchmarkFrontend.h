@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ */
+
+#ifndef BENCHMARKFRONTEND_H_
+#define BENCHMARKFRONTEND_H_
+
+#include "core/Frontend.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+using namespace Poco::Util;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+// forward declarations
+class BenchmarkSuite;
+class GeneratorConfig;
+class GeneratorPool;
+
+/**
+ * Adds the benchmarks of the functions and record sequences of the current
+ * project to the given \p suite. Generated by the record compiler into
+ * <tt>bench/base/BaseBenchmarks.cpp</tt>.
+ *
+ * @param suite The benchmark suite to extend.
+ * @param config The configuration holding the project functions.
+ * @param generatorPool The pool holding the record sequence generators.
+ */
+void registerProjectBenchmarks(BenchmarkSuite& suite, GeneratorConfig& config, GeneratorPool& generatorPool);
+
+/**
+ * A command line interface (CLI) frontend for the microbenchmarks of a
+ * generator.
+ *
+ * The BenchmarkFrontend is instantiated in the main function of the
+ * benchmark binary built by `make bench`. It accepts the options of the
+ * Frontend and initializes the same subsystems, but runs the benchmark suite
+ * instead of the generation process. The data generator binary itself does
+ * not contain any benchmark code.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class BenchmarkFrontend: public Frontend
+{
+public:
+
+    /**
+     * Default constructor.
+     */
+    BenchmarkFrontend();
+
+protected:
+
+    /**
+     * Registers the options of the Frontend and the '--bench' option
+     * selecting the executed benchmarks.
+     *
+     * @param options A reference to the OptionSet used by the application.
+     */
+    void defineOptions(OptionSet& options);
+
+    /**
+     * Runs the microbenchmarks selected by the {application.bench} config
+     * parameter.
+     *
+     * The benchmark suite consists of the PRNG and analytic probability
+     * function benchmarks, the benchmarks of the functions configured for
+     * the current project, and the inspector and output collector benchmarks
+     * of all registered generators. The results are written as JSON in the
+     * Google Benchmark format to the {application.bench-output} file.
+     */
+    int main(const std::vector<std::string>& args);
+};
+
+/** @}*/// add to bench group
+} // Myriad namespace
+
+#endif /* BENCHMARKFRONTEND_H_ */
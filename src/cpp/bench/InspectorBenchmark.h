@@ -0,0 +1,156 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef INSPECTORBENCHMARK_H_
+#define INSPECTORBENCHMARK_H_
+
+#include "bench/Benchmark.h"
+#include "generator/InvalidRecordException.h"
+#include "generator/RandomSequenceGenerator.h"
+#include "record/AbstractRecord.h"
+#include "runtime/predicate/EqualityPredicate.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/Format.h>
+
+#include <string>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+/**
+ * Measures the random access methods of the RandomSequenceInspector of a
+ * record sequence: the construction of single records with at(), and the
+ * inverse setter chain evaluation of filter() for an equality predicate with
+ * a bound genID.
+ *
+ * The accessed genIDs are spread over the whole sequence, so the measured
+ * costs include the PRNG seeks of the setter chain. Invalid records count
+ * as regular iterations and are reported in the result label.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class RecordType>
+class InspectorBenchmark: public Benchmark
+{
+public:
+
+    /**
+     * The measured inspector method.
+     */
+    enum Operation
+    {
+        AT, FILTER
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param generator The generator of the inspected record sequence.
+     * @param operation The measured inspector method.
+     */
+    InspectorBenchmark(RandomSequenceGenerator<RecordType>& generator, Operation operation) :
+        Benchmark(format("inspector/%s/%s", generator.name(), string(operation == AT ? "at" : "filter"))),
+        _generator(generator),
+        _operation(operation)
+    {
+    }
+
+    /**
+     * Adds an at() and a filter() benchmark for the inspector of the
+     * \p generator to the \p suite.
+     */
+    static void registerAll(BenchmarkSuite& suite, RandomSequenceGenerator<RecordType>& generator)
+    {
+        suite.add(new InspectorBenchmark<RecordType>(generator, AT));
+        suite.add(new InspectorBenchmark<RecordType>(generator, FILTER));
+    }
+
+    void run(BenchmarkState& state)
+    {
+        const I64u cardinality = _generator.cardinality();
+        if (cardinality == 0)
+        {
+	        state.skip("empty sequence");
+	        return;
+        }
+
+        const I64u stride = cardinality > STRIDE ? static_cast<I64u>(STRIDE) : 1;
+        I64u genID = 0, invalid = 0;
+
+        if (_operation == AT)
+        {
+	        RandomSequenceInspector<RecordType> inspector = _generator.inspector();
+
+	        while (state.keepRunning())
+	        {
+		        try
+		        {
+			        doNotOptimize(inspector.at(genID));
+		        }
+		        catch (const InvalidRecordException&)
+		        {
+			        invalid++;
+		        }
+
+		        genID = (genID + stride) % cardinality;
+	        }
+        }
+        else
+        {
+	        RandomSequenceInspector<RecordType> inspector = _generator.inspector();
+	        EqualityPredicate<RecordType> predicate(_generator.recordFactory());
+
+	        while (state.keepRunning())
+	        {
+		        predicate.reset();
+		        predicate.template fieldValue<RecordTraits<RecordType>::GEN_ID>(genID);
+		        doNotOptimize(inspector.filter(predicate));
+
+		        genID = (genID + stride) % cardinality;
+	        }
+        }
+
+        state.itemsProcessed(state.iterations());
+
+        if (invalid > 0)
+        {
+	        state.label(format("%Lu invalid records", invalid));
+        }
+    }
+
+private:
+
+    /**
+     * The distance between two accessed genIDs.
+     */
+    static const I64u STRIDE = 1000003;
+
+    RandomSequenceGenerator<RecordType>& _generator;
+
+    const Operation _operation;
+};
+
+/** @}*/// add to bench group
+} // namespace Myriad
+
+#endif /* INSPECTORBENCHMARK_H_ */
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef OUTPUTCOLLECTORBENCHMARK_H_
+#define OUTPUTCOLLECTORBENCHMARK_H_
+
+#include "bench/Benchmark.h"
+#include "config/GeneratorConfig.h"
+#include "generator/InvalidRecordException.h"
+#include "generator/RandomSequenceGenerator.h"
+#include "io/OutputCollector.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/File.h>
+#include <Poco/Format.h>
+#include <Poco/Path.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+/**
+ * Measures the output of records of a sequence with a single output
+ * collector configuration (e.g. plain, compressed or memory-mapped files).
+ *
+ * The benchmark uses the first (up to RECORDS) valid records of the sequence
+ * as synthetic input. Each iteration opens a new collector, writes a batch of
+ * BATCH_SIZE records and closes the collector again, so the measured cost
+ * includes the final flush. The output is written below
+ * <tt>${application.output-dir}/bench</tt> and removed after the run.
+ *
+ * Output types that depend on an external consumer (socket, unix, fifo and
+ * shm) are not measured, as their throughput is bound by the consumer.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class RecordType>
+class OutputCollectorBenchmark: public Benchmark
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param generator The generator of the written record sequence.
+     * @param variant The name of the collector configuration.
+     * @param options The output settings passed to the OutputCollector
+     *        factory.
+     */
+    OutputCollectorBenchmark(RandomSequenceGenerator<RecordType>& generator, const string& variant, const OutputOptions& options) :
+        Benchmark(format("output/%s/%s", generator.name(), variant)),
+        _generator(generator),
+        _options(options)
+    {
+    }
+
+    /**
+     * Adds a benchmark for each applicable collector configuration of the
+     * \p generator output to the \p suite.
+     */
+    static void registerAll(BenchmarkSuite& suite, RandomSequenceGenerator<RecordType>& generator)
+    {
+        GeneratorConfig& config = generator.config();
+
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "void", OutputOptions("void")));
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file", OutputOptions("file")));
+
+        // columnar record types are always written by the ColumnarOutputCollector
+        ColumnarRowGroup layout;
+        if (AbstractOutputCollector<RecordType>::describe(layout))
+        {
+	        return;
+        }
+
+        const OutputOptions defaults = OutputOptions::fromConfig(config, generator.name());
+        OutputOptions options;
+
+        options.compression = CompressionOptions("gzip", config.outputCompressionLevel(), config.outputCompressionThreads());
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-gzip", options));
+#if defined(MYRIAD_WITH_LZ4)
+        options.compression = CompressionOptions("lz4", 1, config.outputCompressionThreads());
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-lz4", options));
+#endif
+
+        options = OutputOptions();
+        options.rolling = RollingOptions(0, BATCH_SIZE / 4);
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-rolling", options));
+
+        if (defaults.partitioning.enabled())
+        {
+	        options = OutputOptions();
+	        options.partitioning = defaults.partitioning;
+	        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-partitioned", options));
+        }
+
+        options = OutputOptions();
+        options.writer = defaults.writer;
+        options.writer.backend = "uring";
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-uring", options));
+
+        options = OutputOptions();
+        options.writer = WriterOptions("mmap");
+        options.mapping = MappingOptions(BATCH_SIZE, config.outputMappingWindow());
+        suite.add(new OutputCollectorBenchmark<RecordType>(generator, "file-mmap", options));
+    }
+
+    void run(BenchmarkState& state)
+    {
+        if (_options.writer.enabled() && !UringFileWriter::available())
+        {
+	        state.skip("io_uring is not available");
+	        return;
+        }
+
+        prepareRecords();
+
+        if (_records.empty())
+        {
+	        state.skip("no valid records");
+	        return;
+        }
+
+        Path directory(_generator.config().getString("application.output-dir"));
+        directory.pushDirectory("bench");
+        File(directory).createDirectories();
+
+        Path outputPath(directory, _generator.name());
+        I64u bytes = 0;
+
+        while (state.keepRunning())
+        {
+	        AutoPtr< AbstractOutputCollector<RecordType> > out = OutputCollector<RecordType>::factory(outputPath, "bench.collector." + _generator.name(), _options);
+
+	        out->open();
+	        for (size_t i = 0, j = 0; i < BATCH_SIZE; i++, j = (j + 1 < _records.size()) ? j + 1 : 0)
+	        {
+		        out->collect(*_records[j]);
+	        }
+	        out->close();
+
+	        bytes += out->writtenBytes();
+        }
+
+        state.itemsProcessed(state.iterations() * BATCH_SIZE);
+        state.bytesProcessed(bytes);
+
+        File(directory).remove(true);
+    }
+
+private:
+
+    /**
+     * Fetches the synthetic input records on the first run.
+     */
+    void prepareRecords()
+    {
+        if (!_records.empty())
+        {
+	        return;
+        }
+
+        RandomSequenceInspector<RecordType> inspector = _generator.inspector();
+        const I64u end = inspector.cardinality() < 4 * RECORDS ? inspector.cardinality() : 4 * RECORDS;
+
+        for (I64u genID = 0; genID < end && _records.size() < RECORDS; genID++)
+        {
+	        try
+	        {
+		        _records.push_back(inspector.at(genID));
+	        }
+	        catch (const InvalidRecordException&)
+	        {
+	        }
+        }
+    }
+
+    /**
+     * The maximal number of distinct input records.
+     */
+    static const size_t RECORDS = 4096;
+
+    /**
+     * The number of records written per iteration.
+     */
+    static const size_t BATCH_SIZE = 65536;
+
+    RandomSequenceGenerator<RecordType>& _generator;
+
+    const OutputOptions _options;
+
+    vector< AutoPtr<RecordType> > _records;
+};
+
+/** @}*/// add to bench group
+} // namespace Myriad
+
+#endif /* OUTPUTCOLLECTORBENCHMARK_H_ */
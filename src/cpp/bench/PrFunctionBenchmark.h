@@ -0,0 +1,138 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef PRFUNCTIONBENCHMARK_H_
+#define PRFUNCTIONBENCHMARK_H_
+
+#include "bench/Benchmark.h"
+#include "math/probability/Probability.h"
+#include "math/random/RandomStream.h"
+
+#include <Poco/AutoPtr.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+/**
+ * Measures the sample() method of a probability function of the concrete
+ * type \p FunctionType.
+ *
+ * The random arguments are drawn from a RandomStream before the measurement,
+ * so only the inverse CDF lookup of the function is measured. Conditional
+ * functions are sampled with the lower bounds of their condition ranges in
+ * turn.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class FunctionType>
+class PrFunctionBenchmark: public Benchmark
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param name The name of the function used in the benchmark name.
+     * @param function The measured function (shared with the caller).
+     */
+    PrFunctionBenchmark(const string& name, FunctionType& function) :
+        Benchmark("probability/" + name + "/sample"),
+        _function(&function, true),
+        _random(RANDOM_VALUES)
+    {
+        RandomStream random("bench");
+        for (size_t i = 0; i < RANDOM_VALUES; i++)
+        {
+	        _random[i] = random();
+        }
+    }
+
+    void run(BenchmarkState& state)
+    {
+        for (size_t i = 0; state.keepRunning(); i++)
+        {
+	        sample(*_function, _random[i % RANDOM_VALUES], i);
+        }
+
+        state.itemsProcessed(state.iterations());
+    }
+
+private:
+
+    /**
+     * Samples a univariate function.
+     */
+    template<class F> static void sample(const F& function, Decimal r, size_t i)
+    {
+        doNotOptimize(function.sample(r));
+    }
+
+    /**
+     * Samples a conditional function with the \p i-th condition.
+     */
+    template<typename T1, typename T2> static void sample(const ConditionalCombinedPrFunction<T1, T2>& function, Decimal r, size_t i)
+    {
+        const size_t n = function.numberOfConditions();
+        if (n > 0)
+        {
+	        doNotOptimize(function.sample(r, function.condition(i % n).min()));
+        }
+    }
+
+    /**
+     * The number of pre-drawn random values (a power of two).
+     */
+    static const size_t RANDOM_VALUES = 4096;
+
+    AutoPtr<FunctionType> _function;
+
+    vector<Decimal> _random;
+};
+
+/**
+ * Adds sample() benchmarks for the analytic probability functions with fixed
+ * parameters to the given \p suite. File based functions are benchmarked
+ * with the specifications of the current project (see
+ * registerProjectBenchmarks()).
+ */
+inline void registerPrFunctionBenchmarks(BenchmarkSuite& suite)
+{
+    AutoPtr< UniformPrFunction<I64u> > uniform(new UniformPrFunction<I64u>("UniformPrFunction", 0, 1000000));
+    suite.add(new PrFunctionBenchmark< UniformPrFunction<I64u> >(uniform->name(), *uniform));
+
+    AutoPtr<NormalPrFunction> normal(new NormalPrFunction("NormalPrFunction", 0, 1));
+    suite.add(new PrFunctionBenchmark<NormalPrFunction>(normal->name(), *normal));
+
+    AutoPtr<BoundedNormalPrFunction> boundedNormal(new BoundedNormalPrFunction("BoundedNormalPrFunction", 0, 1, -2, 2));
+    suite.add(new PrFunctionBenchmark<BoundedNormalPrFunction>(boundedNormal->name(), *boundedNormal));
+
+    AutoPtr<ParetoPrFunction> pareto(new ParetoPrFunction("ParetoPrFunction", 1, 1));
+    suite.add(new PrFunctionBenchmark<ParetoPrFunction>(pareto->name(), *pareto));
+}
+
+/** @}*/// add to bench group
+} // namespace Myriad
+
+#endif /* PRFUNCTIONBENCHMARK_H_ */
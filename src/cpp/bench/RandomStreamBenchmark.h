@@ -0,0 +1,134 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef RANDOMSTREAMBENCHMARK_H_
+#define RANDOMSTREAMBENCHMARK_H_
+
+#include "bench/Benchmark.h"
+#include "math/random/CompoundEICG.h"
+#include "math/random/HashRandomStream.h"
+
+#include <Poco/Format.h>
+
+#include <string>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup bench
+ * @{*/
+
+/**
+ * Measures the sequential (next()), random access (at()) and chunk seek
+ * (atChunk() followed by next()) operations of a hierarchical PRNG.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class RNG>
+class RandomStreamBenchmark: public Benchmark
+{
+public:
+
+    /**
+     * The measured PRNG operation.
+     */
+    enum Operation
+    {
+        NEXT, AT, AT_CHUNK
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param rngName The name of the PRNG type used in the benchmark name.
+     * @param operation The measured operation.
+     */
+    RandomStreamBenchmark(const string& rngName, Operation operation) :
+        Benchmark(format("random/%s/%s", rngName, string(operation == NEXT ? "next" : operation == AT ? "at" : "atChunk"))),
+        _operation(operation)
+    {
+    }
+
+    /**
+     * Adds the benchmarks for all operations of the \p RNG to the \p suite.
+     */
+    static void registerAll(BenchmarkSuite& suite, const string& rngName)
+    {
+        suite.add(new RandomStreamBenchmark<RNG>(rngName, NEXT));
+        suite.add(new RandomStreamBenchmark<RNG>(rngName, AT));
+        suite.add(new RandomStreamBenchmark<RNG>(rngName, AT_CHUNK));
+    }
+
+    void run(BenchmarkState& state)
+    {
+        RNG random("bench");
+        Decimal sum = 0;
+
+        if (_operation == NEXT)
+        {
+	        while (state.keepRunning())
+	        {
+		        sum += random.next();
+	        }
+        }
+        else if (_operation == AT)
+        {
+	        // jump around instead of reading consecutive positions
+	        for (I64u i = 0; state.keepRunning(); i += STRIDE)
+	        {
+		        sum += random.at(i);
+	        }
+        }
+        else
+        {
+	        for (I64u i = 0; state.keepRunning(); i++)
+	        {
+		        sum += random.atChunk(i).next();
+	        }
+        }
+
+        doNotOptimize(sum);
+        state.itemsProcessed(state.iterations());
+    }
+
+private:
+
+    /**
+     * The distance between two positions read in the random access
+     * benchmark.
+     */
+    static const I64u STRIDE = 1000003;
+
+    const Operation _operation;
+};
+
+/**
+ * Adds the PRNG benchmarks for the HashRandomStream and the CompoundEICG to
+ * the given \p suite.
+ */
+inline void registerRandomStreamBenchmarks(BenchmarkSuite& suite)
+{
+    RandomStreamBenchmark<HashRandomStream>::registerAll(suite, "HashRandomStream");
+    RandomStreamBenchmark<CompoundEICG>::registerAll(suite, "CompoundEICG");
+}
+
+/** @}*/// add to bench group
+} // namespace Myriad
+
+#endif /* RANDOMSTREAMBENCHMARK_H_ */
@@ -16,12 +16,24 @@
  */
 
 #include "communication/CommunicationSubsystem.h"
+#include "communication/ProgressRegistry.h"
+#include "config/AbstractGeneratorConfig.h"
 #include "generator/AbstractSequenceGenerator.h"
 
+#include <sstream>
+#include <vector>
 #include <Poco/Runnable.h>
+#include <Poco/Timestamp.h>
 #include <Poco/Net/HTTPRequest.h>
+#include <Poco/Net/HTTPRequestHandler.h>
+#include <Poco/Net/HTTPRequestHandlerFactory.h>
 #include <Poco/Net/HTTPResponse.h>
 #include <Poco/Net/HTTPClientSession.h>
+#include <Poco/Net/HTTPServerParams.h>
+#include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/HTTPServerResponse.h>
+#include <Poco/Net/ServerSocket.h>
+#include <Poco/Net/SocketAddress.h>
 
 using namespace std;
 using namespace Poco;
@@ -39,10 +51,10 @@ namespace Myriad {
 /**
  * Implements a thread for progress monitoring.
  *
- * The thread periodically posts UpdateProgress notifications to the
- * NotificationCenter to poll all running StageTask instances for their
- * progress. After each update, the thread also shares a new Heartbeat via a
- * shared NotificationQueue.
+ * The thread periodically reads the progress counters of all registered
+ * StageTask instances from the ProgressRegistry and logs the record and byte
+ * throughput since the previous update. After each update, the thread also
+ * shares a new Heartbeat via a shared NotificationQueue.
  *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
@@ -53,8 +65,8 @@ public:
     /**
      * Constructor.
      */
-    ProgressMonitor(NotificationCenter& notificationCenter, NotificationQueue& notificationQueue, NodeState& state, I32u interval) :
-        _notificationCenter(notificationCenter), _notificationQueue(notificationQueue), _state(state), _interval(interval), _logger(Logger::get("progress.monitor")), _ui(Logger::get("ui"))
+    ProgressMonitor(NotificationQueue& notificationQueue, NodeState& state, I32u interval) :
+        _notificationQueue(notificationQueue), _state(state), _interval(interval), _logger(Logger::get("progress.monitor")), _ui(Logger::get("ui"))
     {
     }
 
@@ -73,7 +85,12 @@ public:
 
 private:
 
-    NotificationCenter& _notificationCenter;
+    /**
+     * Updates the task progress of the NodeState and logs the throughput
+     * since the \p last snapshot taken at \p lastTime.
+     */
+    void update(ProgressSnapshot& last, Timestamp& lastTime);
+
     NotificationQueue& _notificationQueue;
 
     NodeState& _state;
@@ -87,7 +104,8 @@ private:
  * An heartbeat client thread.
  *
  * The thread consumes heartbeat notifications and forwards them via HTTP to a
- * central coordination service.
+ * central coordination service. If the node generates a partition set, each
+ * heartbeat is forwarded for all node IDs in the set.
  */
 class HeartbeatClient: public Runnable
 {
@@ -100,11 +118,12 @@ public:
      * for shared communication, and the \p host and \p port for connection
      * with the coordination service.
      */
-    HeartbeatClient(NotificationCenter& notificationCenter, NotificationQueue& notificationQueue, const String& host, I16u port) :
+    HeartbeatClient(NotificationCenter& notificationCenter, NotificationQueue& notificationQueue, const String& host, I16u port, const vector<I16u>& nodeIDs) :
         _notificationCenter(notificationCenter),
         _notificationQueue(notificationQueue),
         _serverHost(host),
         _serverPort(port),
+        _nodeIDs(nodeIDs),
         _logger(Logger::get("heartbeat.client")),
         _hb(Logger::get("heartbeat.logger")),
         _ui(Logger::get("ui"))
@@ -132,6 +151,8 @@ private:
     String _serverHost;
     I16u _serverPort;
 
+    vector<I16u> _nodeIDs;
+
     Logger& _logger;
     Logger& _hb;
     Logger& _ui;
@@ -145,6 +166,101 @@ class StopHeartbeatClient : public Notification
 {
 };
 
+/**
+ * A local HTTP endpoint for live node and task metrics.
+ *
+ * Each <tt>GET /metrics</tt> request takes a ProgressRegistry snapshot and
+ * renders it in the Prometheus text exposition format. Task metrics are
+ * labeled with the task name, the generator name, which is the task name
+ * prefix up to the first <tt>::</tt>, and the partition ID, which is the
+ * task name suffix after the <tt>#</tt>. All record, byte and time metrics
+ * are monotonic counters. Rates and the setter chain, serialization and write
+ * shares of the task time are left to the scraper (e.g. with <tt>rate()</tt>),
+ * so any number of clients can query the endpoint without affecting each
+ * other's results.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class MetricsEndpoint: public HTTPRequestHandlerFactory
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    MetricsEndpoint(const NodeState& state) :
+        _state(state)
+    {
+    }
+
+    /**
+     * Creates a handler for the given \p request.
+     */
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+    {
+        return new Handler(*this);
+    }
+
+    /**
+     * Writes the current metrics to \p out.
+     */
+    void write(std::ostream& out);
+
+private:
+
+    /**
+     * Handles a single request.
+     */
+    class Handler: public HTTPRequestHandler
+    {
+    public:
+
+        Handler(MetricsEndpoint& endpoint) :
+	        _endpoint(endpoint)
+        {
+        }
+
+        void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+        {
+	        if (request.getURI() != "/metrics" || request.getMethod() != HTTPRequest::HTTP_GET)
+	        {
+		        response.setStatusAndReason(HTTPResponse::HTTP_NOT_FOUND);
+		        response.send() << "Not found, metrics are served at /metrics\n";
+		        return;
+	        }
+
+	        std::ostringstream body;
+	        _endpoint.write(body);
+
+	        response.setContentType("text/plain; version=0.0.4");
+	        response.setContentLength(static_cast<int>(body.str().size()));
+	        response.send() << body.str();
+        }
+
+    private:
+
+        MetricsEndpoint& _endpoint;
+    };
+
+    /**
+     * Writes the HELP and TYPE lines of a metric family.
+     */
+    static void family(std::ostream& out, const char* name, const char* type, const char* help);
+
+    /**
+     * Returns the label set of the given \p task, followed by the given
+     * \p extra labels.
+     */
+    static string labels(const ProgressSnapshot& task, const string& extra = "");
+
+    /**
+     * Escapes a label value.
+     */
+    static string escape(const string& value);
+
+    const NodeState& _state;
+};
+
 //@}
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -201,6 +317,14 @@ void CommunicationSubsystem::uninitialize()
         _state.currentState = NodeState::READY;
     }
 
+    // stop the metrics endpoint
+    if (_metricsServer != NULL)
+    {
+        _metricsServer->stop();
+        delete _metricsServer;
+        _metricsServer = NULL;
+    }
+
     // close update thread and unset config
     _progressMonitor.join();
     _heartbeatClient.join();
@@ -217,8 +341,24 @@ void CommunicationSubsystem::start()
 {
     try
     {
-        ProgressMonitor* monitor = new ProgressMonitor(_notificationCenter, _notificationQueue, _state, _config->getInt("coordinator.progress.update.interval", 3000));
-        HeartbeatClient* client = new HeartbeatClient(_notificationCenter, _notificationQueue, _config->getString("application.coordinator.host", "localhost"), _config->getInt("application.coordinator.port", 42070));
+        I16u metricsPort = static_cast<I16u>(_config->getInt("application.metrics-port", 0));
+
+        if (metricsPort > 0)
+        {
+	        HTTPServerParams* params = new HTTPServerParams();
+	        params->setMaxThreads(1);
+	        params->setMaxQueued(16);
+
+	        // the endpoint is bound to the loopback interface unless configured otherwise
+	        ServerSocket socket(SocketAddress(_config->getString("application.metrics-host", "127.0.0.1"), metricsPort));
+	        _metricsServer = new HTTPServer(new MetricsEndpoint(_state), socket, params);
+	        _metricsServer->start();
+
+	        _ui.information(format("Serving metrics at http://%s/metrics", socket.address().toString()));
+        }
+
+        ProgressMonitor* monitor = new ProgressMonitor(_notificationQueue, _state, _config->getInt("coordinator.progress.update.interval", 3000));
+        HeartbeatClient* client = new HeartbeatClient(_notificationCenter, _notificationQueue, _config->getString("application.coordinator.host", "localhost"), _config->getInt("application.coordinator.port", 42070), AbstractGeneratorConfig::parseNodeIDs(_config->getString("application.node-id", "0")));
 
         _progressMonitor.start(*monitor);
         _heartbeatClient.start(*client);
@@ -263,20 +403,173 @@ void CommunicationSubsystem::onSatusChange(const AutoPtr<ChangeNodeState>& notif
 
 void ProgressMonitor::run()
 {
+    ProgressSnapshot last;
+    Timestamp lastTime;
+
     while (_state.currentState < NodeState::READY)
     {
         if (_state.currentState == NodeState::ALIVE)
         {
-	        _notificationCenter.postNotification(new UpdateProgress(_state));
+	        update(last, lastTime);
 	        _notificationQueue.enqueueNotification(new Heartbeat(_state));
         }
 
         Thread::current()->sleep(_interval);
     }
 
+    // report the final totals
+    update(last, lastTime);
+
     delete this;
 }
 
+void ProgressMonitor::update(ProgressSnapshot& last, Timestamp& lastTime)
+{
+    ProgressSnapshot snapshot = ProgressRegistry::defaultRegistry().snapshot();
+    Timestamp now;
+
+    _state.taskCount = static_cast<Decimal>(snapshot.tasks);
+    _state.taskProgress = snapshot.progress;
+
+    Decimal seconds = (now - lastTime) / static_cast<Decimal>(Timestamp::resolution());
+
+    if (seconds > 0 && snapshot.records >= last.records && snapshot.bytes >= last.bytes)
+    {
+        _logger.information(format("%Lu records (%.0f records/s), %Lu bytes (%.0f bytes/s), %Lu invalid genIDs skipped", snapshot.records, (snapshot.records - last.records) / seconds, snapshot.bytes, (snapshot.bytes - last.bytes) / seconds, snapshot.invalid));
+    }
+
+    last = snapshot;
+    lastTime = now;
+}
+
+void MetricsEndpoint::write(std::ostream& out)
+{
+    vector<ProgressSnapshot> tasks;
+    ProgressRegistry::defaultRegistry().snapshot(tasks);
+
+    ProgressSnapshot node;
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        node.add(*it);
+    }
+
+    out.precision(15);
+
+    family(out, "myriad_node_state", "gauge", "The node state (0 = prepare, 1 = alive, 2 = ready, 3 = aborted).");
+    out << "myriad_node_state " << static_cast<unsigned int>(_state.currentState) << "\n";
+    family(out, "myriad_node_stage", "gauge", "The ID of the current generator stage.");
+    out << "myriad_node_stage " << static_cast<unsigned int>(_state.currentGeneratorStageID) << "\n";
+    family(out, "myriad_node_progress", "gauge", "The overall progress of the node.");
+    out << "myriad_node_progress " << _state.progress() << "\n";
+    family(out, "myriad_node_active_tasks", "gauge", "The number of registered stage tasks.");
+    out << "myriad_node_active_tasks " << node.tasks << "\n";
+
+    family(out, "myriad_task_active", "gauge", "The number of registered stage tasks with this name.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_active{" << labels(*it) << "} " << it->tasks << "\n";
+    }
+
+    family(out, "myriad_task_progress", "gauge", "The average processed fraction of the genID ranges of the active tasks.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        if (it->tasks > 0)
+        {
+	        out << "myriad_task_progress{" << labels(*it) << "} " << it->progress / it->tasks << "\n";
+        }
+    }
+
+    family(out, "myriad_task_records_total", "counter", "The number of collected records.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_records_total{" << labels(*it) << "} " << it->records << "\n";
+    }
+
+    family(out, "myriad_task_bytes_total", "counter", "The number of serialized output bytes.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_bytes_total{" << labels(*it) << "} " << it->bytes << "\n";
+    }
+
+    family(out, "myriad_task_invalid_genids_total", "counter", "The number of skipped invalid genIDs.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_invalid_genids_total{" << labels(*it) << "} " << it->invalid << "\n";
+    }
+
+    family(out, "myriad_task_seconds_total", "counter", "The task time per phase. Setter chain and serialization times are extrapolated from sampled records.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_seconds_total{" << labels(*it, ",phase=\"setter\"") << "} " << it->setterNanos / 1e9 << "\n";
+        out << "myriad_task_seconds_total{" << labels(*it, ",phase=\"serialization\"") << "} " << it->serializeNanos / 1e9 << "\n";
+        out << "myriad_task_seconds_total{" << labels(*it, ",phase=\"write\"") << "} " << it->writeNanos / 1e9 << "\n";
+    }
+
+    family(out, "myriad_task_reference_lookups_total", "counter", "The number of reference lookups, which hit if the referenced record was already instantiated.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_reference_lookups_total{" << labels(*it, ",result=\"hit\"") << "} " << it->referenceHits << "\n";
+        out << "myriad_task_reference_lookups_total{" << labels(*it, ",result=\"miss\"") << "} " << it->referenceMisses << "\n";
+    }
+
+    family(out, "myriad_task_reference_hit_ratio", "gauge", "The share of reference lookups that hit.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        if (it->referenceHits + it->referenceMisses > 0)
+        {
+	        out << "myriad_task_reference_hit_ratio{" << labels(*it) << "} " << it->referenceHits / static_cast<Decimal>(it->referenceHits + it->referenceMisses) << "\n";
+        }
+    }
+
+    family(out, "myriad_task_output_queue_depth", "gauge", "The number of output blocks waiting to be compressed or written.");
+    for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        out << "myriad_task_output_queue_depth{" << labels(*it) << "} " << it->queueDepth << "\n";
+    }
+}
+
+void MetricsEndpoint::family(std::ostream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+string MetricsEndpoint::labels(const ProgressSnapshot& task, const string& extra)
+{
+    string::size_type separator = task.name.find("::");
+    string generator = separator == string::npos ? task.name : task.name.substr(0, separator);
+
+    const int partition = ProgressSlot::partition(task.name);
+    if (partition >= 0)
+    {
+        return "generator=\"" + escape(generator) + "\",partition=\"" + format("%d", partition) + "\",task=\"" + escape(task.name) + "\"" + extra;
+    }
+
+    return "generator=\"" + escape(generator) + "\",task=\"" + escape(task.name) + "\"" + extra;
+}
+
+string MetricsEndpoint::escape(const string& value)
+{
+    string escaped;
+    for (string::const_iterator it = value.begin(); it != value.end(); ++it)
+    {
+        if (*it == '\\' || *it == '"')
+        {
+	        escaped += '\\';
+	        escaped += *it;
+        }
+        else if (*it == '\n')
+        {
+	        escaped += "\\n";
+        }
+        else
+        {
+	        escaped += *it;
+        }
+    }
+    return escaped;
+}
+
 void HeartbeatClient::run()
 {
     // FIXME: maintain client session as a private member
@@ -301,29 +594,40 @@ void HeartbeatClient::run()
         Heartbeat* heartbeat = dynamic_cast<Heartbeat*> (notification.get());
         if (NULL != heartbeat)
         {
-	        string uri = format("/heartbeat?id=%u&status=%u&stage=%u&progress=%f", heartbeat->state.nodeID, static_cast<unsigned int> (heartbeat->state.currentState), static_cast<unsigned int> (heartbeat->state.currentGeneratorStageID), heartbeat->state.progress());
-	        string msg = format("heartbeat: { id: %u, status: %u, stage: %u, progress: %f }", heartbeat->state.nodeID, static_cast<unsigned int> (heartbeat->state.currentState), static_cast<unsigned int> (heartbeat->state.currentGeneratorStageID), heartbeat->state.progress());
-
 	        _hb.information(format("task count    %f", heartbeat->state.taskCount));
 	        _hb.information(format("task progress %f", heartbeat->state.taskProgress));
 
-	        _hb.information(msg);
-
-	        if (badRequestCounter < 20)
+	        for (vector<I16u>::const_iterator it = _nodeIDs.begin(); it != _nodeIDs.end(); ++it)
 	        {
-		        try
-		        {
-			        request.setURI(uri);
-			        session.sendRequest(request);
-			        session.receiveResponse(response);
-		        }
-		        catch (const Exception& exc)
-		        {
-			        _logger.warning(format("Error in heartbeat request #%hu: %s", ++badRequestCounter, exc.displayText()));
+		        unsigned int nodeID = *it;
+
+		        // report the progress of the tasks of this partition only
+		        NodeState state = heartbeat->state;
+		        ProgressSnapshot partition = ProgressRegistry::defaultRegistry().snapshot(*it);
+		        state.taskCount = static_cast<Decimal>(partition.tasks);
+		        state.taskProgress = partition.progress;
+
+		        string uri = format("/heartbeat?id=%u&status=%u&stage=%u&progress=%f", nodeID, static_cast<unsigned int> (state.currentState), static_cast<unsigned int> (state.currentGeneratorStageID), state.progress());
+		        string msg = format("heartbeat: { id: %u, status: %u, stage: %u, progress: %f }", nodeID, static_cast<unsigned int> (state.currentState), static_cast<unsigned int> (state.currentGeneratorStageID), state.progress());
+
+		        _hb.information(msg);
 
-			        if (badRequestCounter == 20)
+		        if (badRequestCounter < 20)
+		        {
+			        try
+			        {
+				        request.setURI(uri);
+				        session.sendRequest(request);
+				        session.receiveResponse(response);
+			        }
+			        catch (const Exception& exc)
 			        {
-				        _logger.warning(format("Discontinuing communication with coordination service at `%s:%hu`", session.getHost(), session.getPort()));
+				        _logger.warning(format("Error in heartbeat request #%hu: %s", ++badRequestCounter, exc.displayText()));
+
+				        if (badRequestCounter == 20)
+				        {
+					        _logger.warning(format("Discontinuing communication with coordination service at `%s:%hu`", session.getHost(), session.getPort()));
+				        }
 			        }
 		        }
 	        }
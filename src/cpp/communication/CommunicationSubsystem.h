@@ -25,6 +25,7 @@
 #include <Poco/NotificationQueue.h>
 #include <Poco/Thread.h>
 #include <Poco/Net/HTTPClientSession.h>
+#include <Poco/Net/HTTPServer.h>
 #include <Poco/Util/Application.h>
 #include <Poco/Util/Subsystem.h>
 
@@ -53,7 +54,7 @@ public:
      * Constructor.
      */
     CommunicationSubsystem(NotificationCenter& notificationCenter) :
-        _notificationCenter(notificationCenter), _state(), _progressMonitor("progress_monitor"), _heartbeatClient("heartbeat_client"), _initialized(false), _logger(Logger::get("communication.driver")), _ui(Logger::get("ui"))
+        _notificationCenter(notificationCenter), _state(), _progressMonitor("progress_monitor"), _heartbeatClient("heartbeat_client"), _metricsServer(NULL), _initialized(false), _logger(Logger::get("communication.driver")), _ui(Logger::get("ui"))
     {
     }
 
@@ -66,6 +67,10 @@ public:
 
     /**
      * Starts the CommunicationSubsystem instance.
+     *
+     * Besides the progress monitor and the heartbeat client, this starts
+     * the local metrics endpoint if the {application.metrics-port} config
+     * parameter is set.
      */
     void start();
 
@@ -121,6 +126,7 @@ private:
     Thread _progressMonitor;
     Thread _heartbeatClient;
     HTTPClientSession _httpSession;
+    HTTPServer* _metricsServer;
     I16u _badRequestCounter;
 
     bool _initialized;
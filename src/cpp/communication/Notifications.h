@@ -171,37 +171,6 @@ public:
 };
 
 
-/**
- * A notification issued periodically to update the NodeStage::taskProgress and
- * NodeState::taskCount values.
- *
- * Runnable StageTask instances report their progress by subscribing to this
- * notification type. After each update, the thread creates a new Heartbeat
- * notification.
- *
- * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
- */
-class UpdateProgress: public Notification
-{
-public:
-
-    /**
-     * Constructor.
-     */
-    UpdateProgress(NodeState& state) :
-        state(state)
-    {
-        state.taskCount = 0;
-        state.taskProgress = 0;
-    }
-
-    /**
-     * The NodeState which progress is to be updated.
-     */
-    NodeState& state;
-};
-
-
 /**
  * A Notification implementation for periodic node heartbeats.
  *
@@ -0,0 +1,732 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef PROGRESSREGISTRY_H_
+#define PROGRESSREGISTRY_H_
+
+#include "core/types.h"
+
+#include <Poco/Thread.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup communication
+ * @{*/
+
+/**
+ * The progress counters of a single stage task.
+ *
+ * Each slot occupies its own three cache lines of ALIGNMENT bytes (most of
+ * them for the task name) and is written only by the thread that runs the
+ * task, so the counters are published with relaxed atomic stores and the
+ * writers never contend with each other or with the reader.
+ * The ProgressRegistry reads the counters of all active slots with relaxed
+ * atomic loads, so a snapshot may mix values from slightly different
+ * points in time, but never contains torn values.
+ *
+ * Besides the record and byte counts, a slot holds the time spent in the
+ * setter chain, in record serialization and in output writes, the hits and
+ * misses of the reference lookups, and the output queue depth of the task.
+ * The phase times are sampled for every TIMING_INTERVAL-th record only.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ProgressSlot
+{
+public:
+
+    /**
+     * The alignment of a slot, which should match the cache line size.
+     */
+    static const size_t ALIGNMENT = 64;
+
+    /**
+     * The maximal length of the task name stored in a slot (including the
+     * terminating zero). Longer names are truncated.
+     */
+    static const size_t NAME_LENGTH = 96;
+
+    /**
+     * The stage tasks measure the setter chain and serialization times of
+     * every TIMING_INTERVAL-th record and extrapolate them to all records.
+     */
+    static const I64u TIMING_INTERVAL = 64;
+
+    /**
+     * Returns the name of the task \p name of the partition with the given
+     * \p nodeID (e.g. 'customer::generate_records#007'), so that the tasks
+     * of the partitions generated by the same process are reported
+     * separately.
+     */
+    static string taskName(const string& name, I16u nodeID)
+    {
+        char suffix[8];
+        std::snprintf(suffix, sizeof(suffix), "#%03hu", nodeID);
+        return name + suffix;
+    }
+
+    /**
+     * Returns the partition ID encoded in the given task \p name by
+     * taskName(), or -1 if the name has no partition suffix.
+     */
+    static int partition(const string& name)
+    {
+        const string::size_type hash = name.rfind('#');
+        if (hash == string::npos || hash + 1 == name.size() || name.size() - hash > 6)
+        {
+	        return -1;
+        }
+
+        int nodeID = 0;
+        for (string::size_type i = hash + 1; i < name.size(); i++)
+        {
+	        if (name[i] < '0' || name[i] > '9')
+	        {
+		        return -1;
+	        }
+	        nodeID = nodeID * 10 + (name[i] - '0');
+        }
+
+        return nodeID <= 65535 ? nodeID : -1;
+    }
+
+    /**
+     * Makes a slot the current() slot of the calling thread while in scope.
+     */
+    class Scope
+    {
+    public:
+
+        Scope(ProgressSlot& slot)
+        {
+	        current() = &slot;
+        }
+
+        ~Scope()
+        {
+	        current() = NULL;
+        }
+    };
+
+    /**
+     * Returns the slot of the task run by the calling thread, or NULL if the
+     * thread does not run a stage task.
+     */
+    static ProgressSlot*& current()
+    {
+        static __thread ProgressSlot* slot = NULL;
+        return slot;
+    }
+
+    /**
+     * Counts a reference lookup of the task run by the calling thread. A
+     * \p hit means that the referenced record was already instantiated.
+     */
+    static void referenceLookup(bool hit)
+    {
+        ProgressSlot* slot = current();
+
+        if (slot != NULL)
+        {
+	        Counter counter = hit ? REFERENCE_HITS : REFERENCE_MISSES;
+	        store(slot->_counters[counter], load(slot->_counters[counter]) + 1);
+        }
+    }
+
+    /**
+     * Sets the size of the genID range processed by the task to \p total and
+     * the number of already processed genIDs (e.g. before a resumed
+     * checkpoint) to \p position.
+     */
+    void start(I64u total, I64u position)
+    {
+        store(_total, total);
+        store(_position, position);
+    }
+
+    /**
+     * Publishes the number of collected \p records and the number of
+     * processed genIDs (including skipped ones) given by \p position.
+     */
+    void update(I64u records, I64u position)
+    {
+        store(_counters[RECORDS], records);
+        store(_position, position);
+    }
+
+    /**
+     * Publishes the number of \p invalid genIDs skipped by the task.
+     */
+    void invalid(I64u invalid)
+    {
+        store(_counters[INVALID], invalid);
+    }
+
+    /**
+     * Publishes the number of output \p bytes, the nanoseconds spent in
+     * output writes given by \p writeNanos, and the current output
+     * \p queueDepth.
+     */
+    void output(I64u bytes, I64u writeNanos, I64u queueDepth)
+    {
+        store(_counters[BYTES], bytes);
+        store(_counters[WRITE_NANOS], writeNanos);
+        store(_queueDepth, queueDepth);
+    }
+
+    /**
+     * Publishes the (extrapolated) nanoseconds spent in the setter chain and
+     * in record serialization.
+     */
+    void timing(I64u setterNanos, I64u serializeNanos)
+    {
+        store(_counters[SETTER_NANOS], setterNanos);
+        store(_counters[SERIALIZE_NANOS], serializeNanos);
+    }
+
+    /**
+     * Marks the whole genID range as processed.
+     */
+    void finish()
+    {
+        store(_position, load(_total));
+    }
+
+    /**
+     * Returns the number of records collected so far.
+     */
+    I64u records() const
+    {
+        return load(_counters[RECORDS]);
+    }
+
+    /**
+     * Returns the number of output bytes written so far.
+     */
+    I64u bytes() const
+    {
+        return load(_counters[BYTES]);
+    }
+
+    /**
+     * Returns the processed fraction of the genID range (0 if the task has
+     * not started yet or does not process a genID range).
+     */
+    Decimal fraction() const
+    {
+        I64u total = load(_total);
+        return total > 0 ? load(_position) / static_cast<Decimal>(total) : 0.0;
+    }
+
+private:
+
+    friend class ProgressRegistry;
+    friend struct ProgressSnapshot;
+
+    /**
+     * The cumulative counters of a slot.
+     */
+    enum Counter
+    {
+        RECORDS, BYTES, INVALID, SETTER_NANOS, SERIALIZE_NANOS, WRITE_NANOS, REFERENCE_HITS, REFERENCE_MISSES, COUNTERS
+    };
+
+    /**
+     * The slot states.
+     */
+    enum State
+    {
+        FREE, ACTIVE
+    };
+
+    static void store(I64u& counter, I64u value)
+    {
+        __atomic_store_n(&counter, value, __ATOMIC_RELAXED);
+    }
+
+    static I64u load(const I64u& counter)
+    {
+        return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+    }
+
+    I64u _counters[COUNTERS];
+    I64u _position;
+    I64u _total;
+    I64u _queueDepth;
+    I32u _state;
+    char _name[NAME_LENGTH];
+} __attribute__((aligned(ProgressSlot::ALIGNMENT)));
+
+/**
+ * Fails to compile if a ProgressSlot does not fill exactly three cache lines.
+ */
+typedef char ProgressSlotSizeCheck[sizeof(ProgressSlot) == 3 * ProgressSlot::ALIGNMENT ? 1 : -1];
+
+/**
+ * The aggregated progress of a group of stage tasks.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct ProgressSnapshot
+{
+    ProgressSnapshot(const string& name = "") :
+        name(name),
+        tasks(0),
+        progress(0),
+        records(0),
+        bytes(0),
+        invalid(0),
+        setterNanos(0),
+        serializeNanos(0),
+        writeNanos(0),
+        referenceHits(0),
+        referenceMisses(0),
+        queueDepth(0)
+    {
+    }
+
+    /**
+     * Adds the counters of \p o (except for its name) to this snapshot.
+     */
+    void add(const ProgressSnapshot& o)
+    {
+        tasks += o.tasks;
+        progress += o.progress;
+        queueDepth += o.queueDepth;
+        records += o.records;
+        bytes += o.bytes;
+        invalid += o.invalid;
+        setterNanos += o.setterNanos;
+        serializeNanos += o.serializeNanos;
+        writeNanos += o.writeNanos;
+        referenceHits += o.referenceHits;
+        referenceMisses += o.referenceMisses;
+    }
+
+    /**
+     * Adds the given cumulative ProgressSlot \p counters to this snapshot.
+     */
+    void add(const I64u* counters)
+    {
+        records += ProgressSlot::load(counters[ProgressSlot::RECORDS]);
+        bytes += ProgressSlot::load(counters[ProgressSlot::BYTES]);
+        invalid += ProgressSlot::load(counters[ProgressSlot::INVALID]);
+        setterNanos += ProgressSlot::load(counters[ProgressSlot::SETTER_NANOS]);
+        serializeNanos += ProgressSlot::load(counters[ProgressSlot::SERIALIZE_NANOS]);
+        writeNanos += ProgressSlot::load(counters[ProgressSlot::WRITE_NANOS]);
+        referenceHits += ProgressSlot::load(counters[ProgressSlot::REFERENCE_HITS]);
+        referenceMisses += ProgressSlot::load(counters[ProgressSlot::REFERENCE_MISSES]);
+    }
+
+    string name; //!< The task name (empty for aggregates of all tasks).
+    I64u tasks; //!< The number of registered tasks.
+    Decimal progress; //!< The sum of the processed fractions of the registered tasks.
+    I64u records; //!< The number of records collected so far.
+    I64u bytes; //!< The number of output bytes written so far.
+    I64u invalid; //!< The number of invalid genIDs skipped so far.
+    I64u setterNanos; //!< The estimated nanoseconds spent in the setter chains.
+    I64u serializeNanos; //!< The estimated nanoseconds spent in record serialization.
+    I64u writeNanos; //!< The nanoseconds spent in output writes.
+    I64u referenceHits; //!< The number of reference lookups of already instantiated records.
+    I64u referenceMisses; //!< The number of reference lookups that instantiated a record.
+    I64u queueDepth; //!< The number of output blocks waiting to be written.
+};
+
+/**
+ * A lock-free registry of the ProgressSlot counters of all stage tasks.
+ *
+ * Slots are kept in a linked list of blocks that only grows. Tasks claim a
+ * free slot with acquire() and return it with release(), which adds the
+ * final counters of the task to the totals kept for its name. Both
+ * operations use compare-and-swap instead of locks, so the generator
+ * threads never block on the registry, and the ProgressMonitor and the
+ * metrics endpoint can take a snapshot() at any time without observer
+ * dispatch.
+ *
+ * Acquires and releases are bracketed by a pair of change counters, so a
+ * snapshot that overlaps with them is retried. Snapshots therefore never
+ * miss or double count the counters of a released slot, and the cumulative
+ * counters of consecutive snapshots never decrease.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ProgressRegistry
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    ProgressRegistry() :
+        _head(newBlock()),
+        _totals(NULL),
+        _changesStarted(0),
+        _changesFinished(0)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ProgressRegistry()
+    {
+        while (_head != NULL)
+        {
+	        Block* next = _head->next;
+	        free(_head);
+	        _head = next;
+        }
+
+        while (_totals != NULL)
+        {
+	        Totals* next = _totals->next;
+	        delete _totals;
+	        _totals = next;
+        }
+    }
+
+    /**
+     * Returns the registry shared by the generator and communication
+     * subsystems.
+     */
+    static ProgressRegistry& defaultRegistry()
+    {
+        static ProgressRegistry registry;
+        return registry;
+    }
+
+    /**
+     * Claims a free slot for the task with the given \p name. The counters of
+     * a free slot are always zero.
+     */
+    ProgressSlot& acquire(const string& name)
+    {
+        beginChange();
+
+        Block* block = _head;
+
+        while (true)
+        {
+	        for (size_t i = 0; i < Block::SLOTS; i++)
+	        {
+		        ProgressSlot& slot = block->slots[i];
+		        I32u expected = ProgressSlot::FREE;
+
+		        if (__atomic_load_n(&slot._state, __ATOMIC_RELAXED) == ProgressSlot::FREE && __atomic_compare_exchange_n(&slot._state, &expected, static_cast<I32u>(ProgressSlot::ACTIVE), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+		        {
+			        copyName(slot._name, name.c_str());
+			        endChange();
+			        return slot;
+		        }
+	        }
+
+	        Block* next = __atomic_load_n(&block->next, __ATOMIC_ACQUIRE);
+
+	        if (next == NULL)
+	        {
+		        // append a new block unless another thread was faster
+		        Block* created = newBlock();
+
+		        if (__atomic_compare_exchange_n(&block->next, &next, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+		        {
+			        next = created;
+		        }
+		        else
+		        {
+			        free(created);
+		        }
+	        }
+
+	        block = next;
+        }
+    }
+
+    /**
+     * Adds the counters of the given \p slot to the totals of its task name
+     * and returns the slot to the registry.
+     */
+    void release(ProgressSlot& slot)
+    {
+        beginChange();
+
+        Totals& totals = this->totals(slot._name);
+
+        for (size_t i = 0; i < ProgressSlot::COUNTERS; i++)
+        {
+	        __atomic_add_fetch(&totals.counters[i], ProgressSlot::load(slot._counters[i]), __ATOMIC_RELAXED);
+	        ProgressSlot::store(slot._counters[i], 0);
+        }
+
+        slot.start(0, 0);
+        ProgressSlot::store(slot._queueDepth, 0);
+
+        __atomic_store_n(&slot._state, static_cast<I32u>(ProgressSlot::FREE), __ATOMIC_RELEASE);
+
+        endChange();
+    }
+
+    /**
+     * Aggregates the counters of all tasks.
+     */
+    ProgressSnapshot snapshot() const
+    {
+        vector<ProgressSnapshot> tasks;
+        snapshot(tasks);
+
+        ProgressSnapshot snapshot;
+        for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+	        snapshot.add(*it);
+        }
+
+        return snapshot;
+    }
+
+    /**
+     * Aggregates the counters of the tasks of the partition with the given
+     * \p nodeID (see ProgressSlot::taskName()).
+     */
+    ProgressSnapshot snapshot(I16u nodeID) const
+    {
+        vector<ProgressSnapshot> tasks;
+        snapshot(tasks);
+
+        ProgressSnapshot snapshot;
+        for (vector<ProgressSnapshot>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+	        if (ProgressSlot::partition(it->name) == static_cast<int>(nodeID))
+	        {
+		        snapshot.add(*it);
+	        }
+        }
+
+        return snapshot;
+    }
+
+    /**
+     * Aggregates the counters of the active slots and the totals of the
+     * released ones per task name into the given \p tasks vector. Names
+     * of tasks that have been released are included with zero active
+     * tasks.
+     */
+    void snapshot(vector<ProgressSnapshot>& tasks) const
+    {
+        while (true)
+        {
+	        tasks.clear();
+
+	        I64u finished = __atomic_load_n(&_changesFinished, __ATOMIC_ACQUIRE);
+	        I64u started = __atomic_load_n(&_changesStarted, __ATOMIC_ACQUIRE);
+
+	        if (started != finished)
+	        {
+		        // wait for the running acquire() or release() calls
+		        Thread::yield();
+		        continue;
+	        }
+
+	        for (const Totals* totals = __atomic_load_n(&_totals, __ATOMIC_ACQUIRE); totals != NULL; totals = totals->next)
+	        {
+		        entry(tasks, totals->name).add(totals->counters);
+	        }
+
+	        for (const Block* block = _head; block != NULL; block = __atomic_load_n(&block->next, __ATOMIC_ACQUIRE))
+	        {
+		        for (size_t i = 0; i < Block::SLOTS; i++)
+		        {
+			        const ProgressSlot& slot = block->slots[i];
+
+			        if (__atomic_load_n(&slot._state, __ATOMIC_ACQUIRE) == ProgressSlot::ACTIVE)
+			        {
+				        ProgressSnapshot& snapshot = entry(tasks, slot._name);
+				        snapshot.tasks++;
+				        snapshot.progress += slot.fraction();
+				        snapshot.queueDepth += ProgressSlot::load(slot._queueDepth);
+				        snapshot.add(slot._counters);
+			        }
+		        }
+	        }
+
+	        // retry if a slot was acquired or released in the meantime
+	        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+	        if (__atomic_load_n(&_changesStarted, __ATOMIC_RELAXED) == started)
+	        {
+		        return;
+	        }
+        }
+    }
+
+private:
+
+    /**
+     * A block of slots.
+     */
+    struct Block
+    {
+        static const size_t SLOTS = 64; //!< The number of slots per block.
+
+        ProgressSlot slots[SLOTS]; //!< The slots of the block.
+        Block* next; //!< The next block or NULL.
+    };
+
+    /**
+     * The counters of the released slots of a task name.
+     */
+    struct Totals
+    {
+        char name[ProgressSlot::NAME_LENGTH]; //!< The task name.
+        I64u counters[ProgressSlot::COUNTERS]; //!< The summed counters.
+        Totals* next; //!< The next entry or NULL.
+    };
+
+    /**
+     * Noncopyable.
+     */
+    ProgressRegistry(const ProgressRegistry&);
+
+    /**
+     * Noncopyable.
+     */
+    ProgressRegistry& operator=(const ProgressRegistry&);
+
+    /**
+     * Allocates a cache line aligned block with free slots.
+     */
+    static Block* newBlock()
+    {
+        void* memory;
+        if (posix_memalign(&memory, ProgressSlot::ALIGNMENT, sizeof(Block)) != 0)
+        {
+	        throw std::bad_alloc();
+        }
+
+        // all slots start zeroed and FREE
+        memset(memory, 0, sizeof(Block));
+        return static_cast<Block*>(memory);
+    }
+
+    /**
+     * Copies the zero terminated \p name to the \p target buffer of
+     * ProgressSlot::NAME_LENGTH bytes, truncating it if necessary.
+     */
+    static void copyName(char* target, const char* name)
+    {
+        strncpy(target, name, ProgressSlot::NAME_LENGTH - 1);
+        target[ProgressSlot::NAME_LENGTH - 1] = '\0';
+    }
+
+    /**
+     * Returns the snapshot for the given task \p name in \p tasks, which is
+     * appended if necessary.
+     */
+    static ProgressSnapshot& entry(vector<ProgressSnapshot>& tasks, const char* name)
+    {
+        for (vector<ProgressSnapshot>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+	        if (it->name == name)
+	        {
+		        return *it;
+	        }
+        }
+
+        tasks.push_back(ProgressSnapshot(name));
+        return tasks.back();
+    }
+
+    /**
+     * Returns the totals for the given task \p name, which are prepended to
+     * the list of totals if necessary.
+     */
+    Totals& totals(const char* name)
+    {
+        Totals* head = __atomic_load_n(&_totals, __ATOMIC_ACQUIRE);
+        Totals* created = NULL;
+
+        while (true)
+        {
+	        for (Totals* totals = head; totals != NULL; totals = totals->next)
+	        {
+		        if (strcmp(totals->name, name) == 0)
+		        {
+			        delete created;
+			        return *totals;
+		        }
+	        }
+
+	        if (created == NULL)
+	        {
+		        created = new Totals();
+		        memset(created, 0, sizeof(Totals));
+		        copyName(created->name, name);
+	        }
+
+	        created->next = head;
+
+	        // on failure, head is updated and the new entries are searched
+	        if (__atomic_compare_exchange_n(&_totals, &head, created, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	        {
+		        return *created;
+	        }
+        }
+    }
+
+    void beginChange()
+    {
+        __atomic_add_fetch(&_changesStarted, 1, __ATOMIC_ACQ_REL);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    void endChange()
+    {
+        __atomic_add_fetch(&_changesFinished, 1, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * The first block of slots.
+     */
+    Block* _head;
+
+    /**
+     * The counters of released tasks per task name.
+     */
+    Totals* _totals;
+
+    /**
+     * The number of started acquire() and release() calls.
+     */
+    I64u _changesStarted;
+
+    /**
+     * The number of finished acquire() and release() calls.
+     */
+    I64u _changesFinished;
+};
+
+/** @}*/// add to communication group
+} // namespace Myriad
+
+#endif /* PROGRESSREGISTRY_H_ */
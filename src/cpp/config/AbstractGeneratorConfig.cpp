@@ -17,13 +17,23 @@
  */
 
 #include "config/AbstractGeneratorConfig.h"
+#include "core/BinarySpecification.h"
 #include "core/exceptions.h"
 #include "generator/GeneratorPool.h"
 
+#include <algorithm>
+#include <set>
+#include <Poco/Environment.h>
 #include <Poco/File.h>
 #include <Poco/FormattingChannel.h>
+#include <Poco/Mutex.h>
+#include <Poco/NumberParser.h>
 #include <Poco/PatternFormatter.h>
+#include <Poco/Runnable.h>
 #include <Poco/SimpleFileChannel.h>
+#include <Poco/Stopwatch.h>
+#include <Poco/StringTokenizer.h>
+#include <Poco/ThreadPool.h>
 #include <Poco/DOM/AutoPtr.h>
 #include <Poco/DOM/DOMParser.h>
 #include <Poco/Util/MapConfiguration.h>
@@ -34,6 +44,91 @@ using namespace Poco::XML;
 
 namespace Myriad {
 
+/**
+ * A loader thread body that drains a shared queue of AbstractLoaderTask
+ * objects.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class LoaderWorker: public Runnable
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param node The index of the NUMA node the worker thread is bound to,
+     *             or -1 if the thread should not be bound.
+     */
+    LoaderWorker(vector<AbstractLoaderTask*>& tasks, size_t& next, FastMutex& mutex, int node = -1) :
+        _tasks(tasks),
+        _next(next),
+        _mutex(mutex),
+        _node(node)
+    {
+    }
+
+    /**
+     * Runs queued tasks until the queue is exhausted.
+     */
+    void run()
+    {
+        if (_node >= 0)
+        {
+            NumaTopology::instance().bind(static_cast<size_t>(_node));
+        }
+
+        while (true)
+        {
+            AbstractLoaderTask* task;
+            {
+                FastMutex::ScopedLock lock(_mutex);
+                if (_next >= _tasks.size())
+                {
+                    return;
+                }
+                task = _tasks[_next++];
+            }
+            task->run();
+        }
+    }
+
+private:
+
+    vector<AbstractLoaderTask*>& _tasks;
+
+    size_t& _next;
+
+    FastMutex& _mutex;
+
+    const int _node;
+};
+
+/**
+ * The replica loader tasks of a single NUMA node.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct ReplicaQueue
+{
+    ReplicaQueue() :
+        next(0)
+    {
+    }
+
+    ~ReplicaQueue()
+    {
+        for (vector<AbstractLoaderTask*>::iterator it = tasks.begin(); it != tasks.end(); ++it)
+        {
+            delete *it;
+        }
+    }
+
+    vector<AbstractLoaderTask*> tasks; //!< The replica loader tasks.
+    size_t next; //!< The index of the next task to run.
+    FastMutex mutex; //!< A mutex guarding \p next.
+};
+
 void AbstractGeneratorConfig::initialize(AbstractConfiguration& appConfig)
 {
     // add the application config as a read-only layer
@@ -46,7 +141,15 @@ void AbstractGeneratorConfig::initialize(AbstractConfiguration& appConfig)
     }
 
     setInt("common.partitioning.number-of-chunks", getInt("application.node-count", 1));
-    setInt("common.partitioning.chunks-id", getInt("application.node-id", 0));
+
+    // with a partition set, this is the configuration of the first partition
+    vector<I16u> partitions = nodeIDs();
+    if (partitions.back() >= numberOfChunks())
+    {
+        throw ConfigException(format("Node ID %hu is out of range for %hu nodes", partitions.back(), numberOfChunks()));
+    }
+
+    setInt("common.partitioning.chunks-id", partitions.front());
 
     // configure directory structure
     setString("application.job-dir", format("%s/%s", getString("application.output-base"), getString("application.job-id")));
@@ -61,9 +164,19 @@ void AbstractGeneratorConfig::initialize(AbstractConfiguration& appConfig)
 
     _logger.information("Loading generator configuration");
 
+    Stopwatch phaseTimer;
+
+    phaseTimer.restart();
     configurePartitioning();
+    _logger.information(format("Partitioning configured in %.3f ms", phaseTimer.elapsed() / 1000.0));
+
+    phaseTimer.restart();
     configureFunctions();
     configureSets();
+    _logger.information(format("Functions and enum sets registered in %.3f ms", phaseTimer.elapsed() / 1000.0));
+
+    // logs its own timing; the total is logged as startup phase `config`
+    loadPending();
 
     if (hasProperty("common.master.seed"))
     {
@@ -72,6 +185,234 @@ void AbstractGeneratorConfig::initialize(AbstractConfiguration& appConfig)
     }
 }
 
+void AbstractGeneratorConfig::initialize(AbstractConfiguration& appConfig, AbstractGeneratorConfig& primary, I16u nodeID)
+{
+    // keep the partition specific parameters in a private layer
+    this->addWriteable(new MapConfiguration(), 0, false);
+    this->addReadOnly(&appConfig, 1, true);
+
+    setInt("common.partitioning.chunks-id", nodeID);
+
+    // configure directory structure
+    setString("application.output-dir", format("%s/node%03d", getString("application.job-dir"), static_cast<int>(nodeID)));
+    setString("generator.ENV.output-dir", getString("application.output-dir"));
+
+    configurePartitioning();
+
+    // share the functions and enum sets of the primary configuration
+    _functionPool.addAll(primary._functionPool);
+    _enumSetPool.addAll(primary._enumSetPool);
+
+    for (vector<FunctionPool*>::const_iterator it = primary._functionReplicas.begin(); it != primary._functionReplicas.end(); ++it)
+    {
+        _functionReplicas.push_back(new FunctionPool());
+        _functionReplicas.back()->addAll(**it);
+    }
+
+    if (hasProperty("common.master.seed"))
+    {
+        _masterPRNG.seed(RandomStream::Seed(getString("common.master.seed")));
+    }
+
+    _logger.information(format("Configured partition %hu", nodeID));
+}
+
+vector<I16u> AbstractGeneratorConfig::parseNodeIDs(const string& spec)
+{
+    set<I16u> nodeIDs;
+
+    StringTokenizer tokenizer(spec, ",", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+    for (StringTokenizer::Iterator it = tokenizer.begin(); it != tokenizer.end(); ++it)
+    {
+        size_t separator = it->find('-');
+
+        unsigned int first, last;
+        if (!NumberParser::tryParseUnsigned(it->substr(0, separator), first) || !NumberParser::tryParseUnsigned(separator == string::npos ? *it : it->substr(separator + 1), last) || first > last || last > 65535)
+        {
+	        throw ConfigException(format("Invalid node ID range `%s` in `%s`", *it, spec));
+        }
+
+        for (unsigned int nodeID = first; nodeID <= last; nodeID++)
+        {
+	        nodeIDs.insert(static_cast<I16u>(nodeID));
+        }
+    }
+
+    if (nodeIDs.empty())
+    {
+        throw ConfigException(format("Empty node ID set `%s`", spec));
+    }
+
+    return vector<I16u>(nodeIDs.begin(), nodeIDs.end());
+}
+
+void AbstractGeneratorConfig::loadPending()
+{
+    if (_pendingLoaders.empty())
+    {
+        return;
+    }
+
+    Stopwatch timer;
+    timer.start();
+
+    size_t next = 0;
+    FastMutex mutex;
+    size_t threadCount = min<size_t>(_pendingLoaders.size(), max(1, getInt("application.loader-threads", Environment::processorCount())));
+
+    if (threadCount == 1)
+    {
+        LoaderWorker(_pendingLoaders, next, mutex).run();
+    }
+    else
+    {
+        vector<LoaderWorker*> workers;
+        ThreadPool threadPool("LoaderPool", 1, static_cast<int>(threadCount));
+
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            workers.push_back(new LoaderWorker(_pendingLoaders, next, mutex));
+            threadPool.start(*workers.back(), format("LoaderWorker#%z", i));
+        }
+
+        threadPool.joinAll();
+
+        for (size_t i = 0; i < workers.size(); i++)
+        {
+            delete workers[i];
+        }
+    }
+
+    _logger.information(format("Loaded %z functions and enum sets using %z threads in %.3f ms", _pendingLoaders.size(), threadCount, timer.elapsed() / 1000.0));
+
+    try
+    {
+        // register the loaded entries in the order in which they were queued
+        for (vector<AbstractLoaderTask*>::iterator it = _pendingLoaders.begin(); it != _pendingLoaders.end(); ++it)
+        {
+            (*it)->commit(_functionPool, _enumSetPool);
+        }
+
+        if (numa() && numaReplicateSize() > 0 && NumaTopology::instance().size() > 1)
+        {
+            loadReplicas(_pendingLoaders);
+        }
+    }
+    catch(...)
+    {
+        clearPending();
+        throw;
+    }
+
+    clearPending();
+}
+
+void AbstractGeneratorConfig::loadReplicas(const vector<AbstractLoaderTask*>& loaders)
+{
+    const NumaTopology& topology = NumaTopology::instance();
+
+    Stopwatch timer;
+    timer.start();
+
+    vector<ReplicaQueue*> queues;
+    for (size_t node = 0; node < topology.size(); node++)
+    {
+        queues.push_back(new ReplicaQueue());
+    }
+
+    try
+    {
+        // replicate all functions with a small enough specification
+        size_t replicated = 0;
+        for (vector<AbstractLoaderTask*>::const_iterator it = loaders.begin(); it != loaders.end(); ++it)
+        {
+            AbstractLoaderTask* replica = (*it)->replica();
+
+            if (replica == NULL)
+            {
+                continue;
+            }
+
+            Path path((*it)->path());
+            File file(BinarySpecification::available(path) ? BinarySpecification::compiledPath(path) : path);
+
+            if (static_cast<I64u>(file.getSize()) > numaReplicateSize())
+            {
+                delete replica;
+                continue;
+            }
+
+            queues[0]->tasks.push_back(replica);
+            for (size_t node = 1; node < queues.size(); node++)
+            {
+                queues[node]->tasks.push_back((*it)->replica());
+            }
+
+            replicated++;
+        }
+
+        if (replicated > 0)
+        {
+            vector<LoaderWorker*> workers;
+            ThreadPool threadPool("ReplicaPool", 1, static_cast<int>(queues.size()));
+
+            for (size_t node = 0; node < queues.size(); node++)
+            {
+                workers.push_back(new LoaderWorker(queues[node]->tasks, queues[node]->next, queues[node]->mutex, static_cast<int>(node)));
+                threadPool.start(*workers.back(), format("ReplicaWorker#%z", node));
+            }
+
+            threadPool.joinAll();
+
+            for (size_t i = 0; i < workers.size(); i++)
+            {
+                delete workers[i];
+            }
+
+            if (_functionReplicas.empty())
+            {
+                for (size_t node = 0; node < queues.size(); node++)
+                {
+                    _functionReplicas.push_back(new FunctionPool());
+                }
+            }
+
+            for (size_t node = 0; node < queues.size(); node++)
+            {
+                for (vector<AbstractLoaderTask*>::iterator it = queues[node]->tasks.begin(); it != queues[node]->tasks.end(); ++it)
+                {
+                    (*it)->commit(*_functionReplicas[node], _enumSetPool);
+                }
+            }
+
+            _logger.information(format("Replicated %z functions on %z NUMA nodes in %.3f ms", replicated, queues.size(), timer.elapsed() / 1000.0));
+        }
+    }
+    catch(...)
+    {
+        for (size_t node = 0; node < queues.size(); node++)
+        {
+            delete queues[node];
+        }
+        throw;
+    }
+
+    for (size_t node = 0; node < queues.size(); node++)
+    {
+        delete queues[node];
+    }
+}
+
+void AbstractGeneratorConfig::clearPending()
+{
+    for (vector<AbstractLoaderTask*>::iterator it = _pendingLoaders.begin(); it != _pendingLoaders.end(); ++it)
+    {
+        delete *it;
+    }
+
+    _pendingLoaders.clear();
+}
+
 void AbstractGeneratorConfig::configureLogging()
 {
     if (getString("application.output-type") != "socket")
@@ -135,6 +476,19 @@ void AbstractGeneratorConfig::computeLinearScalePartitioning(const string& key)
     setString("generator." + key + ".partition.end", toString(genIDEnd));
 }
 
+vector<I64> AbstractGeneratorConfig::outputPartitioningBoundaries(const String& name) const
+{
+    vector<I64> boundaries;
+
+    StringTokenizer tokenizer(getString(format("generator.%s.output-partitioning.boundaries", name), ""), ",", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+    for (StringTokenizer::Iterator it = tokenizer.begin(); it != tokenizer.end(); ++it)
+    {
+        boundaries.push_back(fromString<I64>(*it));
+    }
+
+    return boundaries;
+}
+
 const string AbstractGeneratorConfig::resolveValue(const string& value)
 {
     RegularExpression::MatchVec posVec;
@@ -21,11 +21,15 @@
 #include "core/types.h"
 #include "config/EnumSetPool.h"
 #include "config/FunctionPool.h"
+#include "config/LoaderTask.h"
 #include "config/ObjectBuilder.h"
+#include "core/NumaTopology.h"
 #include "math/probability/Probability.h"
 #include "math/random/RandomStream.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <Poco/AutoPtr.h>
 #include <Poco/Channel.h>
 #include <Poco/Exception.h>
@@ -77,6 +81,19 @@ public:
     {
     }
 
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractGeneratorConfig()
+    {
+        clearPending();
+
+        for (vector<FunctionPool*>::iterator it = _functionReplicas.begin(); it != _functionReplicas.end(); ++it)
+        {
+	        delete *it;
+        }
+    }
+
     /**
      * Initializes a layer of application-wide parameters on top of the
      * provided underlying \c AbstractConfiguration object. At the end the
@@ -90,9 +107,44 @@ public:
      * specializations in order to compute proper partitioning parameters for
      * all registered generators and to add the required functions and enum
      * sets to the GeneratorConfig instance.
+     *
+     * File based functions and enum sets registered with the deferred
+     * function(name, path) and enumSet(name, path) variants are loaded
+     * concurrently by loadPending() after configureSets() returns. The
+     * duration of each phase is written to the 'generator.config' log.
+     *
+     * If NUMA placement is enabled (see numa()), file based functions whose
+     * specification is not larger than numaReplicateSize() are loaded once
+     * more for each NUMA node by a thread bound to that node.
      */
     void initialize(AbstractConfiguration& appConfig);
 
+    /**
+     * Initializes the configuration of an additional partition generated by
+     * the same process as the \p primary configuration.
+     *
+     * The partition specific parameters (the chunk ID, the output directory
+     * and the parameters set by configurePartitioning()) are kept in a
+     * private layer on top of the read-only \p appConfig. The functions and
+     * enum sets loaded by the \p primary configuration are shared instead of
+     * being loaded again (together with their NUMA node replicas), so
+     * configureFunctions() and configureSets() are not invoked.
+     *
+     * @param appConfig The application configuration.
+     * @param primary The initialized configuration of the first partition.
+     * @param nodeID The chunk ID of the configured partition.
+     */
+    void initialize(AbstractConfiguration& appConfig, AbstractGeneratorConfig& primary, I16u nodeID);
+
+    /**
+     * Parses a partition set given as a comma separated list of chunk IDs
+     * and ID ranges (e.g. '3', '0-15' or '0,4,8-11').
+     *
+     * @return The ordered set of chunk IDs.
+     * @throw ConfigException if the \p spec cannot be parsed
+     */
+    static vector<I16u> parseNodeIDs(const string& spec);
+
     /**
      * Reads a parameter identified by the key 'generator.{\p key}' from tries
      * to convert it to a \p ParameterType instance using the fromString
@@ -116,15 +168,38 @@ public:
         _functionPool.add(functionPtr);
     }
 
+    /**
+     * Queues a \p FunctionType function to be loaded from the file at the
+     * given \p path on a loader thread. The function is registered with the
+     * FunctionPool by the next loadPending() call.
+     *
+     * @param name The name of the function.
+     * @param path The location of the function specification file.
+     */
+    template<class FunctionType> void function(const string& name, const string& path)
+    {
+        _pendingLoaders.push_back(new FunctionLoaderTask<FunctionType>(name, path));
+    }
+
     /**
      * Wrapper around the FunctionPool::get() method of the private
-     * FunctionPool member.
+     * FunctionPool member. Threads bound to a NUMA node (see
+     * NumaTopology::bind()) obtain the replica loaded for that node, if any.
      *
      * @return a reference to a \p FunctionType function identified by the
      *         given \p name
      */
     template<class FunctionType> FunctionType& function(const string& name) const
     {
+        if (!_functionReplicas.empty())
+        {
+	        int node = NumaTopology::boundNode();
+	        if (node >= 0 && static_cast<size_t>(node) < _functionReplicas.size() && _functionReplicas[node]->contains(name))
+	        {
+		        return _functionReplicas[node]->get<FunctionType>(name);
+	        }
+        }
+
         return _functionPool.get<FunctionType>(name);
     }
 
@@ -150,6 +225,19 @@ public:
         _enumSetPool.add(enumSet);
     }
 
+    /**
+     * Queues an enumerated set to be loaded from the file at the given
+     * \p path on a loader thread. The enum set is registered with the
+     * EnumSetPool by the next loadPending() call.
+     *
+     * @param name The name of the enum set.
+     * @param path The location of the enum set specification file.
+     */
+    void enumSet(const string& name, const string& path)
+    {
+        _pendingLoaders.push_back(new EnumSetLoaderTask(name, path));
+    }
+
     /**
      * Retrieves the enum set identified by the given \p key.
      *
@@ -224,10 +312,61 @@ public:
         return path;
     }
 
+    /**
+     * Returns the name of the field by which the output of the generator
+     * identified by the given \p name is partitioned. The field is bound to
+     * the {generator.${name}.output-partitioning.field} config parameter
+     * (default is an empty string, i.e. no partitioning).
+     *
+     * @return The partitioning field for \p PartitionedFileOutputCollector
+     *         instances.
+     */
+    String outputPartitioningField(const String& name) const
+    {
+        return getString(format("generator.%s.output-partitioning.field", name), "");
+    }
+
+    /**
+     * Returns the number of hash partitions for the output of the generator
+     * identified by the given \p name. The number is bound to the
+     * {generator.${name}.output-partitioning.count} config parameter.
+     *
+     * @return The number of hash partitions.
+     */
+    I32u outputPartitioningCount(const String& name) const
+    {
+        return static_cast<I32u>(max(0, getInt(format("generator.%s.output-partitioning.count", name), 0)));
+    }
+
+    /**
+     * Returns the range partition boundaries for the output of the
+     * generator identified by the given \p name. The boundaries are bound to
+     * the {generator.${name}.output-partitioning.boundaries} config parameter
+     * as a comma separated list of integer keys (default is an empty list,
+     * i.e. hash partitioning). Boundaries are rejected for Decimal and String
+     * partitioning fields, whose keys are hashes.
+     *
+     * @return The ascending range partition boundaries.
+     */
+    vector<I64> outputPartitioningBoundaries(const String& name) const;
+
+    /**
+     * Returns the output buffer size per partition for the generator
+     * identified by the given \p name. The size is bound to the
+     * {generator.${name}.output-partitioning.buffer-size} config parameter
+     * (default is 256kB).
+     *
+     * @return The output buffer size per partition in bytes.
+     */
+    size_t outputPartitioningBufferSize(const String& name) const
+    {
+        return static_cast<size_t>(max(4096, getInt(format("generator.%s.output-partitioning.buffer-size", name), 262144)));
+    }
+
     /**
      * Returns the application output type. The output type is bound to the
      * {application.output-type} config parameter and can be one of 'file',
-     * 'socket', or 'void' (default is 'file').
+     * 'socket', 'unix', 'fifo', 'shm', or 'void' (default is 'file').
      *
      * @return The \p AbstractOutputCollector type.
      */
@@ -247,6 +386,399 @@ public:
         return static_cast<I16u>(getInt("application.output-port", 0));
     }
 
+    /**
+     * Returns the output target for 'unix' and 'fifo' collectors, i.e. the
+     * socket path or the directory of the named pipes. The target is bound
+     * to the {application.output-target} config parameter.
+     *
+     * @return The output target for \p PipeOutputCollector instances.
+     */
+    String outputTarget() const
+    {
+        return getString("application.output-target", "");
+    }
+
+    /**
+     * Returns true if 'unix' and 'fifo' collectors should prefix each record
+     * batch with its length. The flag is bound to the
+     * {application.output-framing} config parameter (default is true).
+     *
+     * @return The framing flag for \p PipeOutputCollector instances.
+     */
+    bool outputFraming() const
+    {
+        return getBool("application.output-framing", true);
+    }
+
+    /**
+     * Returns true if 'fifo' collectors should splice their output into the
+     * pipe on Linux. The flag is bound to the {application.output-splice}
+     * config parameter (default is true).
+     *
+     * @return The splice flag for \p PipeOutputCollector instances.
+     */
+    bool outputSplice() const
+    {
+        return getBool("application.output-splice", true);
+    }
+
+    /**
+     * Returns the maximal record batch size for 'unix' and 'fifo' collectors.
+     * The size is bound to the {application.output-stream-buffer-size} config
+     * parameter (default is 1MB).
+     *
+     * @return The batch size for \p PipeOutputCollector instances.
+     */
+    size_t outputStreamBufferSize() const
+    {
+        return static_cast<size_t>(max(4096, getInt("application.output-stream-buffer-size", 1048576)));
+    }
+
+    /**
+     * Returns the ring size for 'shm' collectors. The size is bound to the
+     * {application.output-shm-size} config parameter (default is 64MB).
+     *
+     * @return The number of data bytes in \p ShmRingOutputCollector rings.
+     */
+    size_t outputShmSize() const
+    {
+        return static_cast<size_t>(max(65536, getInt("application.output-shm-size", 67108864)));
+    }
+
+    /**
+     * Returns the maximal record batch size for 'shm' collectors. The size is
+     * bound to the {application.output-shm-batch-size} config parameter
+     * (default is 1MB).
+     *
+     * @return The batch size for \p ShmRingOutputCollector instances.
+     */
+    size_t outputShmBatchSize() const
+    {
+        return static_cast<size_t>(max(4096, getInt("application.output-shm-batch-size", 1048576)));
+    }
+
+    /**
+     * Returns the time 'shm' collectors wait for the consumer while the ring
+     * is full. The time is bound to the {application.output-shm-timeout}
+     * config parameter (default is 60000ms, 0 waits forever).
+     *
+     * @return The consumer wait timeout in milliseconds.
+     */
+    unsigned long outputShmTimeout() const
+    {
+        return static_cast<unsigned long>(max(0, getInt("application.output-shm-timeout", 60000)));
+    }
+
+    /**
+     * Returns the compression codec for 'file' output. The codec is bound to
+     * the {application.output-compression} config parameter and can be one
+     * of 'none', 'gzip' or 'lz4' (default is 'none'). The 'lz4' codec is
+     * only available in builds configured with the --lz4-prefix option.
+     *
+     * @return The compression codec for \p CompressedFileOutputCollector
+     *         instances.
+     */
+    String outputCompression() const
+    {
+        return getString("application.output-compression", "none");
+    }
+
+    /**
+     * Returns the compression level for compressed 'file' output. The level
+     * is bound to the {application.output-compression-level} config
+     * parameter and ranges from 0 to 9 (default is 6 for 'gzip' and 1 for
+     * 'lz4', where levels below 3 select the fast mode).
+     *
+     * @return The compression level.
+     */
+    int outputCompressionLevel() const
+    {
+        return getInt("application.output-compression-level", outputCompression() == "lz4" ? 1 : 6);
+    }
+
+    /**
+     * Returns the number of compression threads per output file. The number
+     * is bound to the {application.output-compression-threads} config
+     * parameter (default is 2).
+     *
+     * @return The number of compression threads.
+     */
+    size_t outputCompressionThreads() const
+    {
+        return static_cast<size_t>(max(1, getInt("application.output-compression-threads", 2)));
+    }
+
+    /**
+     * Returns the (uncompressed) size in bytes after which 'file' output is
+     * continued in a new file. The size is bound to the
+     * {application.output-roll-bytes} config parameter (default is 0, i.e.
+     * no size limit).
+     *
+     * @return The file size limit for \p RollingFileOutputCollector
+     *         instances.
+     */
+    I64u outputRollBytes() const
+    {
+        return fromString<I64u>(getString("application.output-roll-bytes", "0"));
+    }
+
+    /**
+     * Returns the number of records after which 'file' output is continued
+     * in a new file. The number is bound to the
+     * {application.output-roll-records} config parameter (default is 0, i.e.
+     * no record limit).
+     *
+     * @return The record limit for \p RollingFileOutputCollector instances.
+     */
+    I64u outputRollRecords() const
+    {
+        return fromString<I64u>(getString("application.output-roll-records", "0"));
+    }
+
+    /**
+     * Returns the writer backend for uncompressed 'file' output. The backend
+     * is bound to the {application.output-writer} config parameter and can
+     * be one of 'stream', 'uring' or 'mmap' (default is 'stream').
+     *
+     * @return The writer backend.
+     */
+    String outputWriter() const
+    {
+        return getString("application.output-writer", "stream");
+    }
+
+    /**
+     * Returns the number of buffers in flight per output file for the
+     * 'uring' writer backend. The number is bound to the
+     * {application.output-writer-depth} config parameter (default is 4).
+     *
+     * @return The writer queue depth.
+     */
+    size_t outputWriterDepth() const
+    {
+        return static_cast<size_t>(max(1, getInt("application.output-writer-depth", 4)));
+    }
+
+    /**
+     * Returns the buffer size for the 'uring' writer backend. The size is
+     * bound to the {application.output-writer-buffer-size} config parameter
+     * (default is 4MB).
+     *
+     * @return The writer buffer size in bytes.
+     */
+    size_t outputWriterBufferSize() const
+    {
+        return static_cast<size_t>(max(4096, getInt("application.output-writer-buffer-size", 4194304)));
+    }
+
+    /**
+     * Returns true if the 'uring' writer backend should bypass the page
+     * cache. The flag is bound to the {application.output-direct-io} config
+     * parameter (default is false).
+     *
+     * @return The direct I/O flag.
+     */
+    bool outputDirectIO() const
+    {
+        return getBool("application.output-direct-io", false);
+    }
+
+    /**
+     * Returns the window size for the 'mmap' writer backend. The size is
+     * bound to the {application.output-mmap-window} config parameter
+     * (default is 64MB).
+     *
+     * @return The size of the mapped file window in bytes.
+     */
+    size_t outputMappingWindow() const
+    {
+        return static_cast<size_t>(max(4096, getInt("application.output-mmap-window", 67108864)));
+    }
+
+    /**
+     * Returns the number of records of the sequence identified by \p name
+     * generated by the current node, or zero if the partition bounds are not
+     * configured.
+     *
+     * @return The size of the [genIDBegin(name), genIDEnd(name)) range.
+     */
+    I64u outputRecordEstimate(const string name) const
+    {
+        if (!has("generator." + name + ".partition.begin") || !has("generator." + name + ".partition.end"))
+        {
+            return 0;
+        }
+
+        const I64u begin = genIDBegin(name);
+        const I64u end = genIDEnd(name);
+
+        return end > begin ? end - begin : 0;
+    }
+
+    /**
+     * Returns true if stage tasks should be started as soon as the stages
+     * they depend on are completed instead of waiting for the previous stage
+     * as a whole. The flag is bound to the {application.pipeline-stages}
+     * config parameter (default is false).
+     *
+     * @return The stage pipelining flag.
+     */
+    bool pipelineStages() const
+    {
+        return getBool("application.pipeline-stages", false);
+    }
+
+    /**
+     * Returns the minimal number of seconds between two checkpoints of the
+     * record sequence iterator tasks. The value is bound to the
+     * {application.checkpoint-interval} config parameter (default is 60).
+     * A value of 0 disables checkpoints.
+     *
+     * @return The checkpoint interval in seconds, or 0 if checkpoints are
+     *         disabled.
+     * @throw ConfigException if the configured value is negative
+     */
+    I32u checkpointInterval() const
+    {
+        const int interval = getInt("application.checkpoint-interval", 60);
+
+        if (interval < 0)
+        {
+            throw ConfigException(format("Invalid checkpoint interval %d (expected a number of seconds or 0 to disable checkpoints)", interval));
+        }
+
+        return static_cast<I32u>(interval);
+    }
+
+    /**
+     * Returns true if the stage tasks should continue at their last
+     * checkpoint instead of starting from scratch. The flag is bound to the
+     * {application.resume} config parameter (default is false), which is set
+     * by the <tt>--resume</tt> command line option.
+     *
+     * @return The resume flag.
+     */
+    bool resume() const
+    {
+        return getBool("application.resume", false);
+    }
+
+    /**
+     * Returns true if the stage task threads should be spread over the NUMA
+     * nodes of the host. The flag is bound to the {application.numa} config
+     * parameter (default is false).
+     *
+     * @return The NUMA placement flag.
+     */
+    bool numa() const
+    {
+        return getBool("application.numa", false);
+    }
+
+    /**
+     * Returns the maximal size in bytes of a function specification that is
+     * replicated on each NUMA node. The value is bound to the
+     * {application.numa-replicate-size} config parameter (default is
+     * 16777216, 0 disables replication).
+     *
+     * @return The maximal size of replicated function specifications.
+     */
+    I64u numaReplicateSize() const
+    {
+        return fromString<I64u>(getString("application.numa-replicate-size", "16777216"));
+    }
+
+    /**
+     * Returns the number of records between two profiled setter chain
+     * invocations. The value is bound to the
+     * {application.setter-profile-interval} config parameter (default is 0,
+     * which disables setter profiling).
+     *
+     * @return The setter profiling interval in records.
+     */
+    I32u setterProfileInterval() const
+    {
+        return getInt("application.setter-profile-interval", 0);
+    }
+
+    /**
+     * Returns true if the hardware performance counters of each stage task
+     * should be recorded. The flag is bound to the
+     * {application.perf-counters} config parameter (default is false).
+     *
+     * @return The performance counters flag.
+     */
+    bool perfCounters() const
+    {
+        return getBool("application.perf-counters", false);
+    }
+
+    /**
+     * Returns the path of the JSON run report with the hardware performance
+     * counters of the stage tasks. The report is written next to the node
+     * log in the {application.job-dir} (e.g. log/node000.perf.json).
+     *
+     * @return The path of the performance counter report.
+     */
+    Path perfReportPath() const
+    {
+        Path path(getString("application.log-path"));
+        path.setExtension("perf.json");
+
+        return path;
+    }
+
+    /**
+     * Returns the regular expression selecting the microbenchmarks executed
+     * in benchmark mode. The value is bound to the {application.bench} config
+     * parameter (default is an empty string, which selects all benchmarks).
+     *
+     * @return The benchmark name filter.
+     */
+    string benchFilter() const
+    {
+        return getString("application.bench", "");
+    }
+
+    /**
+     * Returns the minimal measured time per benchmark run in seconds. The
+     * value is bound to the {application.bench-min-time} config parameter
+     * (default is 0.5).
+     *
+     * @return The minimal benchmark run time in seconds.
+     */
+    Decimal benchMinTime() const
+    {
+        return getDouble("application.bench-min-time", 0.5);
+    }
+
+    /**
+     * Returns the number of repetitions of each benchmark run. The value is
+     * bound to the {application.bench-repetitions} config parameter (default
+     * is 1).
+     *
+     * @return The number of benchmark repetitions.
+     */
+    I32u benchRepetitions() const
+    {
+        return getInt("application.bench-repetitions", 1);
+    }
+
+    /**
+     * Returns the path of the JSON file with the benchmark results. The path
+     * is bound to the {application.bench-output} config parameter (default is
+     * bench.json in the {application.output-dir}).
+     *
+     * @return The path of the benchmark results file.
+     */
+    Path benchOutput() const
+    {
+        Path path(getString("application.bench-output", "bench.json"));
+        path.makeAbsolute(getString("application.output-dir"));
+
+        return path;
+    }
+
     /**
      * Returns the scaling factor for the data generator application.
      *
@@ -286,6 +818,20 @@ public:
         return getInt("common.partitioning.chunks-id");
     }
 
+    /**
+     * Returns the chunk IDs of all partitions generated by this process.
+     *
+     * The retrieved value is parsed from the 'application.node-id' key,
+     * which contains a single chunk ID or a partition set (see
+     * parseNodeIDs()).
+     *
+     * @return the chunk IDs generated by this process
+     */
+    vector<I16u> nodeIDs() const
+    {
+        return parseNodeIDs(getString("application.node-id", "0"));
+    }
+
     /**
      * Returns a reference to the application generator pool.
      *
@@ -335,6 +881,22 @@ protected:
     {
     }
 
+    /**
+     * Runs all queued loader tasks concurrently and registers the loaded
+     * entries with the function and enum set pools in the order in which
+     * they were queued.
+     *
+     * The method is invoked by initialize() after configureSets(), but can
+     * also be called explicitly by GeneratorConfig specializations that need
+     * to access deferred entries within configureFunctions() or
+     * configureSets(). The number of loader threads is bound to the
+     * 'application.loader-threads' parameter (default is the number of
+     * available processors).
+     *
+     * @throw Exception the first exception raised by a loader task
+     */
+    void loadPending();
+
     /**
      * Helper partitioning function for fixed size subsequences.
      *
@@ -356,6 +918,18 @@ protected:
      */
     const string resolveValue(const string& value);
 
+    /**
+     * Loads replicas of the entries of the given \p loaders for each NUMA
+     * node. The replicas of each node are loaded by a thread bound to that
+     * node, so they are allocated in node local memory.
+     */
+    void loadReplicas(const vector<AbstractLoaderTask*>& loaders);
+
+    /**
+     * Releases all queued loader tasks.
+     */
+    void clearPending();
+
     /**
      * A regular expression that matches parameter references (i.e. "${...}" strings).
      */
@@ -376,11 +950,21 @@ protected:
      */
     FunctionPool _functionPool;
 
+    /**
+     * The NUMA node local function replicas, indexed by the node index.
+     */
+    vector<FunctionPool*> _functionReplicas;
+
     /**
      * The global enum sets pool.
      */
     EnumSetPool _enumSetPool;
 
+    /**
+     * Loader tasks queued since the last loadPending() call.
+     */
+    vector<AbstractLoaderTask*> _pendingLoaders;
+
     /**
      * An auto-release pool for the registered logger channel(s).
      */
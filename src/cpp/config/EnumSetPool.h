@@ -77,6 +77,22 @@ public:
         _enumSets[enumSetPtr->name()] = enumSetPtr;
     }
 
+    /**
+     * Adds all enum sets registered with the \p other pool. The enum sets
+     * are shared and not copied.
+     *
+     * @param other The pool whose enum sets are added.
+     * @throw ConfigException if one of the enum sets is already registered
+     */
+    void addAll(const EnumSetPool& other)
+    {
+        for (map<string, MyriadEnumSet*>::const_iterator it = other._enumSets.begin(); it != other._enumSets.end(); ++it)
+        {
+	        it->second->duplicate();
+	        add(it->second);
+        }
+    }
+
     /**
      * Retrieve the enum set identified by the given \p name.
      *
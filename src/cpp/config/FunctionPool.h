@@ -77,6 +77,30 @@ public:
         _functions[functionPtr->name()] = functionPtr;
     }
 
+    /**
+     * Adds all functions registered with the \p other pool. The functions
+     * are shared and not copied.
+     *
+     * @param other The pool whose functions are added.
+     * @throw ConfigException if one of the functions is already registered
+     */
+    void addAll(const FunctionPool& other)
+    {
+        for (map<string, AbstractFunction*>::const_iterator it = other._functions.begin(); it != other._functions.end(); ++it)
+        {
+	        it->second->duplicate();
+	        add(it->second);
+        }
+    }
+
+    /**
+     * Checks whether a function with the given \p name is registered.
+     */
+    bool contains(const string& name) const
+    {
+        return _functions.find(name) != _functions.end();
+    }
+
     /**
      * Get a type-safe version of an already registered function identified by
      * the given \p name.
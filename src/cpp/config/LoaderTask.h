@@ -0,0 +1,278 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef LOADERTASK_H_
+#define LOADERTASK_H_
+
+#include "config/EnumSetPool.h"
+#include "config/FunctionPool.h"
+#include "core/types/MyriadEnumSet.h"
+
+#include <string>
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/Runnable.h>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup config
+ * @{*/
+
+/**
+ * An abstract base for deferred loading of file based configuration entries.
+ *
+ * Loader tasks are queued by the AbstractGeneratorConfig while the
+ * configureFunctions() and configureSets() methods are executed and are run
+ * concurrently on a thread pool afterwards. A task never touches the shared
+ * FunctionPool or EnumSetPool instances while running - the loaded object is
+ * kept by the task and registered by the main thread with commit() once all
+ * tasks have finished.
+ *
+ * Exceptions thrown by the load() method are captured and rethrown by
+ * commit(), so load failures surface on the main thread.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class AbstractLoaderTask: public Runnable
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param name The name of the loaded configuration entry.
+     * @param path The location of the file to load the entry from.
+     */
+    AbstractLoaderTask(const string& name, const string& path) :
+        _name(name),
+        _path(path),
+        _exception(NULL)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractLoaderTask()
+    {
+        if (_exception != NULL)
+        {
+            delete _exception;
+        }
+    }
+
+    /**
+     * Runs the load() method and captures any exceptions thrown by it.
+     */
+    void run()
+    {
+        try
+        {
+            load();
+        }
+        catch(const Exception& e)
+        {
+            _exception = e.clone();
+        }
+        catch(const std::exception& e)
+        {
+            _exception = new RuntimeException(format("Cannot load `%s` from `%s`: %s", _name, _path, string(e.what())));
+        }
+        catch(...)
+        {
+            _exception = new RuntimeException(format("Cannot load `%s` from `%s`", _name, _path));
+        }
+    }
+
+    /**
+     * Rethrows the exception captured while running the task or registers
+     * the loaded entry with the corresponding pool.
+     */
+    void commit(FunctionPool& functions, EnumSetPool& enumSets)
+    {
+        if (_exception != NULL)
+        {
+            _exception->rethrow();
+        }
+
+        doCommit(functions, enumSets);
+    }
+
+    /**
+     * Returns the name of the loaded configuration entry.
+     */
+    const string& name() const
+    {
+        return _name;
+    }
+
+    /**
+     * Returns the location of the file to load the entry from.
+     */
+    const string& path() const
+    {
+        return _path;
+    }
+
+    /**
+     * Returns a new task that loads another copy of the same entry, or NULL
+     * if the entry cannot be replicated. Used to create NUMA node local
+     * replicas of read-only entries.
+     */
+    virtual AbstractLoaderTask* replica() const
+    {
+        return NULL;
+    }
+
+protected:
+
+    /**
+     * Loads the configuration entry. Invoked from a loader thread.
+     */
+    virtual void load() = 0;
+
+    /**
+     * Registers the loaded entry. Invoked from the main thread.
+     */
+    virtual void doCommit(FunctionPool& functions, EnumSetPool& enumSets) = 0;
+
+    /**
+     * The name of the loaded configuration entry.
+     */
+    const string _name;
+
+    /**
+     * The location of the file to load the entry from.
+     */
+    const string _path;
+
+private:
+
+    /**
+     * A copy of the exception thrown by load(), if any.
+     */
+    Exception* _exception;
+};
+
+/**
+ * A loader task for functions constructed from a (name, path) pair, e.g.
+ * CombinedPrFunction or ConditionalCombinedPrFunction instances.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class FunctionType>
+class FunctionLoaderTask: public AbstractLoaderTask
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    FunctionLoaderTask(const string& name, const string& path) :
+        AbstractLoaderTask(name, path),
+        _function(NULL)
+    {
+    }
+
+    /**
+     * Destructor. Releases the loaded function if it was never committed.
+     */
+    virtual ~FunctionLoaderTask()
+    {
+        if (_function != NULL)
+        {
+            _function->release();
+        }
+    }
+
+    virtual AbstractLoaderTask* replica() const
+    {
+        return new FunctionLoaderTask<FunctionType>(_name, _path);
+    }
+
+protected:
+
+    virtual void load()
+    {
+        _function = new FunctionType(_name, _path);
+    }
+
+    virtual void doCommit(FunctionPool& functions, EnumSetPool& enumSets)
+    {
+        functions.add(_function);
+        _function = NULL;
+    }
+
+private:
+
+    FunctionType* _function;
+};
+
+/**
+ * A loader task for MyriadEnumSet instances.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class EnumSetLoaderTask: public AbstractLoaderTask
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    EnumSetLoaderTask(const string& name, const string& path) :
+        AbstractLoaderTask(name, path),
+        _enumSet(NULL)
+    {
+    }
+
+    /**
+     * Destructor. Releases the loaded enum set if it was never committed.
+     */
+    virtual ~EnumSetLoaderTask()
+    {
+        if (_enumSet != NULL)
+        {
+            _enumSet->release();
+        }
+    }
+
+protected:
+
+    virtual void load()
+    {
+        _enumSet = new MyriadEnumSet(_name, _path);
+    }
+
+    virtual void doCommit(FunctionPool& functions, EnumSetPool& enumSets)
+    {
+        enumSets.add(_enumSet);
+        _enumSet = NULL;
+    }
+
+private:
+
+    MyriadEnumSet* _enumSet;
+};
+
+/** @}*/// add to config group
+} // namespace Myriad
+
+#endif /* LOADERTASK_H_ */
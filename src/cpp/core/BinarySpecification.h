@@ -0,0 +1,306 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BINARYSPECIFICATION_H_
+#define BINARYSPECIFICATION_H_
+
+#include "core/exceptions.h"
+#include "core/NumaTopology.h"
+#include "core/types.h"
+
+#include <Poco/File.h>
+#include <Poco/Format.h>
+#include <Poco/Path.h>
+#include <Poco/RefCountedObject.h>
+#include <Poco/SharedMemory.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// the binary specifications are read in place without byte swapping
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Binary specifications are only supported on little-endian hosts"
+#endif
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * A read-only view of a precompiled (binary) specification file.
+ *
+ * Binary specifications are produced from the textual *.distribution and
+ * *.domain files by the <tt>compile:distributions</tt> assistant task and
+ * are stored next to their source as <tt>${path}.bin</tt>. The file is mapped
+ * read-only into memory, so the mapped pages are shared by all generator
+ * processes running on the same host. Specifications opened by a thread that
+ * is bound to a NUMA node (see NumaTopology::bind()) are read into a private
+ * copy instead, so the copy is allocated on that node.
+ *
+ * All multi-byte values are stored in little-endian byte order (which must be
+ * the byte order of the host, as the values are not swapped on load) and all
+ * sections are aligned at 8 bytes. A file starts with a fixed-size Header,
+ * followed by a layout that depends on the specification kind:
+ *
+ * - <tt>COMBINED_PR_FUNCTION</tt>: a single combined function section (see
+ *   below) at offset sizeof(Header).
+ * - <tt>CONDITIONAL_COMBINED_PR_FUNCTION</tt>: <tt>2 * count</tt> slots with
+ *   the [min, max) condition bounds, followed by \p count I64u section offsets
+ *   pointing to the combined function sections of the individual conditions.
+ * - <tt>ENUM_SET</tt>: <tt>count + 1</tt> I64u offsets into a string pool that
+ *   follows immediately after the offsets.
+ *
+ * A combined function section consists of the following fields:
+ * <tt>I64u numberOfValues, I64u numberOfBuckets, Decimal notNullProbability,
+ * Decimal valueProbability, Decimal bucketProbability, Slot values[],
+ * Decimal valueProbabilities[], Slot bucketBounds[2 * numberOfBuckets],
+ * Decimal bucketProbabilities[], Decimal cumulativeProbabilities[]</tt>.
+ *
+ * Domain values are stored in 8-byte slots whose interpretation is given by
+ * the Encoding of the header.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class BinarySpecification: public Poco::RefCountedObject
+{
+public:
+
+    /**
+     * The kind of the specification stored in the file.
+     */
+    enum Kind
+    {
+        COMBINED_PR_FUNCTION = 1, CONDITIONAL_COMBINED_PR_FUNCTION = 2, ENUM_SET = 3
+    };
+
+    /**
+     * The encoding of domain values stored in 8-byte slots.
+     */
+    enum Encoding
+    {
+        NONE = 0, //!< No values.
+        INTEGER = 1, //!< Signed 64-bit integers.
+        DECIMAL = 2, //!< 64-bit floating point numbers.
+        CHAR = 3, //!< Character codes stored as signed 64-bit integers.
+        DATE = 4 //!< Proleptic Gregorian ordinals (0001-01-01 is day 1).
+    };
+
+    /**
+     * The binary file header.
+     */
+    struct Header
+    {
+        char magic[8]; //!< Always equal to MAGIC.
+        I32u kind; //!< The specification Kind.
+        I32u valueEncoding; //!< The Encoding of the domain values.
+        I32u conditionEncoding; //!< The Encoding of the condition values.
+        I32u version; //!< The format version.
+        I64u count; //!< The number of conditions or enum values.
+    };
+
+    /**
+     * The magic bytes at the beginning of each binary specification.
+     */
+    static const char* MAGIC;
+
+    /**
+     * The format version written by the assistant.
+     */
+    static const I32u VERSION = 1;
+
+    /**
+     * Maps the binary specification at the given \p path and validates its
+     * header against the \p expected specification kind.
+     *
+     * @param path The location of the binary specification file.
+     * @param expected The expected specification kind.
+     */
+    BinarySpecification(const Path& path, Kind expected) :
+        _path(path.toString()),
+        _begin(NULL),
+        _end(NULL)
+    {
+        if (NumaTopology::boundNode() < 0)
+        {
+            _memory = SharedMemory(File(path), SharedMemory::AM_READ);
+            _begin = _memory.begin();
+            _end = _memory.end();
+        }
+        else
+        {
+            ifstream in(_path.c_str(), ios::in | ios::binary);
+            _copy.resize(static_cast<size_t>(File(path).getSize()));
+
+            if (!_copy.empty() && !in.read(&_copy[0], static_cast<streamsize>(_copy.size())))
+            {
+                throw DataException(format("Cannot read binary specification `%s`", _path));
+            }
+
+            _begin = _copy.empty() ? NULL : &_copy[0];
+            _end = _begin + _copy.size();
+        }
+
+        if (size() < sizeof(Header))
+        {
+            throw DataException(format("Truncated binary specification `%s`", _path));
+        }
+
+        const Header& h = header();
+
+        if (std::memcmp(h.magic, MAGIC, sizeof(h.magic)) != 0 || h.version != VERSION)
+        {
+            throw DataException(format("Unsupported binary specification format in `%s`", _path));
+        }
+
+        if (h.kind != static_cast<I32u>(expected))
+        {
+            throw DataException(format("Unexpected binary specification kind %u in `%s`", h.kind, _path));
+        }
+    }
+
+    /**
+     * Returns the location of the binary specification compiled from the
+     * textual specification at \p path.
+     */
+    static Path compiledPath(const Path& path)
+    {
+        return Path(path.toString() + ".bin");
+    }
+
+    /**
+     * Checks whether an up-to-date binary specification compiled from the
+     * textual specification at \p path exists.
+     */
+    static bool available(const Path& path)
+    {
+        File binary(compiledPath(path));
+
+        if (!binary.exists() || !binary.canRead())
+        {
+            return false;
+        }
+
+        File source(path);
+
+        return !source.exists() || !(binary.getLastModified() < source.getLastModified());
+    }
+
+    /**
+     * Returns the path of the mapped file.
+     */
+    const string& path() const
+    {
+        return _path;
+    }
+
+    /**
+     * Returns the size of the mapped file in bytes.
+     */
+    size_t size() const
+    {
+        return static_cast<size_t>(_end - _begin);
+    }
+
+    /**
+     * Returns the file header.
+     */
+    const Header& header() const
+    {
+        return *reinterpret_cast<const Header*>(_begin);
+    }
+
+    /**
+     * Returns a pointer to \p n consecutive \p T values starting at the given
+     * byte \p offset, checking that they are within the file bounds.
+     */
+    template<typename T> const T* at(size_t offset, size_t n = 1) const
+    {
+        if (offset > size() || n > (size() - offset) / sizeof(T))
+        {
+            throw DataException(format("Truncated binary specification `%s`", _path));
+        }
+
+        return reinterpret_cast<const T*>(_begin + offset);
+    }
+
+private:
+
+    const string _path;
+
+    SharedMemory _memory;
+
+    /**
+     * The private copy of the file contents (if not mapped).
+     */
+    vector<char> _copy;
+
+    const char* _begin;
+
+    const char* _end;
+};
+
+/**
+ * Decodes domain values of type \p T from the 8-byte slots of a
+ * BinarySpecification.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename T> struct BinarySpecificationSlot
+{
+    static T decode(const I64* slot, I32u encoding)
+    {
+        switch (encoding)
+        {
+        case BinarySpecification::INTEGER:
+        case BinarySpecification::CHAR:
+            return static_cast<T>(*slot);
+        case BinarySpecification::DECIMAL:
+            return static_cast<T>(*reinterpret_cast<const Decimal*>(slot));
+        default:
+            throw DataException(format("Unsupported binary value encoding %u", encoding));
+        }
+    }
+};
+
+/**
+ * Date specialization of the BinarySpecificationSlot template.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<> struct BinarySpecificationSlot<Date>
+{
+    static Date decode(const I64* slot, I32u encoding)
+    {
+        if (encoding != BinarySpecification::DATE)
+        {
+            throw DataException(format("Unsupported binary value encoding %u for Date values", encoding));
+        }
+
+        return Date::fromDayNumber(static_cast<Int32>(*slot));
+    }
+};
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* BINARYSPECIFICATION_H_ */
@@ -144,10 +144,11 @@ void Frontend::defineOptions(OptionSet& options)
 	        .argument("<string>")
 	        .binding("application.job-id"));
 
-    options.addOption(Option("node-id", "i", "node ID (i.e. partition number) of the current generating node")
+    options.addOption(Option("node-id", "i", "node ID (i.e. partition number) of the current generating node, or a partition set generated by this process (e.g. '0-15' or '0,4,8-11')")
 	        .required(false)
 	        .repeatable(false)
-	        .argument("<int>")
+	        .argument("<ids>")
+	        .validator(new RegExpValidator("^\\d+(-\\d+)?(,\\d+(-\\d+)?)*$"))
 	        .binding("application.node-id"));
 
     options.addOption(Option("node-count", "N", "total node count (i.e. total number of partitions)")
@@ -174,11 +175,11 @@ void Frontend::defineOptions(OptionSet& options)
 	        .argument("<path>")
 	        .binding("application.output-base"));
 
-    options.addOption(Option("output-type", "t", "output collector type ('file', 'socket[port]', or 'void')")
+    options.addOption(Option("output-type", "t", "output collector type ('file', 'socket[port]', 'unix[path]', 'fifo[path]', 'shm', or 'void')")
             .required(false)
             .repeatable(false)
             .argument("<type>")
-            .validator(new RegExpValidator("^(file|socket\\[\\d{4,5}\\]|void)$"))
+            .validator(new RegExpValidator("^(file|socket\\[\\d{4,5}\\]|unix\\[[^\\]]+\\]|fifo\\[[^\\]]+\\]|shm|void)$"))
             .callback(OptionCallback<Frontend> (this, &Frontend::handleOutputType)));
 
     options.addOption(Option("coordinator-host", "H", "coordinator server hostname")
@@ -193,11 +194,33 @@ void Frontend::defineOptions(OptionSet& options)
 	        .argument("<port>")
 	        .binding("application.coordinator.port"));
 
+    options.addOption(Option("metrics-port", "M", "serve live node and task metrics for Prometheus at http://localhost:<port>/metrics")
+	        .required(false)
+	        .repeatable(false)
+	        .argument("<port>")
+	        .binding("application.metrics-port"));
+
+    options.addOption(Option("profile-setters", "p", "sample the cost of each setter every <n> records and report it after each stage")
+	        .required(false)
+	        .repeatable(false)
+	        .argument("<n>")
+	        .binding("application.setter-profile-interval"));
+
+    options.addOption(Option("perf-counters", "C", "record the hardware performance counters of each generator thread and stage in a JSON report next to the node log")
+	        .required(false)
+	        .repeatable(false)
+	        .callback(OptionCallback<Frontend> (this, &Frontend::handlePerfCounters)));
+
     options.addOption(Option("execute-stages", "x", "specify a specifc stage to be executed")
 	        .required(false)
 	        .repeatable(true)
 	        .argument("<stagename>")
 	        .callback(OptionCallback<Frontend> (this, &Frontend::handleExecuteStage)));
+
+    options.addOption(Option("resume", "r", "resume the generator tasks at their last checkpoint")
+	        .required(false)
+	        .repeatable(false)
+	        .callback(OptionCallback<Frontend> (this, &Frontend::handleResume)));
 }
 
 void Frontend::handleExecuteStage(const string& name, const string& stage)
@@ -213,6 +236,16 @@ void Frontend::handleExecuteStage(const string& name, const string& stage)
     }
 }
 
+void Frontend::handleResume(const string& name, const string& value)
+{
+    config().setBool("application.resume", true);
+}
+
+void Frontend::handlePerfCounters(const string& name, const string& value)
+{
+    config().setBool("application.perf-counters", true);
+}
+
 void Frontend::handleOutputType(const string& name, const string& value)
 {
     if (value.substr(0, 4) == "file")
@@ -229,6 +262,20 @@ void Frontend::handleOutputType(const string& name, const string& value)
         _ui.information("Output type is " + config().getString("application.output-type"));
         _ui.information("Output port is " + toString<int>(config().getInt("application.output-port")));
     }
+    else if (value.substr(0, 4) == "unix" || value.substr(0, 4) == "fifo")
+    {
+        config().setString("application.output-type", value.substr(0, 4));
+        config().setString("application.output-target", value.substr(5, value.size()-6));
+
+        _ui.information("Output type is " + config().getString("application.output-type"));
+        _ui.information("Output target is " + config().getString("application.output-target"));
+    }
+    else if (value == "shm")
+    {
+        config().setString("application.output-type", "shm");
+
+        _ui.information("Output type is " + config().getString("application.output-type"));
+    }
     else if (value.substr(0, 6) == "void")
     {
         config().setString("application.output-type", "void");
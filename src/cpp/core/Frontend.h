@@ -77,6 +77,26 @@ public:
      */
     void handleExecuteStage(const std::string& name, const std::string& value);
 
+    /**
+     * Handles the occurence of a '--resume' CLI parameter.
+     *
+     * Sets the 'application.resume' parameter, so the generator tasks
+     * continue at their last checkpoint instead of starting from scratch.
+     *
+     * @param name The name of the processed parameter (always `resume`).
+     * @param value The value of the processed parameter (always empty).
+     */
+    void handleResume(const std::string& name, const std::string& value);
+
+    /**
+     * Sets the 'application.perf-counters' parameter, so the hardware
+     * performance counters of the generator threads are recorded.
+     *
+     * @param name The name of the processed parameter (always `perf-counters`).
+     * @param value The value of the processed parameter (always empty).
+     */
+    void handlePerfCounters(const std::string& name, const std::string& value);
+
     /**
      * Handles the '-o<output-type>' CLI parameter.
      *
@@ -87,8 +107,15 @@ public:
      * parameter to 'socket' and the 'application.output-port' parameter to the
      * given port.
      *
+     * If the parameter is 'unix(path)' or 'fifo(path)', sets the
+     * 'application.output-type' parameter to 'unix' or 'fifo' and the
+     * 'application.output-target' parameter to the given path.
+     *
+     * If the parameter is 'shm', sets the 'application.output-type' parameter
+     * to 'shm'.
+     *
      * @param name The name of the processed parameter (always `output-type`).
-     * @param value The processed value (`file` or `socket(port)`).
+     * @param value The processed value (`file`, `socket(port)`, `unix(path)`, `fifo(path)`, or `shm`).
      */
     void handleOutputType(const std::string& name, const std::string& value);
 
@@ -119,8 +146,6 @@ protected:
      */
     int main(const std::vector<std::string>& args);
 
-private:
-
     vector<bool> _executeStages;
 
     bool _metaInfoRequested;
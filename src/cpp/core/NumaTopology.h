@@ -0,0 +1,285 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef NUMATOPOLOGY_H_
+#define NUMATOPOLOGY_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/NumberParser.h>
+#include <Poco/StringTokenizer.h>
+#include <Poco/ThreadLocal.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * The NUMA nodes of the host and the CPUs attached to them.
+ *
+ * The topology is read from <tt>/sys/devices/system/node</tt>. Only nodes
+ * with CPUs are listed; they are addressed by their index in the topology
+ * rather than by the (possibly sparse) kernel node ID. On hosts without NUMA
+ * support the topology consists of a single node without CPUs, and binding
+ * to it has no effect.
+ *
+ * Memory placement relies on the default first-touch policy of the kernel:
+ * once a thread is bound to the CPUs of a node, the pages it touches first
+ * are allocated on that node.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class NumaTopology
+{
+public:
+
+    /**
+     * Returns the topology of the host. The topology is read once, on the
+     * first call.
+     */
+    static const NumaTopology& instance()
+    {
+        static NumaTopology topology;
+        return topology;
+    }
+
+    /**
+     * Returns the number of nodes with CPUs.
+     */
+    size_t size() const
+    {
+        return _nodes.size();
+    }
+
+    /**
+     * Returns the kernel ID of the node with the given \p index.
+     */
+    I16u id(size_t index) const
+    {
+        return _nodes[index].id;
+    }
+
+    /**
+     * Returns the CPUs attached to the node with the given \p index.
+     */
+    const vector<int>& cpus(size_t index) const
+    {
+        return _nodes[index].cpus;
+    }
+
+    /**
+     * Pins the calling thread to the CPUs of the node with the given
+     * \p index. Memory first touched by the thread afterwards is allocated
+     * on that node.
+     *
+     * @throw SystemException if the thread affinity cannot be set
+     */
+    void bind(size_t index) const
+    {
+#if defined(__linux__)
+        if (!_nodes[index].cpus.empty())
+        {
+	        cpu_set_t set;
+	        CPU_ZERO(&set);
+
+	        for (vector<int>::const_iterator it = _nodes[index].cpus.begin(); it != _nodes[index].cpus.end(); ++it)
+	        {
+		        CPU_SET(*it, &set);
+	        }
+
+	        // a zero thread ID refers to the calling thread
+	        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+	        {
+		        throw SystemException(format("Cannot bind thread to NUMA node %hu: %s", _nodes[index].id, string(strerror(errno))));
+	        }
+        }
+#endif
+
+        binding()->index = static_cast<int>(index);
+    }
+
+    /**
+     * Returns the index of the node the calling thread has been bound to
+     * with bind(), or -1 if the thread is not bound.
+     */
+    static int boundNode()
+    {
+        return binding()->index;
+    }
+
+    /**
+     * Moves the pages spanned by the \p length bytes starting at \p address
+     * to the node the calling thread is bound to. Pages which have not been
+     * touched yet are allocated on that node later. Placement is a hint, so
+     * failures are ignored.
+     */
+    void migrate(const void* address, size_t length) const
+    {
+#if defined(__linux__) && defined(__NR_mbind)
+        int index = boundNode();
+
+        if (index < 0 || length == 0)
+        {
+	        return;
+        }
+
+        // mbind() works on whole pages
+        const unsigned long pageSize = static_cast<unsigned long>(sysconf(_SC_PAGESIZE));
+        unsigned long begin = reinterpret_cast<unsigned long>(address) & ~(pageSize - 1);
+        unsigned long end = reinterpret_cast<unsigned long>(address) + length;
+
+        vector<unsigned long> mask(_nodes[index].id / (8 * sizeof(unsigned long)) + 1, 0);
+        mask[_nodes[index].id / (8 * sizeof(unsigned long))] |= 1UL << (_nodes[index].id % (8 * sizeof(unsigned long)));
+
+        syscall(__NR_mbind, begin, end - begin, MPOL_PREFERRED, &mask[0], mask.size() * 8 * sizeof(unsigned long) + 1, MPOL_MF_MOVE);
+#endif
+    }
+
+private:
+
+    /**
+     * A NUMA node.
+     */
+    struct Node
+    {
+        I16u id; //!< The kernel node ID.
+        vector<int> cpus; //!< The CPUs attached to the node.
+    };
+
+    /**
+     * The node binding of a thread.
+     */
+    struct Binding
+    {
+        Binding() :
+            index(-1)
+        {
+        }
+
+        int index; //!< The index of the bound node or -1.
+    };
+
+    /**
+     * Reads the topology of the host.
+     */
+    NumaTopology()
+    {
+        vector<int> nodeIDs;
+        parseList(read("/sys/devices/system/node/online"), nodeIDs);
+
+        for (vector<int>::const_iterator it = nodeIDs.begin(); it != nodeIDs.end(); ++it)
+        {
+	        Node node;
+	        node.id = static_cast<I16u>(*it);
+	        parseList(read(format("/sys/devices/system/node/node%d/cpulist", *it)), node.cpus);
+
+	        if (!node.cpus.empty())
+	        {
+		        _nodes.push_back(node);
+	        }
+        }
+
+        if (_nodes.empty())
+        {
+	        _nodes.push_back(Node());
+	        _nodes.back().id = 0;
+        }
+    }
+
+    /**
+     * Noncopyable.
+     */
+    NumaTopology(const NumaTopology&);
+
+    /**
+     * Noncopyable.
+     */
+    NumaTopology& operator=(const NumaTopology&);
+
+    /**
+     * Returns the first line of the file at the given \p path, or an empty
+     * string if the file cannot be read.
+     */
+    static string read(const string& path)
+    {
+        ifstream in(path.c_str());
+        string line;
+        getline(in, line);
+        return line;
+    }
+
+    /**
+     * Parses a kernel list of IDs and ID ranges (e.g. '0-3,8-11') into
+     * \p ids. Malformed entries are skipped.
+     */
+    static void parseList(const string& list, vector<int>& ids)
+    {
+        StringTokenizer tokenizer(list, ",", StringTokenizer::TOK_IGNORE_EMPTY | StringTokenizer::TOK_TRIM);
+        for (StringTokenizer::Iterator it = tokenizer.begin(); it != tokenizer.end(); ++it)
+        {
+	        size_t separator = it->find('-');
+
+	        int first, last;
+	        if (NumberParser::tryParse(it->substr(0, separator), first) && NumberParser::tryParse(separator == string::npos ? *it : it->substr(separator + 1), last))
+	        {
+		        for (int id = first; id <= last; id++)
+		        {
+			        ids.push_back(id);
+		        }
+	        }
+        }
+    }
+
+    /**
+     * Returns the node binding of the calling thread.
+     */
+    static ThreadLocal<Binding>& binding()
+    {
+        static ThreadLocal<Binding> binding;
+        return binding;
+    }
+
+    /**
+     * The nodes with CPUs.
+     */
+    vector<Node> _nodes;
+};
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* NUMATOPOLOGY_H_ */
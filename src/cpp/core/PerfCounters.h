@@ -0,0 +1,543 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include "core/constants.h"
+#include "core/json.h"
+#include "core/types.h"
+
+#include <Poco/DateTimeFormat.h>
+#include <Poco/DateTimeFormatter.h>
+#include <Poco/Environment.h>
+#include <Poco/Format.h>
+#include <Poco/Mutex.h>
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * The values of the hardware performance counters read by a PerfCounters
+ * group. Counters that could not be opened on the host are not contained in
+ * the events() mask and stay at zero.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct PerfSample
+{
+    /**
+     * The counted hardware events.
+     */
+    enum Event
+    {
+        CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, EVENTS
+    };
+
+    PerfSample() :
+        events(0),
+        timeEnabled(0),
+        timeRunning(0)
+    {
+        for (size_t i = 0; i < EVENTS; i++)
+        {
+            values[i] = 0;
+        }
+    }
+
+    /**
+     * Returns the name of the given \p event in the run report.
+     */
+    static const char* name(size_t event)
+    {
+        static const char* names[EVENTS] = { "cycles", "instructions", "cache_misses", "branch_misses" };
+        return names[event];
+    }
+
+    /**
+     * Returns true if the given \p event was counted.
+     */
+    bool has(size_t event) const
+    {
+        return (events & (1u << event)) != 0;
+    }
+
+    /**
+     * Adds the counter values of \p o to this sample.
+     */
+    void add(const PerfSample& o)
+    {
+        events |= o.events;
+        timeEnabled += o.timeEnabled;
+        timeRunning += o.timeRunning;
+
+        for (size_t i = 0; i < EVENTS; i++)
+        {
+            values[i] += o.values[i];
+        }
+    }
+
+    I32u events; //!< A bit mask of the counted events.
+    I64u values[EVENTS]; //!< The (scaled) counter values.
+    I64u timeEnabled; //!< The nanoseconds the counters were enabled.
+    I64u timeRunning; //!< The nanoseconds the counters were scheduled on the PMU.
+};
+
+/**
+ * A group of hardware performance counters (cycles, instructions, cache
+ * misses and branch misses) for the calling thread.
+ *
+ * The counters are opened with <tt>perf_event_open</tt> as a single event
+ * group led by the cycle counter, so they are scheduled on the PMU together
+ * and their ratios are consistent. Only user space events are counted, which
+ * is permitted for unprivileged processes up to a
+ * <tt>/proc/sys/kernel/perf_event_paranoid</tt> level of 2. If the kernel
+ * multiplexes the group with other events, the values are scaled by the
+ * ratio of the enabled and the running time.
+ *
+ * The group counts the thread that created it, so start() and stop() must be
+ * called from that thread. On hosts without a PMU (e.g. most virtual
+ * machines) or on platforms other than Linux the group is not available().
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class PerfCounters
+{
+public:
+
+    /**
+     * Opens the counters for the calling thread. The counters are disabled
+     * until start() is called.
+     */
+    PerfCounters() :
+        _size(0)
+    {
+        for (size_t i = 0; i < PerfSample::EVENTS; i++)
+        {
+            _fds[i] = -1;
+        }
+
+#if defined(__linux__) && defined(__NR_perf_event_open)
+        static const I64u configs[PerfSample::EVENTS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+        for (size_t i = 0; i < PerfSample::EVENTS; i++)
+        {
+	        struct perf_event_attr attr;
+	        memset(&attr, 0, sizeof(attr));
+	        attr.type = PERF_TYPE_HARDWARE;
+	        attr.size = sizeof(attr);
+	        attr.config = configs[i];
+	        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	        attr.disabled = i == PerfSample::CYCLES ? 1 : 0;
+	        attr.exclude_kernel = 1;
+	        attr.exclude_hv = 1;
+
+	        // a zero pid and a negative cpu count the calling thread on any CPU
+	        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, _fds[PerfSample::CYCLES], 0);
+
+	        if (fd < 0)
+	        {
+		        if (i == PerfSample::CYCLES)
+		        {
+			        _error = format("Cannot open hardware performance counters: %s", string(strerror(errno)));
+			        return;
+		        }
+
+		        continue; // the event is not supported by the PMU
+	        }
+
+	        _fds[i] = static_cast<int>(fd);
+	        _position[_size++] = i;
+        }
+#else
+        _error = "Hardware performance counters are not supported on this platform";
+#endif
+    }
+
+    /**
+     * Closes the counters.
+     */
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for (size_t i = 0; i < PerfSample::EVENTS; i++)
+        {
+	        if (_fds[i] >= 0)
+	        {
+		        close(_fds[i]);
+	        }
+        }
+#endif
+    }
+
+    /**
+     * Returns true if at least the cycle counter could be opened.
+     */
+    bool available() const
+    {
+        return _fds[PerfSample::CYCLES] >= 0;
+    }
+
+    /**
+     * Returns the reason why the counters are not available().
+     */
+    const string& error() const
+    {
+        return _error;
+    }
+
+    /**
+     * Resets and enables the counters.
+     */
+    void start()
+    {
+#if defined(__linux__)
+        if (available())
+        {
+	        ioctl(_fds[PerfSample::CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	        ioctl(_fds[PerfSample::CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    /**
+     * Disables the counters and returns the events counted since start().
+     */
+    PerfSample stop()
+    {
+        PerfSample sample;
+
+#if defined(__linux__)
+        if (!available())
+        {
+	        return sample;
+        }
+
+        ioctl(_fds[PerfSample::CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // layout: number of events, time enabled, time running, values
+        I64u buffer[3 + PerfSample::EVENTS];
+        ssize_t size = read(_fds[PerfSample::CYCLES], buffer, sizeof(buffer));
+
+        if (size < static_cast<ssize_t>(3 * sizeof(I64u)) || buffer[0] != _size)
+        {
+	        return sample;
+        }
+
+        sample.timeEnabled = buffer[1];
+        sample.timeRunning = buffer[2];
+
+        for (size_t i = 0; i < _size; i++)
+        {
+	        I64u value = buffer[3 + i];
+
+	        if (sample.timeRunning > 0 && sample.timeRunning < sample.timeEnabled)
+	        {
+		        value = static_cast<I64u>(static_cast<Decimal>(value) * sample.timeEnabled / sample.timeRunning);
+	        }
+
+	        sample.values[_position[i]] = value;
+	        sample.events |= 1u << _position[i];
+        }
+#endif
+
+        return sample;
+    }
+
+private:
+
+    PerfCounters(const PerfCounters&);
+
+    PerfCounters& operator=(const PerfCounters&);
+
+    /**
+     * The file descriptors of the opened counters (-1 if not opened).
+     */
+    int _fds[PerfSample::EVENTS];
+
+    /**
+     * The events in the order in which they are read from the group.
+     */
+    size_t _position[PerfSample::EVENTS];
+
+    /**
+     * The number of opened counters.
+     */
+    size_t _size;
+
+    string _error;
+};
+
+/**
+ * The hardware performance counters of all stage tasks run by the current
+ * process, written as a JSON run report after the generation process.
+ *
+ * The report lists the counters of each task run (i.e. of each generator
+ * thread and stage) together with the collected records and bytes and the
+ * wall and CPU times of the task, followed by the totals per stage and per
+ * generator. Derived values (instructions per cycle and cycles, cache misses
+ * and branch misses per record) are included for convenience.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class PerfReport
+{
+public:
+
+    /**
+     * Returns the report shared by all stage tasks.
+     */
+    static PerfReport& defaultReport()
+    {
+        static PerfReport report;
+        return report;
+    }
+
+    /**
+     * Adds a task run of the given \p task in the given \p stage on the thread
+     * with the given \p thread ID.
+     */
+    void add(const string& stage, const string& task, long thread, const PerfSample& sample, I64u records, I64u bytes, I64u wallNanos, I64u cpuNanos)
+    {
+        Entry entry;
+        entry.stage = stage;
+        entry.task = task;
+        entry.thread = thread;
+        entry.sample = sample;
+        entry.records = records;
+        entry.bytes = bytes;
+        entry.wallNanos = wallNanos;
+        entry.cpuNanos = cpuNanos;
+
+        FastMutex::ScopedLock lock(_mutex);
+        _entries.push_back(entry);
+    }
+
+    /**
+     * Records that the counters are not available on the host because of the
+     * given \p error. Only the first recorded error is kept.
+     */
+    void unavailable(const string& error)
+    {
+        FastMutex::ScopedLock lock(_mutex);
+
+        if (_error.empty())
+        {
+            _error = error;
+        }
+    }
+
+    /**
+     * Returns the first recorded error, or an empty string if the counters
+     * were available for all task runs.
+     */
+    string error()
+    {
+        FastMutex::ScopedLock lock(_mutex);
+        return _error;
+    }
+
+    /**
+     * Writes the report for the given \p jobID and \p nodeID as JSON to
+     * \p out.
+     */
+    void write(ostream& out, const string& jobID, const string& nodeID)
+    {
+        FastMutex::ScopedLock lock(_mutex);
+
+        vector<Entry> stages;
+        vector<Entry> generators;
+
+        for (vector<Entry>::const_iterator it = _entries.begin(); it != _entries.end(); ++it)
+        {
+            total(stages, it->stage, "", *it);
+            total(generators, "", it->task.substr(0, it->task.find("::")), *it);
+        }
+
+        out << "{\n";
+        out << "  \"context\": {\n";
+        out << "    \"date\": " << jsonString(DateTimeFormatter::format(Timestamp(), DateTimeFormat::ISO8601_FORMAT)) << ",\n";
+        out << "    \"host_name\": " << jsonString(Environment::nodeName()) << ",\n";
+        out << "    \"num_cpus\": " << Environment::processorCount() << ",\n";
+        out << "    \"application\": " << jsonString(Constant::APP_NAME) << ",\n";
+        out << "    \"version\": " << jsonString(Constant::APP_VERSION) << ",\n";
+        out << "    \"job_id\": " << jsonString(jobID) << ",\n";
+        out << "    \"node_id\": " << jsonString(nodeID) << ",\n";
+        out << "    \"error\": " << (_error.empty() ? "null" : jsonString(_error)) << "\n";
+        out << "  },\n";
+        out << "  \"tasks\": [";
+        write(out, _entries, "task");
+        out << "],\n";
+        out << "  \"stages\": [";
+        write(out, stages, "");
+        out << "],\n";
+        out << "  \"generators\": [";
+        write(out, generators, "generator");
+        out << "]\n";
+        out << "}\n";
+    }
+
+private:
+
+    struct Entry
+    {
+        Entry() :
+            thread(-1),
+            records(0),
+            bytes(0),
+            wallNanos(0),
+            cpuNanos(0)
+        {
+        }
+
+        string stage;
+        string task;
+        long thread;
+        PerfSample sample;
+        I64u records;
+        I64u bytes;
+        I64u wallNanos;
+        I64u cpuNanos;
+    };
+
+    /**
+     * Adds the \p entry to the total with the given \p stage and \p task name
+     * in \p totals. Tasks of the same stage run concurrently, so the wall time
+     * of a total is the longest wall time of its entries.
+     */
+    static void total(vector<Entry>& totals, const string& stage, const string& task, const Entry& entry)
+    {
+        vector<Entry>::iterator it = totals.begin();
+        while (it != totals.end() && (it->stage != stage || it->task != task))
+        {
+            ++it;
+        }
+
+        if (it == totals.end())
+        {
+            totals.push_back(Entry());
+            it = totals.end() - 1;
+            it->stage = stage;
+            it->task = task;
+        }
+
+        it->sample.add(entry.sample);
+        it->records += entry.records;
+        it->bytes += entry.bytes;
+        it->wallNanos = std::max(it->wallNanos, entry.wallNanos);
+        it->cpuNanos += entry.cpuNanos;
+    }
+
+    /**
+     * Writes the \p entries as a JSON array body. The task name of each
+     * entry is written under the given \p taskKey.
+     */
+    static void write(ostream& out, const vector<Entry>& entries, const string& taskKey)
+    {
+        for (vector<Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            const PerfSample& sample = it->sample;
+
+            out << (it == entries.begin() ? "\n" : ",\n");
+            out << "    {";
+            if (!it->stage.empty())
+            {
+                out << "\"stage\": " << jsonString(it->stage) << ", ";
+            }
+            if (!it->task.empty())
+            {
+                out << jsonString(taskKey) << ": " << jsonString(it->task) << ", ";
+            }
+            if (it->thread >= 0)
+            {
+                out << "\"thread\": " << it->thread << ", ";
+            }
+            out << "\"records\": " << it->records << ", ";
+            out << "\"bytes\": " << it->bytes << ", ";
+            out << "\"wall_time_ns\": " << it->wallNanos << ", ";
+            out << "\"cpu_time_ns\": " << it->cpuNanos;
+
+            for (size_t i = 0; i < PerfSample::EVENTS; i++)
+            {
+                out << ", \"" << PerfSample::name(i) << "\": ";
+                if (sample.has(i))
+                {
+                    out << sample.values[i];
+                }
+                else
+                {
+                    out << "null";
+                }
+            }
+
+            out << ", \"ipc\": " << ratio(sample, PerfSample::INSTRUCTIONS, sample.values[PerfSample::CYCLES]);
+            out << ", \"cycles_per_record\": " << ratio(sample, PerfSample::CYCLES, it->records);
+            out << ", \"cache_misses_per_record\": " << ratio(sample, PerfSample::CACHE_MISSES, it->records);
+            out << ", \"branch_misses_per_record\": " << ratio(sample, PerfSample::BRANCH_MISSES, it->records);
+            out << ", \"running_fraction\": " << (sample.timeEnabled > 0 ? jsonNumber(sample.timeRunning / static_cast<Decimal>(sample.timeEnabled)) : string("null"));
+            out << "}";
+        }
+
+        if (!entries.empty())
+        {
+            out << "\n  ";
+        }
+    }
+
+    static string ratio(const PerfSample& sample, size_t event, I64u denominator)
+    {
+        if (!sample.has(event) || !sample.has(PerfSample::CYCLES) || denominator == 0)
+        {
+            return "null";
+        }
+
+        return jsonNumber(sample.values[event] / static_cast<Decimal>(denominator));
+    }
+
+    FastMutex _mutex;
+
+    vector<Entry> _entries;
+
+    string _error;
+};
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* PERFCOUNTERS_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <Poco/Types.h>
+
+#include <time.h>
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * Returns the value of the monotonic system clock in nanoseconds. Used to
+ * measure short intervals (e.g. the duration of output writes), for which
+ * the microsecond resolution of Poco::Timestamp is too coarse.
+ */
+inline Poco::UInt64 monotonicNanos()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<Poco::UInt64>(now.tv_sec) * 1000000000 + static_cast<Poco::UInt64>(now.tv_nsec);
+}
+
+/**
+ * Returns the CPU time consumed by the calling thread in nanoseconds.
+ */
+inline Poco::UInt64 threadCpuNanos()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<Poco::UInt64>(now.tv_sec) * 1000000000 + static_cast<Poco::UInt64>(now.tv_nsec);
+}
+
+/**
+ * Returns the value of the processor's time stamp counter, or the monotonic
+ * clock in nanoseconds on platforms without one. Used for sampling code paths
+ * that are too short to be timed with a system call.
+ */
+inline Poco::UInt64 cycleCount()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int low, high;
+    __asm__ __volatile__ ("rdtsc" : "=a" (low), "=d" (high));
+    return static_cast<Poco::UInt64>(high) << 32 | low;
+#else
+    return monotonicNanos();
+#endif
+}
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* CLOCK_H_ */
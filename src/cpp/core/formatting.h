@@ -0,0 +1,433 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef FORMATTING_H_
+#define FORMATTING_H_
+
+#include <Poco/Types.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * Lookup tables shared by the formatting kernels.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct FormatTables
+{
+    static const char DIGIT_PAIRS[201]; //!< The two-digit decimal representations of 0 to 99.
+    static const double POWERS_OF_TEN[16]; //!< The exact powers of ten 10^0 to 10^15.
+    static const Poco::UInt64 INTEGER_POWERS_OF_TEN[20]; //!< The integer powers of ten 10^0 to 10^19.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @name Formatting Kernels
+////////////////////////////////////////////////////////////////////////////////
+//@{
+
+/**
+ * The maximum number of characters written by appendUnsigned() and
+ * appendSigned().
+ */
+const std::size_t MAX_INTEGER_LENGTH = 20;
+
+/**
+ * The maximum number of characters written by appendDecimal().
+ */
+const std::size_t MAX_DECIMAL_LENGTH = 32;
+
+/**
+ * Writes the decimal representation of \p v at \p out.
+ *
+ * @return A pointer past the last written character.
+ */
+inline char* appendUnsigned(char* out, Poco::UInt64 v)
+{
+    std::size_t length = 1;
+    while (length < 20 && v >= FormatTables::INTEGER_POWERS_OF_TEN[length])
+    {
+        length++;
+    }
+
+    char* end = out + length;
+    char* p = end;
+
+    while (v >= 100)
+    {
+        const char* pair = FormatTables::DIGIT_PAIRS + 2 * (v % 100);
+        v /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+
+    if (v >= 10)
+    {
+        const char* pair = FormatTables::DIGIT_PAIRS + 2 * v;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    else
+    {
+        *--p = static_cast<char>('0' + v);
+    }
+
+    return end;
+}
+
+/**
+ * Writes the decimal representation of \p v at \p out.
+ *
+ * @return A pointer past the last written character.
+ */
+inline char* appendSigned(char* out, Poco::Int64 v)
+{
+    if (v < 0)
+    {
+        *out++ = '-';
+        // negate in the unsigned domain to support the minimal value
+        return appendUnsigned(out, ~static_cast<Poco::UInt64>(v) + 1);
+    }
+
+    return appendUnsigned(out, static_cast<Poco::UInt64>(v));
+}
+
+/**
+ * Writes the shortest decimal representation of \p v that parses back to
+ * \p v at \p out.
+ *
+ * Values of at least 1e-4 with at most 15 fraction digits whose scaled
+ * magnitude fits into the 53-bit mantissa are written in fixed notation using
+ * integer arithmetic. All other values are written with the shortest of the
+ * 15, 16 or 17 significant digit <tt>%g</tt> representations that
+ * round-trips, which uses exponent notation for smaller values (e.g.
+ * <tt>1e-07</tt> instead of <tt>0.0000001</tt>). The output is never longer
+ * than the shortest round-trip representation used by Python's repr().
+ *
+ * @return A pointer past the last written character.
+ */
+inline char* appendDecimal(char* out, double v)
+{
+    if (v != v)
+    {
+        std::memcpy(out, "nan", 3);
+        return out + 3;
+    }
+
+    if (v < 0 || (v == 0 && 1.0 / v < 0))
+    {
+        *out++ = '-';
+        v = -v;
+    }
+
+    if (v == 0)
+    {
+        *out = '0';
+        return out + 1;
+    }
+
+    if (v >= 1e-4 && v <= 9007199254740992.0) // 2^53
+    {
+        for (std::size_t k = 0; k < 16; k++)
+        {
+            const double scaled = std::floor(v * FormatTables::POWERS_OF_TEN[k] + 0.5);
+
+            if (scaled > 9007199254740992.0)
+            {
+                break;
+            }
+
+            // the division of two exact values is correctly rounded, so an
+            // exact match means that the decimal string parses back to v
+            if (scaled / FormatTables::POWERS_OF_TEN[k] == v)
+            {
+                Poco::UInt64 digits = static_cast<Poco::UInt64>(scaled);
+
+                // drop trailing zeros of the fraction part
+                while (k > 0 && digits % 10 == 0)
+                {
+                    digits /= 10;
+                    k--;
+                }
+
+                const Poco::UInt64 divisor = FormatTables::INTEGER_POWERS_OF_TEN[k];
+
+                out = appendUnsigned(out, digits / divisor);
+
+                if (k > 0)
+                {
+                    *out++ = '.';
+
+                    // write the zero padded fraction part
+                    char* end = out + k;
+                    Poco::UInt64 fraction = digits % divisor;
+                    for (char* p = end; p != out; fraction /= 10)
+                    {
+                        *--p = static_cast<char>('0' + fraction % 10);
+                    }
+                    out = end;
+                }
+
+                return out;
+            }
+        }
+    }
+    else if (v > 9007199254740992.0 && v < 1e16)
+    {
+        // all values in this range are integers with exactly 16 digits
+        return appendUnsigned(out, static_cast<Poco::UInt64>(v));
+    }
+
+    char buffer[MAX_DECIMAL_LENGTH];
+    int length = 0;
+
+    // 15 digits are enough to represent all shorter decimals of normal
+    // values exactly, subnormal values may need fewer digits
+    for (int precision = v < DBL_MIN ? 1 : 15; precision <= 17; precision++)
+    {
+        length = std::sprintf(buffer, "%.*g", precision, v);
+
+        if (std::strtod(buffer, NULL) == v)
+        {
+            break;
+        }
+    }
+
+    std::memcpy(out, buffer, static_cast<std::size_t>(length));
+    return out + length;
+}
+
+/**
+ * Copies the \p length bytes starting at \p s to \p out.
+ *
+ * @return A pointer past the last written character.
+ */
+inline char* appendBytes(char* out, const char* s, std::size_t length)
+{
+    std::memcpy(out, s, length);
+    return out + length;
+}
+
+/**
+ * Copies the \p length bytes starting at \p s to \p out doubling all
+ * embedded \p quote characters. The input is copied in runs between quote
+ * characters, so strings without quotes are copied with a single memcpy().
+ * At most <tt>2 * length</tt> characters are written.
+ *
+ * @return A pointer past the last written character.
+ */
+inline char* appendEscaped(char* out, const char* s, std::size_t length, char quote = '"')
+{
+    const char* end = s + length;
+
+    while (s != end)
+    {
+        const char* q = static_cast<const char*>(std::memchr(s, quote, static_cast<std::size_t>(end - s)));
+
+        if (q == NULL)
+        {
+            return appendBytes(out, s, static_cast<std::size_t>(end - s));
+        }
+
+        out = appendBytes(out, s, static_cast<std::size_t>(q - s + 1));
+        *out++ = quote;
+        s = q + 1;
+    }
+
+    return out;
+}
+
+//@}
+
+/**
+ * A growable byte buffer for allocation-free record serialization.
+ *
+ * Formatting kernels write directly into the buffer memory obtained with
+ * reserve() and publish the written bytes with commit(). The buffer can be
+ * backed by caller-provided storage (e.g. a stack array) and only switches
+ * to heap memory if that storage is exhausted. Once grown, the heap memory is
+ * kept until the buffer is destroyed, so a reused buffer does not allocate
+ * in the steady state.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ByteBuffer
+{
+public:
+
+    /**
+     * Creates a heap backed buffer with the given initial \p capacity.
+     */
+    explicit ByteBuffer(std::size_t capacity = 4096) :
+        _data(new char[capacity > 0 ? capacity : 1]),
+        _size(0),
+        _capacity(capacity > 0 ? capacity : 1),
+        _owned(true)
+    {
+    }
+
+    /**
+     * Creates a buffer backed by the external \p storage of the given
+     * \p capacity.
+     */
+    ByteBuffer(char* storage, std::size_t capacity) :
+        _data(storage),
+        _size(0),
+        _capacity(capacity),
+        _owned(false)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ByteBuffer()
+    {
+        if (_owned)
+        {
+            delete[] _data;
+        }
+    }
+
+    /**
+     * Ensures that at least \p length bytes can be written after the current
+     * end of the buffer.
+     *
+     * @return A pointer to the current end of the buffer.
+     */
+    char* reserve(std::size_t length)
+    {
+        if (_capacity - _size < length)
+        {
+            grow(_size + length);
+        }
+
+        return _data + _size;
+    }
+
+    /**
+     * Marks all bytes up to (excluding) \p end as written. The \p end pointer
+     * must be within the range obtained with the last reserve() call.
+     */
+    void commit(char* end)
+    {
+        _size = static_cast<std::size_t>(end - _data);
+    }
+
+    /**
+     * Appends \p length bytes starting at \p s.
+     */
+    void append(const char* s, std::size_t length)
+    {
+        commit(appendBytes(reserve(length), s, length));
+    }
+
+    /**
+     * Appends a single character \p c.
+     */
+    void append(char c)
+    {
+        *reserve(1) = c;
+        _size++;
+    }
+
+    /**
+     * Returns a pointer to the first byte in the buffer.
+     */
+    const char* data() const
+    {
+        return _data;
+    }
+
+    /**
+     * Returns the number of bytes in the buffer.
+     */
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Returns true if the buffer is empty.
+     */
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    /**
+     * Discards the buffer contents but keeps the allocated memory.
+     */
+    void clear()
+    {
+        _size = 0;
+    }
+
+private:
+
+    /**
+     * Noncopyable.
+     */
+    ByteBuffer(const ByteBuffer&);
+
+    /**
+     * Noncopyable.
+     */
+    ByteBuffer& operator=(const ByteBuffer&);
+
+    void grow(std::size_t required)
+    {
+        std::size_t capacity = 2 * _capacity;
+        if (capacity < required)
+        {
+            capacity = required;
+        }
+
+        char* data = new char[capacity];
+        std::memcpy(data, _data, _size);
+
+        if (_owned)
+        {
+            delete[] _data;
+        }
+
+        _data = data;
+        _capacity = capacity;
+        _owned = true;
+    }
+
+    char* _data;
+
+    std::size_t _size;
+
+    std::size_t _capacity;
+
+    bool _owned;
+};
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* FORMATTING_H_ */
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef JSON_H_
+#define JSON_H_
+
+#include "core/types.h"
+
+#include <Poco/Format.h>
+
+#include <cstdio>
+#include <string>
+
+namespace Myriad {
+/**
+ * @addtogroup core
+ * @{*/
+
+/**
+ * Returns the given \p value as a quoted and escaped JSON string literal.
+ * Used by the JSON reports written by the benchmark suite and the
+ * performance counters.
+ */
+inline std::string jsonString(const std::string& value)
+{
+    std::string result("\"");
+    for (std::string::const_iterator it = value.begin(); it != value.end(); ++it)
+    {
+        switch (*it)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(*it) < 0x20)
+            {
+                result += Poco::format("\\u%04x", static_cast<int>(*it));
+            }
+            else
+            {
+                result += *it;
+            }
+        }
+    }
+    result += "\"";
+    return result;
+}
+
+/**
+ * Returns the given \p value as a JSON number with six significant digits,
+ * or <tt>null</tt> if the value is not finite.
+ */
+inline std::string jsonNumber(Decimal value)
+{
+    // NaN and infinities are not valid JSON numbers
+    if (value - value != 0)
+    {
+        return "null";
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+/** @}*/// add to core group
+} // namespace Myriad
+
+#endif /* JSON_H_ */
@@ -18,6 +18,7 @@
 #ifndef TYPES_H_
 #define TYPES_H_
 
+#include "core/formatting.h"
 #include "core/types/MyriadDate.h"
 #include "core/types/MyriadEnumSet.h"
 
@@ -255,7 +256,7 @@ public:
      */
     static Date min()
     {
-        return Date(DateTime(1, 1, 1));
+        return Date(1, 1, 1);
     }
 
     /**
@@ -263,7 +264,7 @@ public:
      */
     static Date max()
     {
-        return Date(DateTime(9999, 12, 31));
+        return Date(9999, 12, 31);
     }
 };
 
@@ -335,6 +336,124 @@ static inline std::string& trim(std::string& s)
 ////////////////////////////////////////////////////////////////////////////////
 //@{
 
+/**
+ * A traits template that formats non-null \p T values either to a
+ * <tt>std::ostream</tt> or to a ByteBuffer.
+ *
+ * The default implementation relies on the \p T stream operator. Integer,
+ * decimal, character and date values are handled by specializations based on
+ * the allocation-free kernels from core/formatting.h.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class T, bool isInteger = std::numeric_limits<T>::is_integer, bool isSigned = std::numeric_limits<T>::is_signed>
+struct ValueFormatter
+{
+    static void write(std::ostream& stream, const T& t)
+    {
+        stream << t;
+    }
+
+    static void append(ByteBuffer& buffer, const T& t)
+    {
+        std::string s(toString(t));
+        buffer.append(s.data(), s.size());
+    }
+};
+
+/**
+ * A common base for ValueFormatter specializations that provide a
+ * <tt>format(char*, const T&)</tt> kernel writing at most \p MAX_LENGTH
+ * characters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<class T, class Formatter>
+struct DirectValueFormatter
+{
+    static void write(std::ostream& stream, const T& t)
+    {
+        char buffer[Formatter::MAX_LENGTH];
+        stream.write(buffer, Formatter::format(buffer, t) - buffer);
+    }
+
+    static void append(ByteBuffer& buffer, const T& t)
+    {
+        buffer.commit(Formatter::format(buffer.reserve(Formatter::MAX_LENGTH), t));
+    }
+};
+
+/**
+ * ValueFormatter specialization for signed integer types.
+ */
+template<class T>
+struct ValueFormatter<T, true, true> : public DirectValueFormatter<T, ValueFormatter<T, true, true> >
+{
+    enum { MAX_LENGTH = MAX_INTEGER_LENGTH };
+
+    static char* format(char* out, const T& t)
+    {
+        return appendSigned(out, static_cast<Poco::Int64>(t));
+    }
+};
+
+/**
+ * ValueFormatter specialization for unsigned integer types (including Bool).
+ */
+template<class T>
+struct ValueFormatter<T, true, false> : public DirectValueFormatter<T, ValueFormatter<T, true, false> >
+{
+    enum { MAX_LENGTH = MAX_INTEGER_LENGTH };
+
+    static char* format(char* out, const T& t)
+    {
+        return appendUnsigned(out, static_cast<Poco::UInt64>(t));
+    }
+};
+
+/**
+ * ValueFormatter specialization for the Char type.
+ */
+template<>
+struct ValueFormatter<Char, true, std::numeric_limits<Char>::is_signed> : public DirectValueFormatter<Char, ValueFormatter<Char, true, std::numeric_limits<Char>::is_signed> >
+{
+    enum { MAX_LENGTH = 1 };
+
+    static char* format(char* out, const Char& t)
+    {
+        *out = t;
+        return out + 1;
+    }
+};
+
+/**
+ * ValueFormatter specialization for the Decimal type.
+ */
+template<>
+struct ValueFormatter<Decimal, false, true> : public DirectValueFormatter<Decimal, ValueFormatter<Decimal, false, true> >
+{
+    enum { MAX_LENGTH = MAX_DECIMAL_LENGTH };
+
+    static char* format(char* out, const Decimal& t)
+    {
+        return appendDecimal(out, t);
+    }
+};
+
+/**
+ * ValueFormatter specialization for the Date type.
+ */
+template<>
+struct ValueFormatter<Date, false, false> : public DirectValueFormatter<Date, ValueFormatter<Date, false, false> >
+{
+    enum { MAX_LENGTH = MyriadDate::FORMATTED_LENGTH };
+
+    static char* format(char* out, const Date& t)
+    {
+        return t.format(out);
+    }
+};
+
 /**
  * Write out to the given \c std::ostream either the value of \p t or, if \p t
  * is \c NULL, the string literal 'NULL'. The \p quoted parameter is ignored.
@@ -343,7 +462,7 @@ template<class T> inline void write(std::ostream& stream, const T& t, bool quote
 {
     if (t != nullValue<T>())
     {
-        stream << t;
+        ValueFormatter<T>::write(stream, t);
     }
     else
     {
@@ -361,11 +480,13 @@ template<> inline void write<String>(std::ostream& stream, const String& t, bool
     {
         if (quoted)
         {
-            stream << '"' << t << '"';
+            stream.put('"');
+            stream.write(t.data(), static_cast<std::streamsize>(t.size()));
+            stream.put('"');
         }
         else
         {
-            stream << t;
+            stream.write(t.data(), static_cast<std::streamsize>(t.size()));
         }
     }
     else
@@ -375,24 +496,121 @@ template<> inline void write<String>(std::ostream& stream, const String& t, bool
 }
 
 /**
- * Write out to the given \c std::ostream either the value vector \p t.
- * The \p quoted parameter is passed to the write() call of each vector element.
+ * Write out to the given \c std::ostream the pre-rendered bytes \p t of an
+ * enum value (see MyriadEnumSet::bytes()).
  */
-template<class T> inline void write(std::ostream& stream, const vector<T>& t, bool quoted = true)
+inline void write(std::ostream& stream, const MyriadEnumSet::Bytes& t)
+{
+    stream.write(t.data, static_cast<std::streamsize>(t.size));
+}
+
+/**
+ * Append to the given ByteBuffer either the value of \p t or nothing, if \p t
+ * is \c NULL. The \p quoted parameter is ignored.
+ */
+template<class T> inline void write(ByteBuffer& buffer, const T& t, bool quoted = true)
+{
+    if (t != nullValue<T>())
+    {
+        ValueFormatter<T>::append(buffer, t);
+    }
+}
+
+/**
+ * A specialization of the ByteBuffer \p write function that also respects
+ * the \p quoted parameter.
+ */
+template<> inline void write<String>(ByteBuffer& buffer, const String& t, bool quoted)
 {
-    stream << "[";
+    if (t != nullValue<String>())
+    {
+        char* out = buffer.reserve(t.size() + 2);
+
+        if (quoted)
+        {
+            *out++ = '"';
+            out = appendBytes(out, t.data(), t.size());
+            *out++ = '"';
+        }
+        else
+        {
+            out = appendBytes(out, t.data(), t.size());
+        }
+
+        buffer.commit(out);
+    }
+}
+
+/**
+ * Append to the given ByteBuffer the pre-rendered bytes \p t of an enum value
+ * (see MyriadEnumSet::bytes()).
+ */
+inline void write(ByteBuffer& buffer, const MyriadEnumSet::Bytes& t)
+{
+    buffer.append(t.data, t.size);
+}
+
+/**
+ * Append to the given ByteBuffer the value vector \p t. The \p quoted
+ * parameter is passed to the write() call of each vector element.
+ */
+template<class T> inline void write(ByteBuffer& buffer, const vector<T>& t, bool quoted = true)
+{
+    buffer.append('[');
     typename vector<T>::const_iterator it = t.begin();
     while (it != t.end())
     {
-        write(stream, (*it), quoted);
+        write(buffer, (*it), quoted);
         it++;
 
         if  (it != t.end())
         {
-            stream << ", ";
+            buffer.append(", ", 2);
         }
     }
-    stream << "]";
+    buffer.append(']');
+}
+
+/**
+ * Append to the given ByteBuffer the character vector \p t as a character
+ * sequence. If \p quoted parameter is <tt>True</tt>, adds enclosing quotes to
+ * the character sequence.
+ */
+template<> inline void write(ByteBuffer& buffer, const vector<Char>& t, bool quoted)
+{
+    char* out = buffer.reserve(t.size() + 2);
+
+    if (quoted)
+    {
+        *out++ = '"';
+    }
+
+    if (!t.empty())
+    {
+        out = appendBytes(out, &t[0], t.size());
+    }
+
+    if (quoted)
+    {
+        *out++ = '"';
+    }
+
+    buffer.commit(out);
+}
+
+/**
+ * Write out to the given \c std::ostream either the value vector \p t.
+ * The \p quoted parameter is passed to the write() call of each vector element.
+ *
+ * The vector is formatted into a stack backed ByteBuffer and written with a
+ * single call.
+ */
+template<class T> inline void write(std::ostream& stream, const vector<T>& t, bool quoted = true)
+{
+    char storage[256];
+    ByteBuffer buffer(storage, sizeof(storage));
+    write(buffer, t, quoted);
+    stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
 }
 
 /**
@@ -404,20 +622,166 @@ template<> inline void write(std::ostream& stream, const vector<Char>& t, bool q
 {
     if (quoted)
     {
-        stream << '"';
+        stream.put('"');
     }
 
-    vector<Char>::const_iterator it = t.begin();
+    if (!t.empty())
+    {
+        stream.write(&t[0], static_cast<std::streamsize>(t.size()));
+    }
+
+    if (quoted)
+    {
+        stream.put('"');
+    }
+}
+
+/**
+ * Write at the raw buffer position \p out either the value of \p t or nothing,
+ * if \p t is \c NULL. The \p quoted parameter is ignored. The caller must
+ * ensure that at least <tt>ValueFormatter<T>::MAX_LENGTH</tt> bytes are
+ * available at \p out.
+ *
+ * @return A pointer past the last written character.
+ */
+template<class T> inline char* write(char* out, const T& t, bool quoted = true)
+{
+    if (t != nullValue<T>())
+    {
+        return ValueFormatter<T>::format(out, t);
+    }
+
+    return out;
+}
+
+/**
+ * A specialization of the raw buffer \p write function that also respects
+ * the \p quoted parameter.
+ */
+template<> inline char* write<String>(char* out, const String& t, bool quoted)
+{
+    if (t != nullValue<String>())
+    {
+        if (quoted)
+        {
+            *out++ = '"';
+            out = appendBytes(out, t.data(), t.size());
+            *out++ = '"';
+        }
+        else
+        {
+            out = appendBytes(out, t.data(), t.size());
+        }
+    }
+
+    return out;
+}
+
+/**
+ * Write at the raw buffer position \p out the pre-rendered bytes \p t of an
+ * enum value (see MyriadEnumSet::bytes()).
+ */
+inline char* write(char* out, const MyriadEnumSet::Bytes& t)
+{
+    return appendBytes(out, t.data, t.size);
+}
+
+/**
+ * Write at the raw buffer position \p out the value vector \p t. The
+ * \p quoted parameter is passed to the write() call of each vector element.
+ */
+template<class T> inline char* write(char* out, const vector<T>& t, bool quoted = true)
+{
+    *out++ = '[';
+    typename vector<T>::const_iterator it = t.begin();
     while (it != t.end())
     {
-        stream << (*it);
+        out = write(out, (*it), quoted);
         it++;
+
+        if  (it != t.end())
+        {
+            out = appendBytes(out, ", ", 2);
+        }
     }
+    *out++ = ']';
 
+    return out;
+}
+
+/**
+ * Write at the raw buffer position \p out the character vector \p t as a
+ * character sequence. If \p quoted parameter is <tt>True</tt>, adds enclosing
+ * quotes to the character sequence.
+ */
+template<> inline char* write(char* out, const vector<Char>& t, bool quoted)
+{
     if (quoted)
     {
-        stream << '"';
+        *out++ = '"';
+    }
+
+    if (!t.empty())
+    {
+        out = appendBytes(out, &t[0], t.size());
+    }
+
+    if (quoted)
+    {
+        *out++ = '"';
+    }
+
+    return out;
+}
+
+/**
+ * Returns an upper bound for the number of characters written by the raw
+ * buffer write() function for the String value \p t.
+ */
+inline size_t maxFormattedLength(const String& t)
+{
+    return t.size() + 2;
+}
+
+/**
+ * Returns the number of characters written by the raw buffer write() function
+ * for the pre-rendered enum value \p t.
+ */
+inline size_t maxFormattedLength(const MyriadEnumSet::Bytes& t)
+{
+    return t.size;
+}
+
+/**
+ * Returns an upper bound for the number of characters written by the raw
+ * buffer write() function for the value vector \p t.
+ */
+template<class T> inline size_t maxFormattedLength(const vector<T>& t)
+{
+    return 2 + t.size() * (ValueFormatter<T>::MAX_LENGTH + 2);
+}
+
+/**
+ * Returns an upper bound for the number of characters written by the raw
+ * buffer write() function for the character vector \p t.
+ */
+template<> inline size_t maxFormattedLength(const vector<Char>& t)
+{
+    return t.size() + 2;
+}
+
+/**
+ * Returns an upper bound for the number of characters written by the raw
+ * buffer write() function for the String vector \p t.
+ */
+template<> inline size_t maxFormattedLength(const vector<String>& t)
+{
+    size_t length = 2;
+    for (vector<String>::const_iterator it = t.begin(); it != t.end(); ++it)
+    {
+        length += maxFormattedLength(*it) + 2;
     }
+    return length;
 }
 
 //@}
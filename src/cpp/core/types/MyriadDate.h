@@ -18,12 +18,15 @@
 #ifndef MYRIADDATE_H_
 #define MYRIADDATE_H_
 
+#include "core/formatting.h"
+
 #include <Poco/DateTime.h>
-#include <Poco/DateTimeFormat.h>
-#include <Poco/DateTimeFormatter.h>
 #include <Poco/DateTimeParser.h>
+#include <Poco/Exception.h>
+#include <Poco/Types.h>
 
 #include <iostream>
+#include <string>
 
 using namespace Poco;
 using namespace std;
@@ -37,8 +40,13 @@ namespace Myriad {
  * A lightweight implementation of a Date type.
  *
  * The class implements all value semantics in order to be used as a
- * first-class Myriad data type. The implementation is basically a wrapper
- * around the Poco::DateTime class.
+ * first-class Myriad data type. A date is represented by a single 32-bit day
+ * number in the proleptic Gregorian calendar, where 0001-01-01 is day 1 (the
+ * same ordinal that is used by the Date encoding of BinarySpecification
+ * files). Comparisons and day arithmetic are therefore plain integer
+ * operations, and the YYYY-MM-DD conversions are implemented with civil
+ * calendar arithmetic and a two-digit lookup table instead of going through
+ * Poco::DateTime.
  *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
@@ -47,9 +55,23 @@ class MyriadDate
 public:
 
     /**
-     * Default constructor.
+     * The length of the YYYY-MM-DD representation produced by format().
+     */
+    static const size_t FORMATTED_LENGTH = 10;
+
+    /**
+     * Default constructor. Creates the date 0001-01-01.
      */
-    MyriadDate()
+    MyriadDate() :
+        _dayNumber(1)
+    {
+    }
+
+    /**
+     * Construct a MyriadDate from the given \p year, \p month and \p day.
+     */
+    MyriadDate(int year, int month, int day) :
+        _dayNumber(toDayNumber(year, month, day))
     {
     }
 
@@ -58,9 +80,9 @@ public:
      *
      * @param dateTime A DateTime object to supply the year, month and the day.
      */
-    MyriadDate(const DateTime& dateTime)
+    MyriadDate(const DateTime& dateTime) :
+        _dayNumber(toDayNumber(dateTime.year(), dateTime.month(), dateTime.day()))
     {
-        _dateTime.assign(dateTime.year(), dateTime.month(), dateTime.day());
     }
 
     /**
@@ -68,13 +90,9 @@ public:
      *
      * @param date A date formatted as a a string that can be parsed.
      */
-    MyriadDate(const string& date)
+    MyriadDate(const string& date) :
+        _dayNumber(parse(date.data(), date.size()))
     {
-        string s(date);
-        int tzd;
-
-        DateTimeParser::parse(s.substr(0,10), _dateTime, tzd);
-        resetTime();
     }
 
     /**
@@ -82,13 +100,74 @@ public:
      *
      * @param date A date formatted as a a string that can be parsed.
      */
-    MyriadDate(const char* date)
+    MyriadDate(const char* date) :
+        _dayNumber(parse(date, char_traits<char>::length(date)))
     {
-        string s(date);
-        int tzd;
+    }
+
+    /**
+     * Creates a MyriadDate from a day number (0001-01-01 is day 1).
+     */
+    static MyriadDate fromDayNumber(Int32 dayNumber)
+    {
+        MyriadDate date;
+        date._dayNumber = dayNumber;
+        return date;
+    }
+
+    /**
+     * Returns the day number of this date (0001-01-01 is day 1).
+     */
+    Int32 dayNumber() const
+    {
+        return _dayNumber;
+    }
+
+    /**
+     * Converts this date into a Poco::DateTime at midnight.
+     */
+    DateTime dateTime() const
+    {
+        int y, m, d;
+        toCivil(_dayNumber, y, m, d);
+        return DateTime(y, m, d);
+    }
 
-        DateTimeParser::parse(s.substr(0,10), _dateTime, tzd);
-        resetTime();
+    /**
+     * Writes this date formatted as YYYY-MM-DD into the given \p buffer
+     * which must have room for at least FORMATTED_LENGTH characters. No
+     * terminating null character is written.
+     *
+     * @throw RangeException if the year is outside of [0, 9999]
+     * @return A pointer past the last written character.
+     */
+    char* format(char* buffer) const
+    {
+        int y, m, d;
+        toCivil(_dayNumber, y, m, d);
+
+        if (y < 0 || y > 9999)
+        {
+            throw RangeException("Date is outside of the YYYY-MM-DD range");
+        }
+
+        const char* hi = FormatTables::DIGIT_PAIRS + 2 * (y / 100);
+        const char* lo = FormatTables::DIGIT_PAIRS + 2 * (y % 100);
+        const char* mm = FormatTables::DIGIT_PAIRS + 2 * m;
+        const char* dd = FormatTables::DIGIT_PAIRS + 2 * d;
+
+        buffer[0] = hi[0];
+        buffer[1] = hi[1];
+        buffer[2] = lo[0];
+        buffer[3] = lo[1];
+        buffer[4] = '-';
+        buffer[5] = mm[0];
+        buffer[6] = mm[1];
+        buffer[7] = '-';
+        buffer[8] = dd[0];
+        buffer[9] = dd[1];
+
+        return buffer + FORMATTED_LENGTH;
     }
 
     /**
@@ -98,7 +177,7 @@ public:
      */
     bool operator == (const MyriadDate& myriadDate) const
     {
-        return _dateTime == myriadDate._dateTime;
+        return _dayNumber == myriadDate._dayNumber;
     }
 
     /**
@@ -108,7 +187,7 @@ public:
      */
     bool operator != (const MyriadDate& myriadDate) const
     {
-        return _dateTime != myriadDate._dateTime;
+        return _dayNumber != myriadDate._dayNumber;
     }
 
     /**
@@ -118,7 +197,7 @@ public:
      */
     bool operator <  (const MyriadDate& myriadDate) const
     {
-        return _dateTime < myriadDate._dateTime;
+        return _dayNumber < myriadDate._dayNumber;
     }
 
     /**
@@ -128,7 +207,7 @@ public:
      */
     bool operator <= (const MyriadDate& myriadDate) const
     {
-        return _dateTime <= myriadDate._dateTime;
+        return _dayNumber <= myriadDate._dayNumber;
     }
 
     /**
@@ -138,7 +217,7 @@ public:
      */
     bool operator >  (const MyriadDate& myriadDate) const
     {
-        return _dateTime > myriadDate._dateTime;
+        return _dayNumber > myriadDate._dayNumber;
     }
 
     /**
@@ -148,7 +227,7 @@ public:
      */
     bool operator >= (const MyriadDate& myriadDate) const
     {
-        return _dateTime >= myriadDate._dateTime;
+        return _dayNumber >= myriadDate._dayNumber;
     }
 
     /**
@@ -158,7 +237,7 @@ public:
      */
     MyriadDate& operator ++(int)
     {
-        _dateTime += Timespan(1, 0, 0, 0, 0);
+        _dayNumber++;
         return *this;
     }
 
@@ -169,7 +248,7 @@ public:
      */
     MyriadDate& operator ++()
     {
-        _dateTime += Timespan(1, 0, 0, 0, 0);
+        _dayNumber++;
         return *this;
     }
 
@@ -180,7 +259,7 @@ public:
      */
     MyriadDate& operator --(int)
     {
-        _dateTime -= Timespan(1, 0, 0, 0, 0);
+        _dayNumber--;
         return *this;
     }
 
@@ -191,7 +270,7 @@ public:
      */
     MyriadDate& operator --()
     {
-        _dateTime -= Timespan(1, 0, 0, 0, 0);
+        _dayNumber--;
         return *this;
     }
 
@@ -202,7 +281,7 @@ public:
      */
     MyriadDate operator +(const Int64& daysSpan) const
     {
-        return MyriadDate(_dateTime + Timespan(daysSpan, 0, 0, 0, 0));
+        return fromDayNumber(static_cast<Int32>(_dayNumber + daysSpan));
     }
 
     /**
@@ -212,7 +291,7 @@ public:
      */
     MyriadDate operator -(const Int64& daysSpan) const
     {
-        return MyriadDate(_dateTime - Timespan(daysSpan, 0, 0, 0, 0));
+        return fromDayNumber(static_cast<Int32>(_dayNumber - daysSpan));
     }
 
     /**
@@ -222,7 +301,7 @@ public:
      */
     Int64 operator -(const MyriadDate& myriadDate) const
     {
-        return (_dateTime - myriadDate._dateTime).days();
+        return static_cast<Int64>(_dayNumber) - myriadDate._dayNumber;
     }
 
     /**
@@ -232,7 +311,7 @@ public:
      */
     MyriadDate& operator +=(const Timespan& daysSpan)
     {
-        _dateTime += Timespan(1, 0, 0, 0, 0);
+        _dayNumber += daysSpan.days();
         return *this;
     }
 
@@ -243,7 +322,7 @@ public:
      */
     MyriadDate& operator -=(const Timespan& daysSpan)
     {
-        _dateTime -= Timespan(1, 0, 0, 0, 0);
+        _dayNumber -= daysSpan.days();
         return *this;
     }
 
@@ -259,12 +338,85 @@ public:
 
 private:
 
-    void resetTime()
+    /**
+     * The day number of 1970-01-01.
+     */
+    static const Int32 UNIX_EPOCH = 719163;
+
+    /**
+     * Converts a proleptic Gregorian civil date into a day number.
+     */
+    static Int32 toDayNumber(int year, int month, int day)
+    {
+        year -= month <= 2;
+        const int era = (year >= 0 ? year : year - 399) / 400;
+        const int yoe = year - era * 400;
+        const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468 + UNIX_EPOCH;
+    }
+
+    /**
+     * Converts a day number into a proleptic Gregorian civil date.
+     */
+    static void toCivil(Int32 dayNumber, int& year, int& month, int& day)
     {
-        _dateTime.assign(_dateTime.year(), _dateTime.month(), _dateTime.day());
+        const int z = dayNumber - UNIX_EPOCH + 719468;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = z - era * 146097;
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        day = doy - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = yoe + era * 400 + (month <= 2);
     }
 
-    DateTime _dateTime;
+    /**
+     * Parses a date string. Strings starting with a valid YYYY-MM-DD date are
+     * handled directly, everything else is delegated to the
+     * Poco::DateTimeParser.
+     */
+    static Int32 parse(const char* date, size_t length)
+    {
+        if (length >= FORMATTED_LENGTH && date[4] == '-' && date[7] == '-')
+        {
+            int y = 0, m = 0, d = 0;
+            bool valid = true;
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                valid &= (date[i] >= '0' && date[i] <= '9');
+                y = 10 * y + (date[i] - '0');
+            }
+            for (size_t i = 5; i < 7; i++)
+            {
+                valid &= (date[i] >= '0' && date[i] <= '9');
+                m = 10 * m + (date[i] - '0');
+            }
+            for (size_t i = 8; i < 10; i++)
+            {
+                valid &= (date[i] >= '0' && date[i] <= '9');
+                d = 10 * d + (date[i] - '0');
+            }
+
+            if (valid && m >= 1 && m <= 12 && d >= 1 && d <= DateTime::daysOfMonth(y, m))
+            {
+                return toDayNumber(y, m, d);
+            }
+        }
+
+        int tzd;
+        DateTime dateTime;
+        DateTimeParser::parse(string(date, length).substr(0, FORMATTED_LENGTH), dateTime, tzd);
+
+        return toDayNumber(dateTime.year(), dateTime.month(), dateTime.day());
+    }
+
+    /**
+     * The day number (0001-01-01 is day 1).
+     */
+    Int32 _dayNumber;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -277,7 +429,8 @@ private:
  */
 inline std::ostream& operator<<(std::ostream& stream, const MyriadDate& ob)
 {
-    stream << Poco::DateTimeFormatter::format(ob._dateTime, "%Y-%m-%d");
+    char buffer[MyriadDate::FORMATTED_LENGTH];
+    stream.write(buffer, ob.format(buffer) - buffer);
     return stream;
 }
 
@@ -286,11 +439,9 @@ inline std::ostream& operator<<(std::ostream& stream, const MyriadDate& ob)
  */
 inline std::istream& operator>>(std::istream& stream, MyriadDate& ob)
 {
-    int tzd;
-    char line[11];
-    line[10] = '\0';
-    stream.read(line, 10);
-    DateTimeParser::parse(string(line), ob._dateTime, tzd);
+    char line[MyriadDate::FORMATTED_LENGTH];
+    stream.read(line, MyriadDate::FORMATTED_LENGTH);
+    ob._dayNumber = MyriadDate::parse(line, static_cast<size_t>(stream.gcount()));
     return stream;
 }
 
@@ -16,6 +16,7 @@
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 
+#include "core/BinarySpecification.h"
 #include "core/exceptions.h"
 #include "core/types.h"
 #include "core/types/MyriadEnumSet.h"
@@ -25,6 +26,7 @@
 #include <Poco/NumberParser.h>
 #include <Poco/String.h>
 
+#include <algorithm>
 #include <fstream>
 
 using namespace Poco;
@@ -58,6 +60,13 @@ void MyriadEnumSet::initialize(const Path& path)
         throw ConfigException(format("Cannot find file at `%s`", path.toString()));
     }
 
+    if (BinarySpecification::available(path))
+    {
+        BinarySpecification specification(BinarySpecification::compiledPath(path), BinarySpecification::ENUM_SET);
+        initialize(specification);
+        return;
+    }
+
     File file(path);
 
     if (!file.canRead())
@@ -188,11 +197,118 @@ void MyriadEnumSet::initialize(istream& in, size_t& currentLineNumber)
     {
         throw RuntimeException("Unexpected state in CombinedPrFunction reader at line " + currentLineNumber);
     }
+
+    render();
+}
+
+void MyriadEnumSet::initialize(const BinarySpecification& specification)
+{
+    // reset old state
+    reset();
+
+    const BinarySpecification::Header& header = specification.header();
+
+    if (header.count == 0 || header.count > numeric_limits<size_t>::max()/sizeof(I64u) - 1)
+    {
+        throw DataException(format("Invalid number of values in binary specification `%s`", specification.path()));
+    }
+
+    size_t numberOfValues = static_cast<size_t>(header.count);
+    size_t offsetsOffset = sizeof(BinarySpecification::Header);
+    size_t poolOffset = offsetsOffset + (numberOfValues + 1) * sizeof(I64u);
+
+    const I64u* offsets = specification.at<I64u>(offsetsOffset, numberOfValues + 1);
+    const char* pool = specification.at<char>(poolOffset, static_cast<size_t>(offsets[numberOfValues]));
+
+    _numberOfValues = numberOfValues;
+    _values.resize(_numberOfValues);
+
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        if (offsets[i] > offsets[i+1])
+        {
+            throw DataException(format("Invalid string pool offset for value #%z in binary specification `%s`", i, specification.path()));
+        }
+
+        _values[i].assign(pool + offsets[i], static_cast<size_t>(offsets[i+1] - offsets[i]));
+    }
+
+    render();
 }
 
 void MyriadEnumSet::reset()
 {
-    // do nothing
+    _renderedPool.clear();
+    _renderedOffsets.clear();
+}
+
+void MyriadEnumSet::render()
+{
+    size_t poolSize = 0;
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        const string& value = _values[i];
+        size_t quotes = static_cast<size_t>(std::count(value.begin(), value.end(), '"'));
+        poolSize += 4 * value.size() + quotes + 4 + sizeof(I32u);
+    }
+
+    _renderedPool.clear();
+    _renderedPool.reserve(poolSize);
+    _renderedOffsets.resize(RENDERINGS * _numberOfValues + 1);
+
+    size_t k = 0;
+
+    // PLAIN
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        _renderedOffsets[k++] = _renderedPool.size();
+        _renderedPool.insert(_renderedPool.end(), _values[i].begin(), _values[i].end());
+    }
+
+    // QUOTED
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        _renderedOffsets[k++] = _renderedPool.size();
+        _renderedPool.push_back('"');
+        _renderedPool.insert(_renderedPool.end(), _values[i].begin(), _values[i].end());
+        _renderedPool.push_back('"');
+    }
+
+    // ESCAPED
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        _renderedOffsets[k++] = _renderedPool.size();
+        _renderedPool.push_back('"');
+        for (string::const_iterator it = _values[i].begin(); it != _values[i].end(); ++it)
+        {
+            if (*it == '"')
+            {
+                _renderedPool.push_back('"');
+            }
+            _renderedPool.push_back(*it);
+        }
+        _renderedPool.push_back('"');
+    }
+
+    // LENGTH_PREFIXED
+    for (size_t i = 0; i < _numberOfValues; i++)
+    {
+        if (_values[i].size() > numeric_limits<I32u>::max())
+        {
+            throw DataException(format("Enum value #%z in `%s` is too long", i, _name));
+        }
+
+        I32u length = static_cast<I32u>(_values[i].size());
+
+        _renderedOffsets[k++] = _renderedPool.size();
+        for (size_t b = 0; b < sizeof(I32u); b++)
+        {
+            _renderedPool.push_back(static_cast<char>((length >> (8 * b)) & 0xFF));
+        }
+        _renderedPool.insert(_renderedPool.end(), _values[i].begin(), _values[i].end());
+    }
+
+    _renderedOffsets[k] = _renderedPool.size();
 }
 
 //@}
@@ -35,12 +35,22 @@ namespace Myriad {
  * @addtogroup core_types
  * @{*/
 
+// forward declarations
+class BinarySpecification;
+
 /**
  * A lightweight implementation of an Enum type.
  *
  * This is a wrapper around a vector of strings that are used as an enum type,
  * together with a corresponding initialization logic that reads an the enum
- * values from the corresponding specification format.
+ * values from the corresponding specification format. A precompiled
+ * BinarySpecification located next to the specification file is preferred
+ * over the textual one.
+ *
+ * After initialization, every value is additionally pre-rendered in each of
+ * the supported output Rendering variants into a single contiguous pool, so
+ * record serializers can emit enum fields with a single bytes() lookup
+ * followed by a raw copy instead of formatting the string for each record.
  *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
@@ -48,13 +58,34 @@ class MyriadEnumSet : public Poco::RefCountedObject
 {
 public:
 
+    /**
+     * The output renderings precomputed for each enum value.
+     */
+    enum Rendering
+    {
+        PLAIN = 0, //!< The value as is.
+        QUOTED = 1, //!< The value enclosed in double quotes.
+        ESCAPED = 2, //!< The value enclosed in double quotes with embedded quotes doubled (RFC 4180).
+        LENGTH_PREFIXED = 3 //!< The value prefixed with its length as a little-endian I32u.
+    };
+
+    /**
+     * A view of the pre-rendered bytes of a single enum value.
+     */
+    struct Bytes
+    {
+        const char* data; //!< A pointer to the first byte.
+        size_t size; //!< The number of bytes.
+    };
+
     /**
      * Default constructor.
      *
      * Merely creates a new enum object, and does not execute any
      * initialization routines.
      */
-    MyriadEnumSet()
+    MyriadEnumSet() :
+        _numberOfValues(0)
     {
     }
 
@@ -192,6 +223,29 @@ public:
         return _values;
     }
 
+    /**
+     * Returns the pre-rendered bytes of the enum \p value in the given
+     * \p rendering. Out of range values (including the Enum null value) are
+     * rendered as an empty byte sequence.
+     *
+     * @param value The index of the enum value.
+     * @param rendering The requested rendering.
+     * @return A view of the pre-rendered bytes owned by this enum set.
+     */
+    Bytes bytes(size_t value, Rendering rendering) const
+    {
+        Bytes result = { NULL, 0 };
+
+        if (value < _numberOfValues)
+        {
+            size_t k = rendering * _numberOfValues + value;
+            result.data = &_renderedPool[0] + _renderedOffsets[k];
+            result.size = _renderedOffsets[k+1] - _renderedOffsets[k];
+        }
+
+        return result;
+    }
+
 private:
 
     /**
@@ -204,6 +258,17 @@ private:
 
     void reset();
 
+    /**
+     * Builds the pre-rendered pool from the current values.
+     */
+    void render();
+
+    /**
+     * Initializes the enum set with the values stored in a mapped binary
+     * specification.
+     */
+    void initialize(const BinarySpecification& specification);
+
     /**
      * The name of this enum set.
      */
@@ -219,6 +284,22 @@ private:
      */
     vector<string> _values;
 
+    /**
+     * The number of supported Rendering variants.
+     */
+    static const size_t RENDERINGS = 4;
+
+    /**
+     * A contiguous pool with all values rendered in all Rendering variants.
+     */
+    vector<char> _renderedPool;
+
+    /**
+     * Offsets into the rendered pool. The bytes of \p value in a given
+     * \p rendering start at <tt>rendering * _numberOfValues + value</tt>.
+     */
+    vector<size_t> _renderedOffsets;
+
     static RegularExpression headerLine1Format;
     static RegularExpression valueLineFormat;
 };
@@ -16,12 +16,27 @@
  */
 
 #include "communication/Notifications.h"
+#include "communication/ProgressRegistry.h"
+#include "core/NumaTopology.h"
+#include "core/PerfCounters.h"
+#include "core/clock.h"
 #include "generator/AbstractGeneratorSubsystem.h"
+#include "runtime/setter/SetterProfiler.h"
 
 #include <functional>
+#include <iterator>
+#include <map>
+#include <vector>
 #include <Poco/ErrorHandler.h>
+#include <Poco/Event.h>
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
 #include <Poco/Format.h>
+#include <Poco/Mutex.h>
+#include <Poco/Path.h>
 #include <Poco/Stopwatch.h>
+#include <Poco/Thread.h>
+#include <Poco/Timestamp.h>
 
 using namespace std;
 using namespace Poco;
@@ -36,6 +51,85 @@ namespace Myriad {
 ////////////////////////////////////////////////////////////////////////////////
 //@{
 
+/**
+ * A runnable wrapper that runs a single stage task, optionally on a given
+ * NUMA node and with hardware performance counters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class TaskRunner: public Runnable
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param task The wrapped task.
+     * @param node The index of the NUMA node the task should run on, or -1
+     *             if the task can run anywhere.
+     * @param stage The name of the stage the task belongs to.
+     * @param perfCounters A flag indicating whether the hardware performance
+     *                     counters of the task should be added to the
+     *                     PerfReport::defaultReport().
+     */
+    TaskRunner(AbstractStageTask& task, int node, const string& stage, bool perfCounters) :
+        _task(task),
+        _node(node),
+        _stage(stage),
+        _perfCounters(perfCounters)
+    {
+    }
+
+    /**
+     * Binds the current thread to the NUMA node of the task (if any), moves
+     * the task memory to that node and runs the wrapped task with its
+     * progress counters as the current ProgressSlot of the thread.
+     */
+    void run()
+    {
+        if (_node >= 0)
+        {
+	        NumaTopology::instance().bind(static_cast<size_t>(_node));
+	        _task.localize();
+        }
+
+        ProgressSlot::Scope progress(_task.progress());
+
+        if (!_perfCounters)
+        {
+	        _task.run();
+	        return;
+        }
+
+        // the counters count the calling thread, so they are opened here
+        PerfCounters counters;
+        if (!counters.available())
+        {
+	        PerfReport::defaultReport().unavailable(counters.error());
+        }
+
+        I64u wallStart = monotonicNanos();
+        I64u cpuStart = threadCpuNanos();
+
+        counters.start();
+        _task.run();
+        PerfSample sample = counters.stop();
+
+        Thread* thread = Thread::current();
+        PerfReport::defaultReport().add(_stage, _task.name(), thread != NULL ? thread->id() : 0, sample, _task.progress().records(), _task.progress().bytes(), monotonicNanos() - wallStart, threadCpuNanos() - cpuStart);
+    }
+
+private:
+
+    AbstractStageTask& _task;
+
+    const int _node;
+
+    const string _stage;
+
+    const bool _perfCounters;
+};
+
 /**
  * Function object handling AbstractSequenceGenerator thread creation for ready generators.
  *
@@ -47,9 +141,16 @@ public:
 
     /**
      * Constructor.
+     *
+     * @param caller The enclosing AbstractGeneratorSubsystem.
+     * @param runners A container for the created TaskRunner objects, which
+     *                must be deleted once the threads are joined.
+     * @param stage The name of the executed stage.
      */
-    ThreadExecutor(AbstractGeneratorSubsystem& caller) :
-        _caller(caller)
+    ThreadExecutor(AbstractGeneratorSubsystem& caller, vector<TaskRunner*>& runners, const string& stage) :
+        _caller(caller),
+        _runners(runners),
+        _stage(stage)
     {
     }
 
@@ -68,7 +169,8 @@ public:
 	        AbstractStageTask* task = (*it);
 	        if (task->runnable())
 	        {
-		        _caller._threadPool.start(*task, task->name());
+		        _runners.push_back(new TaskRunner(*task, _caller.placeTask(), _stage, _caller._config.perfCounters()));
+		        _caller._threadPool.start(*_runners.back(), task->name());
 	        }
         }
     }
@@ -79,6 +181,16 @@ private:
      * A reference to the enclosing AbstractGeneratorSubsystem.
      */
     AbstractGeneratorSubsystem& _caller;
+
+    /**
+     * The created task runners.
+     */
+    vector<TaskRunner*>& _runners;
+
+    /**
+     * The name of the executed stage.
+     */
+    const string _stage;
 };
 
 /**
@@ -171,6 +283,161 @@ private:
     AbstractGeneratorSubsystem& _caller;
 };
 
+/**
+ * The shared completion state of the stages executed by the
+ * AbstractGeneratorSubsystem::executePipeline() method.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class StagePipeline
+{
+public:
+
+    /**
+     * A stage of a single generator in the pipeline. The generator is
+     * prepared for the stage when the node is started and cleaned up as
+     * soon as the node is finished.
+     */
+    struct Node
+    {
+        Node(const AbstractSequenceGenerator::Stage& stage, size_t stageIndex, AbstractSequenceGenerator* generator) :
+            stage(stage),
+            stageIndex(stageIndex),
+            generator(generator),
+            started(false),
+            finished(false),
+            pending(0)
+        {
+        }
+
+        AbstractSequenceGenerator::Stage stage; //!< The pipelined stage.
+        size_t stageIndex; //!< The index of the stage in \p stages.
+        AbstractSequenceGenerator* generator; //!< The generator executing the stage.
+        vector<size_t> dependencies; //!< The indexes of the nodes that must finish first.
+        bool started; //!< True if the generator has been prepared and its tasks have been started.
+        bool finished; //!< True if all tasks have finished and the generator has been cleaned up.
+        size_t pending; //!< The number of running tasks.
+    };
+
+    /**
+     * The progress of a stage across all generators.
+     */
+    struct StageState
+    {
+        StageState(const AbstractSequenceGenerator::Stage& stage) :
+            stage(stage),
+            unfinished(0),
+            entered(false)
+        {
+        }
+
+        AbstractSequenceGenerator::Stage stage; //!< The pipelined stage.
+        size_t unfinished; //!< The number of unfinished nodes of the stage.
+        bool entered; //!< True if a task of the stage has been started.
+        Timestamp startTime; //!< The time at which the first task of the stage was started.
+    };
+
+    /**
+     * Marks a task of the stage with the given \p index as finished and
+     * wakes up the scheduler.
+     */
+    void finish(size_t index)
+    {
+        {
+            FastMutex::ScopedLock lock(_mutex);
+            nodes[index].pending--;
+        }
+
+        _changed.set();
+    }
+
+    /**
+     * Returns the number of running tasks of the stage with the given
+     * \p index.
+     */
+    size_t pending(size_t index)
+    {
+        FastMutex::ScopedLock lock(_mutex);
+        return nodes[index].pending;
+    }
+
+    /**
+     * Waits until the next task finishes.
+     */
+    void wait()
+    {
+        _changed.wait();
+    }
+
+    /**
+     * The pipeline nodes in stage order.
+     */
+    vector<Node> nodes;
+
+    /**
+     * The pipelined stages in execution order.
+     */
+    vector<StageState> stages;
+
+private:
+
+    /**
+     * A mutex guarding the pending task counters.
+     */
+    FastMutex _mutex;
+
+    /**
+     * An event signaled whenever a task finishes.
+     */
+    Event _changed;
+};
+
+/**
+ * A TaskRunner that reports the completion of the task to the
+ * StagePipeline.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class PipelineTaskRunner: public TaskRunner
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    PipelineTaskRunner(AbstractStageTask& task, int node, StagePipeline& pipeline, size_t index, bool perfCounters) :
+        TaskRunner(task, node, pipeline.nodes[index].stage.name(), perfCounters),
+        _pipeline(pipeline),
+        _index(index)
+    {
+    }
+
+    /**
+     * Runs the wrapped task. Exceptions are passed on to the ErrorHandler
+     * after the completion has been reported.
+     */
+    void run()
+    {
+        try
+        {
+	        TaskRunner::run();
+        }
+        catch(...)
+        {
+	        _pipeline.finish(_index);
+	        throw;
+        }
+
+        _pipeline.finish(_index);
+    }
+
+private:
+
+    StagePipeline& _pipeline;
+
+    const size_t _index;
+};
+
 //@}
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -185,10 +452,31 @@ void AbstractGeneratorSubsystem::initialize(Application& app)
         return;
     }
 
+    Stopwatch totalTimer, phaseTimer;
+    totalTimer.start();
+
     try
     {
         // initialize the GeneratorConfig instance
+        // (file based functions and enum sets are loaded concurrently)
+        phaseTimer.restart();
         _config.initialize(app.config());
+        _logger.information(format("Startup phase `config` completed in %.3f ms", phaseTimer.elapsed() / 1000.0));
+
+        // spread the stage tasks over the NUMA nodes of the host
+        if (_config.numa())
+        {
+	        _numaNodes = NumaTopology::instance().size();
+
+	        if (_numaNodes > 1)
+	        {
+		        _logger.information(format("Placing stage tasks on %z NUMA nodes", _numaNodes));
+	        }
+	        else
+	        {
+		        _logger.warning("NUMA placement is enabled, but the host has a single NUMA node");
+	        }
+        }
 
         // scaling factor should always be greater or equal than 1.0
         if (_config.scalingFactor() < 1.0)
@@ -200,16 +488,57 @@ void AbstractGeneratorSubsystem::initialize(Application& app)
         _ui.information(format("Job output will be written in %s", _config.getString("application.job-dir")));
 
         // register all generators in the generator pool
+        phaseTimer.restart();
         registerGenerators();
-        list<AbstractSequenceGenerator*>& generators = _generatorPool.getAll();
+        _generators = _generatorPool.getAll();
+        _logger.information(format("Startup phase `register` completed in %.3f ms", phaseTimer.elapsed() / 1000.0));
+
+        // configure the additional partitions of a partition set; these
+        // share the functions and enum sets loaded by the first partition
+        vector<I16u> nodeIDs = _config.nodeIDs();
+        if (nodeIDs.size() > 1)
+        {
+	        phaseTimer.restart();
+	        for (vector<I16u>::const_iterator it = nodeIDs.begin() + 1; it != nodeIDs.end(); ++it)
+	        {
+		        GeneratorPartition* partition = new GeneratorPartition();
+		        _partitions.push_back(partition);
+
+		        partition->config.initialize(app.config(), _config, *it);
+
+		        _registeredPool = &partition->pool;
+		        _registeredConfig = &partition->config;
+		        registerGenerators();
+
+		        list<AbstractSequenceGenerator*>& generators = partition->pool.getAll();
+		        _generators.insert(_generators.end(), generators.begin(), generators.end());
+	        }
+
+	        _registeredPool = &_generatorPool;
+	        _registeredConfig = &_config;
+	        _logger.information(format("Startup phase `partitions` completed in %.3f ms", phaseTimer.elapsed() / 1000.0));
+        }
 
-        // initialize all registered generators
-        for(list<AbstractSequenceGenerator*>::iterator it = generators.begin(); it != generators.end(); ++it)
+        // initialize all registered generators; this depends on all functions
+        // and enum sets being loaded and must run in registration order, as
+        // each generator claims the next substream of the master PRNG of its
+        // partition
+        phaseTimer.restart();
+        for(list<AbstractSequenceGenerator*>::iterator it = _generators.begin(); it != _generators.end(); ++it)
         {
 	        (*it)->initialize();
         }
+        _logger.information(format("Startup phase `generators` completed in %.3f ms", phaseTimer.elapsed() / 1000.0));
+        _logger.information(format("Startup completed in %.3f ms", totalTimer.elapsed() / 1000.0));
 
-        _ui.information(format("Starting generation for node %hu from %hu", _config.nodeID(), _config.numberOfChunks()));
+        if (nodeIDs.size() > 1)
+        {
+	        _ui.information(format("Starting generation for %z nodes (%s) from %hu", nodeIDs.size(), _config.getString("application.node-id"), _config.numberOfChunks()));
+        }
+        else
+        {
+	        _ui.information(format("Starting generation for node %hu from %hu", _config.nodeID(), _config.numberOfChunks()));
+        }
     }
     catch(const Exception& e)
     {
@@ -244,17 +573,15 @@ void AbstractGeneratorSubsystem::uninitialize()
 
 unsigned short AbstractGeneratorSubsystem::prepareStage(AbstractSequenceGenerator::Stage stage)
 {
-    list<AbstractSequenceGenerator*>& generators = _generatorPool.getAll();
-
     if (_logger.debug())
     {
         _logger.debug(format("Preparing stage `%s`", stage.name()));
     }
 
     unsigned short runnableCount = 0;
-    for (AbstractSequenceGenerator::PtrList::iterator it = generators.begin(); it != generators.end(); ++it)
+    for (AbstractSequenceGenerator::PtrList::iterator it = _generators.begin(); it != _generators.end(); ++it)
     {
-        (*it)->prepare(stage, _generatorPool);
+        (*it)->prepare(stage, (*it)->config().generatorPool());
         runnableCount += (*it)->runnableTasksCount();
     }
 
@@ -267,78 +594,313 @@ unsigned short AbstractGeneratorSubsystem::prepareStage(AbstractSequenceGenerato
     return runnableCount;
 }
 
+int AbstractGeneratorSubsystem::placeTask()
+{
+    if (_numaNodes < 2)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(_placedTasks++ % _numaNodes);
+}
+
 void AbstractGeneratorSubsystem::cleanupStage(AbstractSequenceGenerator::Stage stage)
 {
-    list<AbstractSequenceGenerator*>& generators = _generatorPool.getAll();
-    for (AbstractSequenceGenerator::PtrList::iterator it = generators.begin(); it != generators.end(); ++it)
+    for (AbstractSequenceGenerator::PtrList::iterator it = _generators.begin(); it != _generators.end(); ++it)
     {
         (*it)->cleanup(stage);
     }
 }
 
-void AbstractGeneratorSubsystem::start()
+void AbstractGeneratorSubsystem::executeStages(GeneratorErrorHandler& handler)
 {
-    Stopwatch totalTimer, stageTimer;
+    Stopwatch stageTimer;
 
-    double sf = _config.getDouble("application.scaling-factor");
-    _logger.information(format("Generating tables with scaling factor %.03f", sf));
+    list<AbstractSequenceGenerator*>& generators = _generators;
+    for (AbstractSequenceGenerator::StageList::const_iterator it = AbstractSequenceGenerator::STAGES.begin(); it != AbstractSequenceGenerator::STAGES.end(); ++it)
+    {
+        if (!_executeStages[it->id()])
+        {
+	        _logger.debug(format("Skipping stage `%s`", it->name()));
+	        continue;
+        }
 
-    GeneratorErrorHandler handler(*this);
-    ErrorHandler* oldHandler = ErrorHandler::set(&handler);
+        // start stage timer
+        stageTimer.restart();
 
-    try
+        // announce next stage
+        _notificationCenter.postNotification(new StartStage(it->id()));
+
+        // prepare generators for the next stage
+        unsigned short runnableCount = prepareStage(*it);
+
+        if (runnableCount == 0)
+        {
+	        continue;
+        }
+
+        _logger.information(format("Entering stage `%s`", it->name()));
+
+        // spawn separate threads for each RUNNABLE task
+        vector<TaskRunner*> runners;
+        ThreadExecutor execute(*this, runners, it->name());
+        for_each(generators.begin(), generators.end(), execute);
+
+        // wait for all threads to finish
+        _threadPool.joinAll();
+
+        for (vector<TaskRunner*>::iterator runner = runners.begin(); runner != runners.end(); ++runner)
+        {
+	        delete *runner;
+        }
+
+        // cleanup generators upon stage execution
+        cleanupStage(*it);
+
+        // make sure that all threads exited correctly
+        if (!handler.checkSanity())
+        {
+            throw Poco::RuntimeException(format("Error at stage `%s`. Aborting the generation process.", it->name()));
+        }
+
+        // stop the stage timer
+        stageTimer.stop();
+
+        _logger.information(format("Stage `%s` completed in %d seconds", it->name(), stageTimer.elapsedSeconds()));
+        SetterProfile::defaultProfile().report(_logger, format("after stage `%s`", it->name()));
+    }
+}
+
+void AbstractGeneratorSubsystem::executePipeline(GeneratorErrorHandler& handler)
+{
+    list<AbstractSequenceGenerator*>& generators = _generators;
+
+    StagePipeline pipeline;
+    // the nodes created so far for each generator
+    map<AbstractSequenceGenerator*, vector<size_t> > generatorNodes;
+    // the generators of each partition by name
+    map<pair<const GeneratorConfig*, string>, AbstractSequenceGenerator*> generatorsByName;
+
+    for (AbstractSequenceGenerator::PtrList::iterator g = generators.begin(); g != generators.end(); ++g)
     {
-        // mark node as alive
-        _notificationCenter.postNotification(new ChangeNodeState(NodeState::ALIVE));
+        generatorsByName[make_pair(&(*g)->config(), (*g)->name())] = *g;
+    }
 
-        // start total timer
-        totalTimer.start();
+    // create one node per stage and generator and derive the node dependencies
+    for (AbstractSequenceGenerator::StageList::const_iterator it = AbstractSequenceGenerator::STAGES.begin(); it != AbstractSequenceGenerator::STAGES.end(); ++it)
+    {
+        if (!_executeStages[it->id()])
+        {
+	        _logger.debug(format("Skipping stage `%s`", it->name()));
+	        continue;
+        }
+
+        pipeline.stages.push_back(StagePipeline::StageState(*it));
+        pipeline.stages.back().unfinished = generators.size();
 
-        list<AbstractSequenceGenerator*>& generators = _generatorPool.getAll();
-        for (AbstractSequenceGenerator::StageList::const_iterator it = AbstractSequenceGenerator::STAGES.begin(); it != AbstractSequenceGenerator::STAGES.end(); ++it)
+        const size_t first = pipeline.nodes.size();
+        for (AbstractSequenceGenerator::PtrList::iterator g = generators.begin(); g != generators.end(); ++g)
         {
-	        if (!_executeStages[it->id()])
+	        StagePipeline::Node node(*it, pipeline.stages.size() - 1, *g);
+
+	        // depend on the earlier stages of the same and of the required generators
+	        const vector<size_t>& own = generatorNodes[*g];
+	        node.dependencies.insert(node.dependencies.end(), own.begin(), own.end());
+
+	        for (AbstractSequenceGenerator::NameSet::const_iterator d = (*g)->dependencies().begin(); d != (*g)->dependencies().end(); ++d)
+	        {
+		        map<pair<const GeneratorConfig*, string>, AbstractSequenceGenerator*>::const_iterator required = generatorsByName.find(make_pair(&(*g)->config(), *d));
+		        if (required != generatorsByName.end())
+		        {
+			        const vector<size_t>& nodes = generatorNodes[required->second];
+			        node.dependencies.insert(node.dependencies.end(), nodes.begin(), nodes.end());
+		        }
+	        }
+
+	        pipeline.nodes.push_back(node);
+        }
+
+        for (size_t i = first; i < pipeline.nodes.size(); i++)
+        {
+	        generatorNodes[pipeline.nodes[i].generator].push_back(i);
+        }
+    }
+
+    vector<PipelineTaskRunner*> runners;
+    size_t finishedCount = 0;
+    size_t currentStage = pipeline.stages.size();
+    bool failed = false;
+
+    while (finishedCount < pipeline.nodes.size() && !failed)
+    {
+        bool changed = false;
+
+        // start all nodes whose dependencies are completed
+        for (size_t i = 0; i < pipeline.nodes.size(); i++)
+        {
+	        StagePipeline::Node& node = pipeline.nodes[i];
+
+	        bool ready = !node.started;
+	        for (size_t d = 0; ready && d < node.dependencies.size(); d++)
+	        {
+		        ready = pipeline.nodes[node.dependencies[d]].finished;
+	        }
+
+	        if (!ready)
 	        {
-		        _logger.debug(format("Skipping stage `%s`", it->name()));
 		        continue;
 	        }
 
-	        // start stage timer
-	        stageTimer.restart();
+	        // prepare the generator for the stage
+	        const size_t registered = node.generator->stageTasks().size();
+	        node.generator->prepare(node.stage, node.generator->config().generatorPool());
 
-	        // announce next stage
-	        _notificationCenter.postNotification(new StartStage(it->id()));
+	        vector<AbstractStageTask*> tasks;
+	        AbstractSequenceGenerator::TaskPtrList::const_iterator task = node.generator->stageTasks().begin();
+	        advance(task, registered);
+	        for (; task != node.generator->stageTasks().end(); ++task)
+	        {
+		        if ((*task)->runnable())
+		        {
+			        tasks.push_back(*task);
+		        }
+	        }
 
-	        // prepare generators for the next stage
-	        unsigned short runnableCount = prepareStage(*it);
+	        node.started = true;
+	        node.pending = tasks.size();
+	        changed = true;
 
-	        if (runnableCount == 0)
+	        if (tasks.empty())
 	        {
 		        continue;
 	        }
 
-	        _logger.information(format("Entering stage `%s`", it->name()));
+	        StagePipeline::StageState& stage = pipeline.stages[node.stageIndex];
+	        if (!stage.entered)
+	        {
+		        stage.entered = true;
+		        stage.startTime.update();
+		        _logger.information(format("Entering stage `%s`", stage.stage.name()));
+	        }
+
+	        // increase the size of the thread pool if needed
+	        if (_threadPool.available() < static_cast<int>(tasks.size()))
+	        {
+		        _threadPool.addCapacity(static_cast<int>(tasks.size()) - _threadPool.available());
+	        }
 
 	        // spawn separate threads for each RUNNABLE task
-	        ThreadExecutor execute(*this);
-	        for_each(generators.begin(), generators.end(), execute);
+	        for (vector<AbstractStageTask*>::iterator t = tasks.begin(); t != tasks.end(); ++t)
+	        {
+		        runners.push_back(new PipelineTaskRunner(**t, placeTask(), pipeline, i, _config.perfCounters()));
+		        _threadPool.start(*runners.back(), (*t)->name());
+	        }
+        }
+
+        // clean up the generators of the completed nodes
+        for (size_t i = 0; i < pipeline.nodes.size(); i++)
+        {
+	        StagePipeline::Node& node = pipeline.nodes[i];
+
+	        if (node.started && !node.finished && pipeline.pending(i) == 0)
+	        {
+		        node.generator->cleanup(node.stage);
+		        node.finished = true;
+		        finishedCount++;
+		        changed = true;
+
+		        StagePipeline::StageState& stage = pipeline.stages[node.stageIndex];
+		        if (--stage.unfinished == 0 && stage.entered)
+		        {
+			        _logger.information(format("Stage `%s` completed in %d seconds", stage.stage.name(), static_cast<int>(stage.startTime.elapsed() / Timestamp::resolution())));
+			        SetterProfile::defaultProfile().report(_logger, format("after stage `%s`", stage.stage.name()));
+		        }
+	        }
+        }
+
+        // report the earliest unfinished stage as the current one
+        size_t earliest = 0;
+        while (earliest < pipeline.stages.size() && pipeline.stages[earliest].unfinished == 0)
+        {
+	        earliest++;
+        }
+
+        if (earliest < pipeline.stages.size() && earliest != currentStage)
+        {
+	        currentStage = earliest;
+	        _notificationCenter.postNotification(new StartStage(pipeline.stages[earliest].stage.id()));
+        }
+
+        // make sure that all threads exited correctly
+        failed = !handler.checkSanity();
+
+        // wait for the next task to finish
+        if (!changed && !failed)
+        {
+	        pipeline.wait();
+        }
+    }
 
-	        // wait for all threads to finish
-	        _threadPool.joinAll();
+    // wait for all threads to finish
+    _threadPool.joinAll();
 
-	        // cleanup generators upon stage execution
-	        cleanupStage(*it);
+    for (vector<PipelineTaskRunner*>::iterator it = runners.begin(); it != runners.end(); ++it)
+    {
+        delete *it;
+    }
 
-	        // make sure that all threads exited correctly
-	        if (!handler.checkSanity())
+    if (failed)
+    {
+        // cleanup the generators of the interrupted nodes
+        const StagePipeline::Node* interrupted = NULL;
+        for (vector<StagePipeline::Node>::iterator it = pipeline.nodes.begin(); it != pipeline.nodes.end(); ++it)
+        {
+	        if (it->started && !it->finished)
 	        {
-	            throw Poco::RuntimeException(format("Error at stage `%s`. Aborting the generation process.", it->name()));
+		        it->generator->cleanup(it->stage);
+		        it->finished = true;
+
+		        if (interrupted == NULL)
+		        {
+			        interrupted = &(*it);
+		        }
 	        }
+        }
 
-	        // stop the stage timer
-	        stageTimer.stop();
+        if (interrupted != NULL)
+        {
+	        throw Poco::RuntimeException(format("Error at stage `%s`. Aborting the generation process.", interrupted->stage.name()));
+        }
 
-	        _logger.information(format("Stage `%s` completed in %d seconds", it->name(), stageTimer.elapsedSeconds()));
+        throw Poco::RuntimeException("Error in the stage pipeline. Aborting the generation process.");
+    }
+}
+
+void AbstractGeneratorSubsystem::start()
+{
+    Stopwatch totalTimer;
+
+    double sf = _config.getDouble("application.scaling-factor");
+    _logger.information(format("Generating tables with scaling factor %.03f", sf));
+
+    GeneratorErrorHandler handler(*this);
+    ErrorHandler* oldHandler = ErrorHandler::set(&handler);
+
+    try
+    {
+        // mark node as alive
+        _notificationCenter.postNotification(new ChangeNodeState(NodeState::ALIVE));
+
+        // start total timer
+        totalTimer.start();
+
+        if (_config.pipelineStages())
+        {
+	        executePipeline(handler);
+        }
+        else
+        {
+	        executeStages(handler);
         }
 
         // stop the total timer
@@ -370,6 +932,30 @@ void AbstractGeneratorSubsystem::start()
     }
 
     _logger.information(format("Generation process completed in %d seconds", totalTimer.elapsedSeconds()));
+
+    if (_config.perfCounters())
+    {
+        writePerfReport();
+    }
+}
+
+void AbstractGeneratorSubsystem::writePerfReport()
+{
+    PerfReport& report = PerfReport::defaultReport();
+
+    if (!report.error().empty())
+    {
+        _logger.warning(report.error());
+    }
+
+    Path path(_config.perfReportPath());
+    File(path.parent()).createDirectories();
+
+    FileOutputStream out(path.toString());
+    report.write(out, _config.getString("application.job-id"), _config.getString("application.node-id", toString(_config.nodeID())));
+    out.close();
+
+    _logger.information(format("Performance counter report written to `%s`", path.toString()));
 }
 
 //@}
@@ -21,7 +21,9 @@
 #include "generator/AbstractSequenceGenerator.h"
 #include "generator/GeneratorPool.h"
 
+#include <list>
 #include <string>
+#include <vector>
 #include <Poco/NotificationCenter.h>
 #include "Poco/ThreadPool.h"
 #include <Poco/Util/Application.h>
@@ -36,6 +38,29 @@ namespace Myriad {
  * @addtogroup generator
  * @{*/
 
+// forward declarations
+class GeneratorErrorHandler;
+
+/**
+ * The generator pool and configuration of an additional partition generated
+ * by the same process (see AbstractGeneratorConfig::nodeIDs()).
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct GeneratorPartition
+{
+    /**
+     * Constructor.
+     */
+    GeneratorPartition() :
+        config(pool)
+    {
+    }
+
+    GeneratorPool pool; //!< The generators of the partition.
+    GeneratorConfig config; //!< The partition specific configuration.
+};
+
 /**
  * An implementation an abstract subsystem that controls the data generation
  * program flow.
@@ -59,7 +84,11 @@ public:
         _notificationCenter(notificationCenter),
         _executeStages(executeStages),
         _config(_generatorPool),
+        _registeredPool(&_generatorPool),
+        _registeredConfig(&_config),
         _threadPool("StageTaskPool", 4, 32),
+        _numaNodes(0),
+        _placedTasks(0),
         _initialized(false),
         _logger(Logger::get("generator.driver")),
         _ui(Logger::get("ui"))
@@ -71,13 +100,27 @@ public:
      */
     virtual ~AbstractGeneratorSubsystem()
     {
+        for (vector<GeneratorPartition*>::iterator it = _partitions.begin(); it != _partitions.end(); ++it)
+        {
+	        delete *it;
+        }
     }
 
     /**
      * Runs the GeneratorSubsystem. This method contains the main loop for the
      * data generator logic at the application level.
      *
-     * The loop iterates through all GeneratorStage instances.
+     * If the {application.pipeline-stages} config parameter is set, the
+     * stages are executed as a task graph with one node per stage and
+     * generator. A node is started as soon as the earlier stages of its
+     * generator and of the generators it depends on (see
+     * AbstractSequenceGenerator::dependencies()) are completed. The generator
+     * is prepared for the stage when the node is started and cleaned up as
+     * soon as the tasks of the node are completed, so the stages of a single
+     * generator never overlap. While stages of different generators overlap,
+     * the StartStage notifications report the earliest unfinished stage.
+     *
+     * Otherwise, the loop iterates through all GeneratorStage instances.
      * At each GeneratorStage, the AbstractSequenceGenerator::prepare() method
      * is used to poll all registered AbstractSequenceGenerator in order to
      * obtaion a set of runnable StageTask instances (currently only
@@ -87,6 +130,20 @@ public:
      * At the end of each stage the AbstractSequenceGenerator::cleanup()
      * methods of all registered generators are invoked.
      *
+     * If the process generates a partition set, the generators of all
+     * partitions are executed together by the shared thread pool.
+     *
+     * If the {application.numa} config parameter is set, the runnable tasks
+     * are assigned to the NUMA nodes of the host in a round-robin fashion.
+     * Each task binds its thread to the CPUs of its node and moves its
+     * output buffers there before running, so the records it creates are
+     * allocated on that node as well.
+     *
+     * If the {application.perf-counters} config parameter is set, the
+     * hardware performance counters of each task run are recorded and
+     * written to a JSON run report next to the node log (see
+     * AbstractGeneratorConfig::perfReportPath()).
+     *
      * Two ChangeStatus notifications with node values NodeState::ALIVE
      * and NodeState::Ready are issued correspondingly before and after the
      * main GeneratorStage iteration loop. In addition, a StartStage
@@ -94,6 +151,22 @@ public:
      */
     void start();
 
+    /**
+     * Returns the application wide generator config instance.
+     */
+    GeneratorConfig& config()
+    {
+        return _config;
+    }
+
+    /**
+     * Returns the pool of the generators registered for the first partition.
+     */
+    GeneratorPool& generatorPool()
+    {
+        return _generatorPool;
+    }
+
 protected:
 
     /**
@@ -115,18 +188,20 @@ protected:
     void uninitialize();
 
     /**
-     * Virtual method for registering generators.
+     * Virtual method for registering generators. Invoked once for each
+     * generated partition.
      */
     virtual void registerGenerators() = 0;
 
     /**
-     * Adds a single generator of the given \p T type to the generator pool.
+     * Adds a single generator of the given \p T type to the generator pool
+     * of the partition that is currently registered.
      *
      * @param name The name of the added generator.
      */
     template<class T> void registerGenerator(const string& name)
     {
-        _generatorPool.set(new T(name, _config, _notificationCenter));
+        _registeredPool->set(new T(name, *_registeredConfig, _notificationCenter));
     }
 
 private:
@@ -145,6 +220,33 @@ private:
      */
     void cleanupStage(AbstractSequenceGenerator::Stage stage);
 
+    /**
+     * Returns the index of the NUMA node the next started task should run
+     * on, or -1 if NUMA placement is disabled.
+     */
+    int placeTask();
+
+    /**
+     * Executes the stages one after another, waiting for all tasks of a stage
+     * to complete before the next stage is prepared.
+     *
+     * @param handler The error handler registered for the task threads.
+     */
+    void executeStages(GeneratorErrorHandler& handler);
+
+    /**
+     * Executes the stages as a task graph derived from the generator
+     * dependencies.
+     *
+     * @param handler The error handler registered for the task threads.
+     */
+    void executePipeline(GeneratorErrorHandler& handler);
+
+    /**
+     * Writes the PerfReport::defaultReport() to the configured location.
+     */
+    void writePerfReport();
+
     /**
      * A reference to the application wide notification center.
      */
@@ -165,11 +267,41 @@ private:
      */
     GeneratorConfig _config;
 
+    /**
+     * The additional partitions generated by this process.
+     */
+    vector<GeneratorPartition*> _partitions;
+
+    /**
+     * The generators of all partitions.
+     */
+    list<AbstractSequenceGenerator*> _generators;
+
+    /**
+     * The generator pool of the partition that is currently registered.
+     */
+    GeneratorPool* _registeredPool;
+
+    /**
+     * The configuration of the partition that is currently registered.
+     */
+    GeneratorConfig* _registeredConfig;
+
     /**
      * A pool for the runnable generator task threads.
      */
     ThreadPool _threadPool;
 
+    /**
+     * The number of NUMA nodes used for task placement (0 if disabled).
+     */
+    size_t _numaNodes;
+
+    /**
+     * The number of tasks placed on NUMA nodes so far.
+     */
+    size_t _placedTasks;
+
     /**
      * A flag indicating that the initialize() method has already been invoked.
      */
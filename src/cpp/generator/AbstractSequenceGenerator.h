@@ -25,6 +25,7 @@
 
 #include <list>
 #include <iostream>
+#include <set>
 #include <string>
 #include <Poco/AutoReleasePool.h>
 #include <Poco/AutoPtr.h>
@@ -122,6 +123,7 @@ public:
     typedef list<Stage> StageList; //!< A list of GeneratorStage objects
     typedef list<AbstractStageTask*> TaskPtrList; //!< A list of AbstractStageTask pointers
     typedef AutoReleasePool<AbstractStageTask> AbstractStageTaskPool; //!<-- An autorelease pool for AbstractStageTask objects
+    typedef set<string> NameSet; //!< A set of generator names
 
     /**
      * A static list of GeneratorStage objects relevant to the data generator
@@ -202,6 +204,15 @@ public:
         return _stageTasks;
     }
 
+    /**
+     * The names of the generators whose stage tasks must be completed before
+     * the tasks of this generator can be started.
+     */
+    const NameSet& dependencies() const
+    {
+        return _dependencies;
+    }
+
     /**
      * Returns the current number of runnable registered GeneratorStage tasks.
      */
@@ -235,8 +246,21 @@ protected:
         {
 	        _runnableTasksCount++;
         }
+    }
 
-        _notificationCenter.addObserver(NObserver<AbstractStageTask, UpdateProgress> (*task, &AbstractStageTask::reportProgress));
+    /**
+     * Declares that the stage tasks of this generator depend on the output
+     * of the generator with the given \p name. This method is typically
+     * called by subclasses in their constructors.
+     *
+     * @param name The name of the generator this generator depends on.
+     */
+    void dependsOn(const string& name)
+    {
+        if (name != _name)
+        {
+	        _dependencies.insert(name);
+        }
     }
 
     /**
@@ -245,11 +269,6 @@ protected:
      */
     void clearTasks()
     {
-        for (TaskPtrList::iterator it = _stageTasks.begin(); it != _stageTasks.end(); ++it)
-        {
-	        _notificationCenter.removeObserver(NObserver<AbstractStageTask, UpdateProgress> (**it, &AbstractStageTask::reportProgress));
-        }
-
         _stageTasks.clear();
         _taskPool.release();
         _runnableTasksCount = 0;
@@ -287,6 +306,11 @@ protected:
      */
     unsigned short _runnableTasksCount;
 
+    /**
+     * The names of the generators this generator depends on.
+     */
+    NameSet _dependencies;
+
     /**
      * Logger instance.
      */
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/NumberFormatter.h>
+#include <Poco/NumberParser.h>
+#include <Poco/Path.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup generator
+ * @{*/
+
+/**
+ * The durable progress of a stage task within its genID partition.
+ *
+ * A checkpoint records the [begin, end) genID range of the task, the next
+ * genID to be generated and the length of the output written for all
+ * preceding genIDs. Since the generated sequence is a deterministic function
+ * of the genID, a task can be resumed by truncating its output to the
+ * recorded offset and continuing at the recorded genID.
+ *
+ * Checkpoints are stored as small <tt>key = value</tt> files which are
+ * replaced atomically and synced to disk by store().
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class Checkpoint
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param begin The first genID of the task partition.
+     * @param end The genID past the end of the task partition.
+     */
+    Checkpoint(ID begin, ID end) :
+        begin(begin),
+        end(end),
+        next(begin),
+        offset(0)
+    {
+    }
+
+    /**
+     * Loads the checkpoint stored at the given \p path.
+     *
+     * @return False if the file does not exist, cannot be parsed or was
+     *         written for a different genID partition, in which case the
+     *         checkpoint is left unchanged.
+     */
+    bool load(const Path& path)
+    {
+        ifstream in(path.toString().c_str());
+
+        if (!in.good())
+        {
+	        return false;
+        }
+
+        ID values[4] = { 0, 0, 0, 0 };
+        const char* keys[4] = { "begin", "end", "next", "offset" };
+        bool found[4] = { false, false, false, false };
+
+        string line;
+        while (getline(in, line))
+        {
+	        size_t separator = line.find('=');
+	        if (separator == string::npos)
+	        {
+		        continue;
+	        }
+
+	        string key = trim(line.substr(0, separator));
+	        string value = trim(line.substr(separator + 1));
+
+	        for (size_t i = 0; i < 4; i++)
+	        {
+		        if (key == keys[i])
+		        {
+			        found[i] = NumberParser::tryParseUnsigned64(value, values[i]);
+		        }
+	        }
+        }
+
+        if (!found[0] || !found[1] || !found[2] || !found[3])
+        {
+	        return false;
+        }
+
+        if (values[0] != begin || values[1] != end || values[2] < begin || values[2] > end)
+        {
+	        return false;
+        }
+
+        next = values[2];
+        offset = values[3];
+
+        return true;
+    }
+
+    /**
+     * Atomically replaces the checkpoint at the given \p path.
+     *
+     * The checkpoint is written into a temporary file which is synced and
+     * then renamed to \p path. The enclosing directory is synced afterwards,
+     * so a stored checkpoint survives a node crash.
+     */
+    void store(const Path& path) const
+    {
+        const string target = path.toString();
+        const string temporary = target + ".tmp";
+
+        string content;
+        content += "begin = " + NumberFormatter::format(begin) + "\n";
+        content += "end = " + NumberFormatter::format(end) + "\n";
+        content += "next = " + NumberFormatter::format(next) + "\n";
+        content += "offset = " + NumberFormatter::format(offset) + "\n";
+
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+	        throw FileException(format("Cannot open checkpoint file `%s`: %s", temporary, string(strerror(errno))));
+        }
+
+        if (::write(fd, content.data(), content.size()) != static_cast<ssize_t>(content.size()) || ::fsync(fd) != 0)
+        {
+	        int error = errno;
+	        ::close(fd);
+	        throw FileException(format("Cannot write checkpoint file `%s`: %s", temporary, string(strerror(error))));
+        }
+
+        ::close(fd);
+
+        if (::rename(temporary.c_str(), target.c_str()) != 0)
+        {
+	        throw FileException(format("Cannot replace checkpoint file `%s`: %s", target, string(strerror(errno))));
+        }
+
+        sync(path.parent().toString());
+    }
+
+    /**
+     * Syncs the contents of the file or directory at the given \p path.
+     */
+    static void sync(const string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+	        ::fsync(fd);
+	        ::close(fd);
+        }
+    }
+
+    /**
+     * The first genID of the task partition.
+     */
+    ID begin;
+
+    /**
+     * The genID past the end of the task partition.
+     */
+    ID end;
+
+    /**
+     * The next genID to be generated.
+     */
+    ID next;
+
+    /**
+     * The length of the output written for the genIDs before \p next.
+     */
+    I64u offset;
+
+private:
+
+    static string trim(const string& s)
+    {
+        size_t first = s.find_first_not_of(" \t\r");
+        if (first == string::npos)
+        {
+	        return string();
+        }
+
+        size_t last = s.find_last_not_of(" \t\r");
+        return s.substr(first, last - first + 1);
+    }
+};
+
+/** @}*/// add to generator group
+} // namespace Myriad
+
+#endif /* CHECKPOINT_H_ */
@@ -18,6 +18,7 @@
 #ifndef RANDOMSEQUENCEGENERATOR_H_
 #define RANDOMSEQUENCEGENERATOR_H_
 
+#include "core/clock.h"
 #include "generator/InvalidRecordException.h"
 #include "generator/AbstractSequenceGenerator.h"
 #include "runtime/setter/SetterChain.h"
@@ -26,6 +27,7 @@
 #include <Poco/BasicEvent.h>
 #include <Poco/PriorityEvent.h>
 #include <Poco/PriorityDelegate.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -351,11 +353,11 @@ public:
      * Constructor.
      */
     PartitionedSequenceIteratorTask(RandomSequenceGenerator<RecordType>& generator, const GeneratorConfig& config, bool dryRun = false) :
-        StageTask<RecordType> (generator.name() + "::generate_records", generator.name(), config, dryRun),
+        StageTask<RecordType> (ProgressSlot::taskName(generator.name() + "::generate_records", config.nodeID()), generator.name(), config, dryRun, true),
         _generator(generator),
         _recordFactory(_generator.recordFactory()),
         _random(generator.random()),
-        _logger(Logger::get("task.random.default."+generator.name()))
+        _logger(Logger::get("task.random.default." + ProgressSlot::taskName(generator.name(), config.nodeID())))
     {
     }
 
@@ -374,6 +376,9 @@ public:
      *
      * This method simply iterates over the allocated genID subsequence and
      * instantiates and writes out the \p RecordType instance at each position.
+     * The iteration starts at the resumed checkpoint, if any, and regularly
+     * records new checkpoints. The setter chain and serialization times are
+     * measured for every ProgressSlot::TIMING_INTERVAL-th record.
      */
     void run()
     {
@@ -383,16 +388,25 @@ public:
         }
 
         I32u progressCounter = 0;
+        I64u records = 0;
+        I64u invalid = 0;
+        I64u setterNanos = 0;
+        I64u serializeNanos = 0;
 
         ID first = _generator.config().genIDBegin(_generator.name());
-        ID current = _generator.config().genIDBegin(_generator.name());
+        ID current = this->resumeGenID();
         ID last = _generator.config().genIDEnd(_generator.name());
 
+        this->_progress.start(last - first, current - first);
+
         _random.atChunk(current);
 
         RecordSetterChainType setterChain = _generator.setterChain(BaseSetterChain::SEQUENTIAL, _random);
         while (current < last)
         {
+	        const bool sampled = records % ProgressSlot::TIMING_INTERVAL == 0;
+	        const I64u start = sampled ? monotonicNanos() : 0;
+
 	        AutoPtr<RecordType> recordPtr = _recordFactory();
 	        recordPtr->genID(current);
 
@@ -405,16 +419,29 @@ public:
 		        current = e.nextValidGenID();
 		        _random.atChunk(current);
 
-	            if(progressCounter + e.invalidRangeSize() >= 1000)
-	            {
-	                progressCounter = 0;
-	                this->_progress = (current - first) / static_cast<Decimal>(last - first);
-	            }
+		        invalid += e.invalidRangeSize();
+		        this->_progress.invalid(invalid);
+		        this->_progress.update(records, min(current, last) - first);
 
 		        continue;
 	        }
 
-	        if (!this->_dryRun)
+	        if (sampled)
+	        {
+		        const I64u generated = monotonicNanos();
+		        const I64u writeNanos = this->_out->writeNanos();
+
+		        if (!this->_dryRun)
+		        {
+			        this->_out->collect(*recordPtr);
+		        }
+
+		        // the output write time is accounted separately
+		        setterNanos += (generated - start) * ProgressSlot::TIMING_INTERVAL;
+		        serializeNanos += (monotonicNanos() - generated - (this->_out->writeNanos() - writeNanos)) * ProgressSlot::TIMING_INTERVAL;
+		        this->_progress.timing(setterNanos, serializeNanos);
+	        }
+	        else if (!this->_dryRun)
 	        {
 		        this->_out->collect(*recordPtr);
 	        }
@@ -422,17 +449,24 @@ public:
 	        ++current;
 	        _random.nextChunk();
 
+	        this->_progress.update(++records, current - first);
+
 	        if(++progressCounter >= 1000)
 	        {
 		        progressCounter = 0;
-		        this->_progress = (current - first) / static_cast<Decimal>(last - first);
+		        this->_progress.output(this->_out->writtenBytes(), this->_out->writeNanos(), this->_out->queueDepth());
+		        this->checkpoint(current);
 	        }
         }
 
         // flush the output collector contents
         this->_out->flush();
+        this->_progress.output(this->_out->writtenBytes(), this->_out->writeNanos(), this->_out->queueDepth());
+
+        // record the completed partition
+        this->checkpoint(current, true);
 
-        this->_progress = 1.0;
+        this->_progress.finish();
 
         if (_logger.debug())
         {
@@ -19,14 +19,17 @@
 #define STAGETASK_H_
 
 #include "core/types.h"
-#include "communication/Notifications.h"
+#include "communication/ProgressRegistry.h"
+#include "generator/Checkpoint.h"
 #include "io/OutputCollector.h"
 #include "record/AbstractRecord.h"
 
+#include <Poco/File.h>
 #include <Poco/Logger.h>
 #include <Poco/Path.h>
 #include <Poco/Runnable.h>
 #include <Poco/RefCountedObject.h>
+#include <Poco/Timestamp.h>
 
 #include <string>
 
@@ -57,10 +60,18 @@ public:
      * Constructor.
      */
     AbstractStageTask(const string& name) :
-        _taskName(name), _progress(0)
+        _taskName(name), _progress(ProgressRegistry::defaultRegistry().acquire(name))
     {
     }
 
+    /**
+     * Destructor. Returns the progress counters to the ProgressRegistry.
+     */
+    virtual ~AbstractStageTask()
+    {
+        ProgressRegistry::defaultRegistry().release(_progress);
+    }
+
     /**
      * The name of this AbstractStageTask.
      */
@@ -69,6 +80,14 @@ public:
         return _taskName;
     }
 
+    /**
+     * The progress counters of this AbstractStageTask.
+     */
+    ProgressSlot& progress()
+    {
+        return _progress;
+    }
+
     /**
      * Indicates whether the task is runnable.
      *
@@ -87,12 +106,12 @@ public:
     }
 
     /**
-     * Updates the task progress in the given UpdateProgress \p notification.
+     * Moves the memory used by the task to the NUMA node of the calling
+     * thread. Invoked by the thread that runs the task after it has been
+     * bound to a node with NumaTopology::bind().
      */
-    void reportProgress(const AutoPtr<UpdateProgress>& notification)
+    virtual void localize()
     {
-        notification->state.taskCount++;
-        notification->state.taskProgress += _progress;
     }
 
 protected:
@@ -104,9 +123,10 @@ protected:
 
 
     /**
-     * Current progress.
+     * The progress counters of the task, which are read by the
+     * ProgressMonitor.
      */
-    Decimal _progress;
+    ProgressSlot& _progress;
 };
 
 /**
@@ -139,16 +159,39 @@ public:
      * @param config A reference to the global generator configuration.
      * @param dryRun A boolean flag indicating whether the output collector
      *               should be used or not (i.e. whether it is a dry run).
+     * @param checkpoints A boolean flag indicating whether the task records
+     *                    checkpoints of its genID partition and can be
+     *                    resumed from them (see checkpoint()).
      */
-    StageTask(const string& taskName, const string& generatorName, const GeneratorConfig& config, bool dryRun = false) :
+    StageTask(const string& taskName, const string& generatorName, const GeneratorConfig& config, bool dryRun = false, bool checkpoints = false) :
         AbstractStageTask(taskName),
-        _out(OutputCollector<RecordType>::factory(config.outputType(), config.outputPort(), config.outputPath(generatorName), "task." + taskName + ".collector")),
+        _out(OutputCollector<RecordType>::factory(config.outputPath(generatorName), "task." + taskName + ".collector", OutputOptions::fromConfig(config, generatorName))),
         _dryRun(dryRun),
+        _checkpoint(config.genIDBegin(generatorName), config.genIDEnd(generatorName)),
+        _checkpointPath(config.outputPath(generatorName).toString() + ".checkpoint"),
+        _checkpointInterval(checkpoints && !dryRun ? config.checkpointInterval() : 0),
         _logger(Logger::get("task." + taskName))
     {
         if (!_dryRun)
         {
-	        _out->open();
+	        if (checkpoints && config.resume() && _checkpoint.load(_checkpointPath) && _out->resume(_checkpoint.offset))
+	        {
+		        _logger.information(format("Resuming task `%s` at genID %Lu of [%Lu, %Lu)", taskName, _checkpoint.next, _checkpoint.begin, _checkpoint.end));
+	        }
+	        else
+	        {
+		        _checkpoint.next = _checkpoint.begin;
+		        _checkpoint.offset = 0;
+
+		        // discard checkpoints of earlier runs
+		        File checkpointFile(_checkpointPath);
+		        if (checkpoints && checkpointFile.exists())
+		        {
+			        checkpointFile.remove();
+		        }
+
+		        _out->open();
+	        }
         }
     }
 
@@ -165,8 +208,64 @@ public:
         }
     }
 
+    /**
+     * Moves the output buffers to the NUMA node of the calling thread.
+     */
+    void localize()
+    {
+        if (!_dryRun)
+        {
+	        _out->localize();
+        }
+    }
+
 protected:
 
+    /**
+     * Returns the genID at which the task should start. This is the next
+     * genID of the checkpoint the task was resumed from, or the begin of the
+     * task partition otherwise.
+     */
+    ID resumeGenID() const
+    {
+        return _checkpoint.next;
+    }
+
+    /**
+     * Records a checkpoint after all records before the \p next genID have
+     * been collected. Unless \p force is set, the checkpoint is skipped if
+     * the previous one is younger than the configured checkpoint interval.
+     * Checkpoints are turned off if the output collector does not support
+     * them.
+     */
+    void checkpoint(ID next, bool force = false)
+    {
+        if (_checkpointInterval == 0)
+        {
+	        return;
+        }
+
+        if (!force && !_checkpointTime.isElapsed(static_cast<Timestamp::TimeDiff>(_checkpointInterval) * Timestamp::resolution()))
+        {
+	        return;
+        }
+
+        I64u offset;
+
+        if (!_out->checkpoint(offset))
+        {
+	        _logger.warning(format("Output collector of task `%s` does not support checkpoints", name()));
+	        _checkpointInterval = 0;
+	        return;
+        }
+
+        _checkpoint.next = next;
+        _checkpoint.offset = offset;
+        _checkpoint.store(_checkpointPath);
+
+        _checkpointTime.update();
+    }
+
     /**
      * An output stream used for writing the task output data.
      */
@@ -177,6 +276,27 @@ protected:
      */
     bool _dryRun;
 
+    /**
+     * The last recorded (or resumed) checkpoint.
+     */
+    Checkpoint _checkpoint;
+
+    /**
+     * The location of the checkpoint file.
+     */
+    const Path _checkpointPath;
+
+    /**
+     * The minimal number of seconds between two checkpoints (0 if the task
+     * does not record checkpoints).
+     */
+    I32u _checkpointInterval;
+
+    /**
+     * The time at which the last checkpoint was recorded.
+     */
+    Timestamp _checkpointTime;
+
     /**
      * Logger instance.
      */
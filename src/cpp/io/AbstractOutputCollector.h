@@ -19,7 +19,11 @@
 #define ABSTRACTOUTPUTCOLLECTOR_H_
 
 #include "core/types.h"
+#include "io/ColumnarRowGroup.h"
+#include "io/Partitioning.h"
 
+#include <Poco/Exception.h>
+#include <Poco/MemoryStream.h>
 #include <Poco/Path.h>
 #include <Poco/RefCountedObject.h>
 
@@ -109,6 +113,69 @@ public:
      */
     virtual void collect(const RecordType& record) = 0;
 
+    /**
+     * Makes all records collected so far durable and returns the length of
+     * the output written for them in \p offset. Used by the stage tasks to
+     * record a Checkpoint.
+     *
+     * @return False if the collector does not support checkpoints.
+     */
+    virtual bool checkpoint(I64u& offset)
+    {
+        return false;
+    }
+
+    /**
+     * Opens the underlying output in order to continue after a Checkpoint.
+     * The existing output is truncated to the given \p offset and no header
+     * is written.
+     *
+     * @return False if the collector cannot resume the output at \p offset,
+     *         in which case it must be opened with open() instead.
+     */
+    virtual bool resume(I64u offset)
+    {
+        return false;
+    }
+
+    /**
+     * Returns the number of serialized bytes collected so far, or 0 if the
+     * collector does not keep track of it. Used for progress reporting.
+     */
+    virtual I64u writtenBytes() const
+    {
+        return 0;
+    }
+
+    /**
+     * Returns the number of nanoseconds spent waiting for the underlying
+     * output so far, or 0 if the collector does not keep track of it. Used
+     * to tell apart the serialization and the I/O time of the tasks.
+     */
+    virtual I64u writeNanos() const
+    {
+        return 0;
+    }
+
+    /**
+     * Returns the number of output blocks that have been handed over for
+     * writing but are not written yet (e.g. blocks waiting for compression
+     * or writes in flight).
+     */
+    virtual I64u queueDepth() const
+    {
+        return 0;
+    }
+
+    /**
+     * Moves the output buffers of the collector to the NUMA node of the
+     * calling thread. Invoked by the thread that collects the records after
+     * it has been bound to a node with NumaTopology::bind().
+     */
+    virtual void localize()
+    {
+    }
+
     /**
      * Record serialization method.
      *
@@ -123,6 +190,111 @@ public:
         out << "abstract record #" << record.genID() << "\n";
     }
 
+    /**
+     * Raw buffer record serialization method.
+     *
+     * Writes the generated \p record at the given \p cursor position if the
+     * serialized record fits into the <tt>[cursor, end)</tt> range and advances
+     * the \p cursor past the written bytes. The record compiler emits
+     * stream-free specializations of this method for the generated record
+     * types. The default implementation serializes the record through the
+     * <tt>std::ostream</tt> based serialize() method.
+     *
+     * @param cursor The buffer position at which the record is written.
+     * @param end The end of the available buffer range.
+     * @param record The record to be serialized on the output buffer.
+     * @return False if the serialized \p record does not fit into the range,
+     *         in which case the \p cursor is left unchanged.
+     */
+    static bool serialize(char*& cursor, char* end, const RecordType& record)
+    {
+        Poco::MemoryOutputStream out(cursor, static_cast<std::streamsize>(end - cursor));
+        AbstractOutputCollector<RecordType>::serialize(out, record);
+
+        if (!out.good())
+        {
+            return false;
+        }
+
+        cursor += out.charsWritten();
+        return true;
+    }
+
+    /**
+     * Columnar layout method.
+     *
+     * Adds the typed columns of the record's columnar output format to the
+     * given \p rowGroup. The record compiler emits specializations of this
+     * method for record types with a <tt>columnar</tt> output format.
+     *
+     * @param rowGroup The row group to be configured.
+     * @return False if the record type has no columnar output format.
+     */
+    static bool describe(ColumnarRowGroup& rowGroup)
+    {
+        return false;
+    }
+
+    /**
+     * Columnar record serialization method.
+     *
+     * Appends the fields of the generated \p record to the columns of the
+     * given \p rowGroup, which was configured with describe().
+     *
+     * @param rowGroup The row group holding the serialized records.
+     * @param record The record to be serialized into the row group.
+     */
+    static void serialize(ColumnarRowGroup& rowGroup, const RecordType& record)
+    {
+        throw Poco::NotImplementedException("Columnar serialization is not supported for this record type");
+    }
+
+    /**
+     * Partitioning field lookup method.
+     *
+     * Resolves the given field \p name to the field ID passed to
+     * partitionKey(). The record compiler emits specializations of this
+     * method for all generated record types that accept the names of all
+     * explicit non-vector fields.
+     *
+     * @param name The name of the partitioning field.
+     * @return The field ID, or zero if the field cannot be used for
+     *         partitioning.
+     */
+    static I32u partitionField(const String& name)
+    {
+        return 0;
+    }
+
+    /**
+     * Partition key order method.
+     *
+     * Returns the PartitionKey::ORDERED flag of the field with the given ID,
+     * i.e. whether the partition keys of the field preserve the value order
+     * and can be used for range partitioning.
+     *
+     * @param field A field ID obtained with partitionField().
+     * @return False if the field can only be used for hash partitioning.
+     */
+    static bool partitionOrdered(I32u field)
+    {
+        return false;
+    }
+
+    /**
+     * Partition key method.
+     *
+     * Returns the PartitionKey of the field with the given ID.
+     *
+     * @param record The record to be partitioned.
+     * @param field A field ID obtained with partitionField().
+     * @return The partition key of the \p record.
+     */
+    static I64 partitionKey(const RecordType& record, I32u field)
+    {
+        throw Poco::NotImplementedException("Partitioning is not supported for this record type");
+    }
+
 private:
 
     const String& _collectorName;
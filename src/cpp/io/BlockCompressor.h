@@ -0,0 +1,518 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef BLOCKCOMPRESSOR_H_
+#define BLOCKCOMPRESSOR_H_
+
+#include "core/types.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/DeflatingStream.h>
+#include <Poco/Event.h>
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/Notification.h>
+#include <Poco/NotificationQueue.h>
+#include <Poco/Runnable.h>
+#include <Poco/Thread.h>
+
+#if defined(MYRIAD_WITH_LZ4)
+#include <lz4frame.h>
+#endif
+
+#include <cstring>
+#include <deque>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The compression settings for file output collectors.
+ *
+ * The settings are bound to the 'application.output-compression',
+ * 'application.output-compression-level', and
+ * 'application.output-compression-threads' config parameters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct CompressionOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param codec The compression codec ('none', 'gzip' or 'lz4').
+     * @param level The compression level (0 to 9).
+     * @param threads The number of compression worker threads.
+     */
+    CompressionOptions(const String& codec = "none", int level = 6, size_t threads = 2) :
+        codec(codec),
+        level(level),
+        threads(threads)
+    {
+    }
+
+    /**
+     * Returns true if the output should be compressed.
+     */
+    bool enabled() const
+    {
+        return codec != "none";
+    }
+
+    /**
+     * Returns the file name extension of the compressed output, including
+     * the leading dot, or an empty string if the output is not compressed.
+     */
+    String extension() const
+    {
+        if (codec == "gzip")
+        {
+            return ".gz";
+        }
+        else if (enabled())
+        {
+            return "." + codec;
+        }
+        else
+        {
+            return "";
+        }
+    }
+
+    String codec; //!< The compression codec.
+    int level; //!< The compression level.
+    size_t threads; //!< The number of compression worker threads.
+};
+
+/**
+ * Compresses a stream of blocks on a small pool of worker threads and writes
+ * the compressed blocks in their original order.
+ *
+ * With the 'gzip' codec, each block is compressed into a self-contained gzip
+ * member. Concatenated gzip members form a valid gzip stream, so the output
+ * can be read by any gzip decoder (e.g. <tt>gunzip</tt> or <tt>zcat</tt>)
+ * without knowledge of the block boundaries.
+ *
+ * With the 'lz4' codec, each block is compressed into a self-contained LZ4
+ * frame, and the concatenated frames can be read with <tt>lz4 -dc</tt>.
+ * Levels below 3 select the fast LZ4 mode, higher levels select LZ4 HC. The
+ * codec is only available if the toolkit is built against the LZ4 library
+ * (see the <tt>--lz4-prefix</tt> option of the configure script).
+ *
+ * At most two blocks per worker are in flight at any point. If this limit is
+ * reached, compress() waits for the oldest block and writes it before handing
+ * over the next one, so the memory footprint does not depend on the output
+ * size. Block objects are recycled once written.
+ *
+ * Exceptions thrown while compressing a block are captured by the worker and
+ * rethrown by the thread that writes the block.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class BlockCompressor
+{
+public:
+
+    /**
+     * Constructor. Starts the worker threads.
+     *
+     * @param out The stream receiving the compressed blocks.
+     * @param options The compression settings.
+     */
+    BlockCompressor(std::ostream& out, const CompressionOptions& options) :
+        _out(out),
+        _codec(parseCodec(options.codec)),
+        _level(options.level),
+        _maxPending(2 * max<size_t>(options.threads, 1)),
+        _blockCount(0)
+    {
+        if (options.level < 0 || options.level > 9)
+        {
+            throw InvalidArgumentException(format("Invalid output compression level %d", options.level));
+        }
+
+        for (size_t i = 0; i < max<size_t>(options.threads, 1); i++)
+        {
+            _workers.push_back(new Worker(_queue));
+            _threads.push_back(new Thread());
+            _threads.back()->start(*_workers.back());
+        }
+    }
+
+    /**
+     * Destructor. Stops the worker threads without writing pending blocks.
+     */
+    ~BlockCompressor()
+    {
+        stop();
+    }
+
+    /**
+     * Hands a copy of the \p size bytes starting at \p data over to the
+     * worker threads.
+     */
+    void compress(const char* data, size_t size)
+    {
+        if (_pending.size() >= _maxPending)
+        {
+            writeFront();
+        }
+
+        AutoPtr<Block> block;
+        if (_free.empty())
+        {
+            block = new Block(_codec, _level);
+        }
+        else
+        {
+            block = _free.back();
+            _free.pop_back();
+        }
+
+        block->assign(data, size);
+        _pending.push_back(block);
+        _blockCount++;
+        _queue.enqueueNotification(block);
+    }
+
+    /**
+     * Waits for all pending blocks and writes them to the output stream.
+     */
+    void drain()
+    {
+        while (!_pending.empty())
+        {
+            writeFront();
+        }
+    }
+
+    /**
+     * Returns the number of blocks that are compressed or waiting to be
+     * written.
+     */
+    size_t pending() const
+    {
+        return _pending.size();
+    }
+
+    /**
+     * Writes all pending blocks and stops the worker threads. An empty
+     * stream is neither valid gzip nor valid LZ4, so an empty block is
+     * written if no block has been compressed so far.
+     */
+    void close()
+    {
+        if (_blockCount == 0)
+        {
+            compress("", 0);
+        }
+
+        drain();
+        stop();
+    }
+
+private:
+
+    /**
+     * The supported compression codecs.
+     */
+    enum Codec
+    {
+        GZIP, LZ4
+    };
+
+    /**
+     * Maps a codec name to a Codec value.
+     */
+    static Codec parseCodec(const String& codec)
+    {
+        if (codec == "gzip")
+        {
+            return GZIP;
+        }
+        else if (codec == "lz4")
+        {
+#if defined(MYRIAD_WITH_LZ4)
+            return LZ4;
+#else
+            throw InvalidArgumentException("Output compression codec `lz4` is not available, rebuild with the --lz4-prefix configure option");
+#endif
+        }
+        else
+        {
+            throw InvalidArgumentException(format("Unsupported output compression codec `%s`", codec));
+        }
+    }
+
+    /**
+     * A block of data compressed by a Worker.
+     */
+    class Block: public Notification
+    {
+    public:
+
+        Block(Codec codec, int level) :
+            _codec(codec),
+            _level(level),
+            _exception(NULL)
+        {
+        }
+
+        virtual ~Block()
+        {
+            reset();
+        }
+
+        void assign(const char* data, size_t size)
+        {
+            reset();
+            _input.assign(data, size);
+            _output.clear();
+        }
+
+        /**
+         * Compresses the input into a gzip member or an LZ4 frame. Invoked
+         * from a worker.
+         */
+        void compress()
+        {
+            try
+            {
+                if (_codec == GZIP)
+                {
+                    std::ostringstream out;
+                    DeflatingOutputStream deflater(out, DeflatingStreamBuf::STREAM_GZIP, _level);
+                    deflater.write(_input.data(), static_cast<std::streamsize>(_input.size()));
+                    deflater.close();
+                    _output = out.str();
+                }
+#if defined(MYRIAD_WITH_LZ4)
+                else
+                {
+                    LZ4F_preferences_t preferences;
+                    memset(&preferences, 0, sizeof(preferences));
+                    preferences.frameInfo.contentSize = _input.size();
+                    preferences.compressionLevel = _level < 3 ? 0 : _level;
+
+                    _output.resize(LZ4F_compressFrameBound(_input.size(), &preferences));
+                    size_t size = LZ4F_compressFrame(&_output[0], _output.size(), _input.data(), _input.size(), &preferences);
+                    if (LZ4F_isError(size))
+                    {
+                        throw IOException(format("Cannot compress output block: %s", string(LZ4F_getErrorName(size))));
+                    }
+                    _output.resize(size);
+                }
+#endif
+            }
+            catch(const Exception& e)
+            {
+                _exception = e.clone();
+            }
+            catch(const std::exception& e)
+            {
+                _exception = new RuntimeException(format("Cannot compress output block: %s", string(e.what())));
+            }
+            catch(...)
+            {
+                _exception = new RuntimeException("Cannot compress output block");
+            }
+
+            _done.set();
+        }
+
+        /**
+         * Waits until the block is compressed and writes it to \p out.
+         */
+        void write(std::ostream& out)
+        {
+            _done.wait();
+
+            if (_exception != NULL)
+            {
+                _exception->rethrow();
+            }
+
+            out.write(_output.data(), static_cast<std::streamsize>(_output.size()));
+        }
+
+    private:
+
+        void reset()
+        {
+            if (_exception != NULL)
+            {
+                delete _exception;
+                _exception = NULL;
+            }
+        }
+
+        const Codec _codec;
+
+        const int _level;
+
+        std::string _input;
+
+        std::string _output;
+
+        Event _done;
+
+        Exception* _exception;
+    };
+
+    /**
+     * A worker compressing the blocks dequeued from a shared queue. A
+     * notification that is not a Block stops the worker.
+     */
+    class Worker: public Runnable
+    {
+    public:
+
+        Worker(NotificationQueue& queue) :
+            _queue(queue)
+        {
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                AutoPtr<Notification> notification(_queue.waitDequeueNotification());
+                AutoPtr<Block> block = notification.cast<Block>();
+
+                if (block.isNull())
+                {
+                    break;
+                }
+
+                block->compress();
+            }
+        }
+
+    private:
+
+        NotificationQueue& _queue;
+    };
+
+    /**
+     * Noncopyable.
+     */
+    BlockCompressor(const BlockCompressor&);
+
+    /**
+     * Noncopyable.
+     */
+    BlockCompressor& operator=(const BlockCompressor&);
+
+    /**
+     * Writes the oldest pending block and recycles it.
+     */
+    void writeFront()
+    {
+        AutoPtr<Block> block = _pending.front();
+        _pending.pop_front();
+        block->write(_out);
+        _free.push_back(block);
+    }
+
+    /**
+     * Stops and joins the worker threads. Blocks that have not been written
+     * yet are still compressed but discarded.
+     */
+    void stop()
+    {
+        for (size_t i = 0; i < _threads.size(); i++)
+        {
+            _queue.enqueueNotification(new Notification());
+        }
+
+        for (size_t i = 0; i < _threads.size(); i++)
+        {
+            _threads[i]->join();
+            delete _threads[i];
+            delete _workers[i];
+        }
+
+        _threads.clear();
+        _workers.clear();
+        _pending.clear();
+    }
+
+    /**
+     * The stream receiving the compressed blocks.
+     */
+    std::ostream& _out;
+
+    /**
+     * The compression codec.
+     */
+    const Codec _codec;
+
+    /**
+     * The compression level.
+     */
+    const int _level;
+
+    /**
+     * The maximal number of blocks in flight.
+     */
+    const size_t _maxPending;
+
+    /**
+     * The number of blocks handed over to compress().
+     */
+    size_t _blockCount;
+
+    /**
+     * The queue of blocks waiting for a worker.
+     */
+    NotificationQueue _queue;
+
+    /**
+     * The blocks in flight in output order.
+     */
+    std::deque< AutoPtr<Block> > _pending;
+
+    /**
+     * The written blocks available for reuse.
+     */
+    std::vector< AutoPtr<Block> > _free;
+
+    /**
+     * The worker threads.
+     */
+    std::vector<Thread*> _threads;
+
+    /**
+     * The Runnable instances executed by the \p _threads.
+     */
+    std::vector<Worker*> _workers;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* BLOCKCOMPRESSOR_H_ */
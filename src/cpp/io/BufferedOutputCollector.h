@@ -0,0 +1,227 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BUFFEREDOUTPUTCOLLECTOR_H_
+#define BUFFEREDOUTPUTCOLLECTOR_H_
+
+#include "core/NumaTopology.h"
+#include "core/clock.h"
+#include "io/AbstractOutputCollector.h"
+
+#include <Poco/Buffer.h>
+
+#include <sstream>
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * An abstract base for output collectors that write serialized records as
+ * raw bytes.
+ *
+ * Records are serialized with the raw buffer serialize() method directly into
+ * a fixed-size output buffer. Full buffers are handed over to the writeBytes()
+ * method implemented by the concrete subclasses, so no stream machinery is
+ * involved in the per-record path. Records that do not fit into an empty
+ * buffer are serialized through a temporary <tt>std::ostream</tt> and written
+ * directly.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class BufferedOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    BufferedOutputCollector(const String& collectorName, size_t bufferSize) :
+        AbstractOutputCollector<RecordType>(collectorName),
+        _buffer(bufferSize),
+        _cursor(_buffer.begin()),
+        _flushedBytes(0),
+        _writeNanos(0)
+    {
+    }
+
+    /**
+     * Copy constructor. The copy starts with an empty buffer.
+     */
+    BufferedOutputCollector(const BufferedOutputCollector& o) :
+        AbstractOutputCollector<RecordType>(o),
+        _buffer(o._buffer.size()),
+        _cursor(_buffer.begin()),
+        _flushedBytes(0),
+        _writeNanos(0)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    virtual ~BufferedOutputCollector()
+    {
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        if (!BufferedOutputCollector<RecordType>::serialize(_cursor, _buffer.end(), record))
+        {
+            flushBuffer();
+
+            if (!BufferedOutputCollector<RecordType>::serialize(_cursor, _buffer.end(), record))
+            {
+                // the record does not fit into an empty buffer
+                std::ostringstream out;
+                BufferedOutputCollector<RecordType>::serialize(out, record);
+                const std::string s(out.str());
+                write(s.data(), s.size());
+            }
+        }
+    }
+
+    /**
+     * Returns the number of bytes handed over to writeBytes() so far plus
+     * the number of buffered bytes.
+     */
+    I64u writtenBytes() const
+    {
+        return _flushedBytes + bufferedBytes();
+    }
+
+    /**
+     * Returns the number of nanoseconds spent in writeBytes() so far.
+     */
+    I64u writeNanos() const
+    {
+        return _writeNanos;
+    }
+
+    /**
+     * Moves the output buffer to the NUMA node of the calling thread.
+     */
+    void localize()
+    {
+        NumaTopology::instance().migrate(_buffer.begin(), _buffer.size());
+    }
+
+protected:
+
+    /**
+     * Writes \p size bytes starting at \p data to the underlying output.
+     */
+    virtual void writeBytes(const char* data, size_t size) = 0;
+
+    /**
+     * Hands the buffered bytes over to writeBytes() and resets the buffer.
+     */
+    void flushBuffer()
+    {
+        if (_cursor != _buffer.begin())
+        {
+            write(_buffer.begin(), static_cast<size_t>(_cursor - _buffer.begin()));
+            _cursor = _buffer.begin();
+        }
+    }
+
+    /**
+     * Returns the number of bytes in the buffer that have not been handed
+     * over to writeBytes() yet.
+     */
+    size_t bufferedBytes() const
+    {
+        return static_cast<size_t>(_cursor - _buffer.begin());
+    }
+
+    /**
+     * Writes the output specific header to the underlying output.
+     */
+    void writeBufferedHeader()
+    {
+        std::ostringstream out;
+        AbstractOutputCollector<RecordType>::writeHeader(out);
+        writeBuffered(out.str());
+    }
+
+    /**
+     * Writes the output specific footer to the underlying output.
+     */
+    void writeBufferedFooter()
+    {
+        std::ostringstream out;
+        AbstractOutputCollector<RecordType>::writeFooter(out);
+        writeBuffered(out.str());
+    }
+
+private:
+
+    /**
+     * Hands \p size bytes starting at \p data over to writeBytes() and
+     * accounts for the written bytes and the time spent in the call.
+     */
+    void write(const char* data, size_t size)
+    {
+        const I64u start = monotonicNanos();
+        writeBytes(data, size);
+        _writeNanos += monotonicNanos() - start;
+        _flushedBytes += size;
+    }
+
+    /**
+     * Flushes the buffer followed by the non-empty string \p s.
+     */
+    void writeBuffered(const std::string& s)
+    {
+        flushBuffer();
+
+        if (!s.empty())
+        {
+            write(s.data(), s.size());
+        }
+    }
+
+    /**
+     * The output buffer.
+     */
+    Poco::Buffer<char> _buffer;
+
+    /**
+     * The current write position in the \p _buffer.
+     */
+    char* _cursor;
+
+    /**
+     * The number of bytes handed over to writeBytes().
+     */
+    I64u _flushedBytes;
+
+    /**
+     * The number of nanoseconds spent in writeBytes().
+     */
+    I64u _writeNanos;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* BUFFEREDOUTPUTCOLLECTOR_H_ */
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef COLUMNAROUTPUTCOLLECTOR_H_
+#define COLUMNAROUTPUTCOLLECTOR_H_
+
+#include "core/clock.h"
+#include "io/AbstractOutputCollector.h"
+#include "io/ColumnarRowGroup.h"
+
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Logger.h>
+
+#include <cstring>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * An AbstractOutputCollector subclass that writes the output into a binary
+ * columnar file in the local file system.
+ *
+ * Records are appended field by field to the typed column vectors of a
+ * ColumnarRowGroup. Whenever the row group is full, its column chunks are
+ * written one after another, so the generation does not pay for any text
+ * formatting. The file layout follows the Parquet row group structure, while
+ * the column chunks use the Apache Arrow buffer layout, so a consumer can map
+ * the file and use the value buffers in place:
+ *
+ * - <tt>char magic[8]</tt> (ColumnarWriter::MAGIC).
+ * - The column chunks of all row groups (see AbstractColumn::writeChunk()).
+ * - The footer, consisting of <tt>I32u version, I32u reserved,
+ *   I64u numberOfColumns</tt>, followed by a schema entry for each column
+ *   (<tt>I32u type, I32u encoding, I64u width, I64u nameLength</tt> and the
+ *   padded name bytes), the dictionaries of all DICTIONARY encoded columns in
+ *   column order, <tt>I64u numberOfRowGroups</tt> and an index entry for each
+ *   row group (<tt>I64u numberOfRows</tt> and an <tt>I64u offset, I64u size</tt>
+ *   pair for each column chunk).
+ * - <tt>I64u footerOffset</tt> and the <tt>char magic[8]</tt> again.
+ *
+ * All values are little-endian and all sections are aligned at 8 bytes.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class ColumnarOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * Opens an output stream in a file given by the value of the given
+     * \p outputPath parameter.
+     */
+    ColumnarOutputCollector(const Path& outputPath, const String& collectorName) :
+        AbstractOutputCollector<RecordType>(collectorName),
+        _outputPath(outputPath),
+        _writer(_outputStream),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+        ColumnarOutputCollector<RecordType>::describe(_rowGroup);
+        _rowGroup.reserve();
+    }
+
+    /**
+     * Copy constructor.
+     */
+    ColumnarOutputCollector(const ColumnarOutputCollector& o) :
+        AbstractOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _writer(_outputStream),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        ColumnarOutputCollector<RecordType>::describe(_rowGroup);
+        _rowGroup.reserve();
+
+        if (o._isOpen)
+        {
+            open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the internal FileOutputStream instance if opened.
+     */
+    virtual ~ColumnarOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Opens the internal FileOutputStream instance and writes the file magic.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening columnar file for output path `%s`", _outputPath.toString()));
+
+            // make sure that the output-dir exists
+            File outputDir(_outputPath.parent());
+            outputDir.createDirectories();
+
+            _outputStream.open(_outputPath.toString(), std::ios::trunc | std::ios::binary);
+            _writer.write(ColumnarWriter::MAGIC, std::strlen(ColumnarWriter::MAGIC));
+            _isOpen = true;
+        }
+        else
+        {
+            throw LogicException(format("Can't open already opened columnar file at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Writes the last row group and the footer and closes the internal
+     * FileOutputStream instance.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+            _logger.debug(format("Closing columnar file for output path `%s`", _outputPath.toString()));
+
+            writeRowGroup();
+            writeFooter();
+            _outputStream.flush();
+            _outputStream.close();
+            _isOpen = false;
+        }
+    }
+
+    /**
+     * Flushes the internal FileOutputStream instance. Rows of the current
+     * (incomplete) row group are not written before close().
+     */
+    void flush()
+    {
+        if (_isOpen)
+        {
+            const I64u start = monotonicNanos();
+            _outputStream.flush();
+            _writeNanos += monotonicNanos() - start;
+        }
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        ColumnarOutputCollector<RecordType>::serialize(_rowGroup, record);
+
+        if (_rowGroup.full())
+        {
+            writeRowGroup();
+        }
+    }
+
+    /**
+     * Returns the number of bytes written to the output file so far. Rows of
+     * the current row group are not included before it is written.
+     */
+    I64u writtenBytes() const
+    {
+        return _writer.offset();
+    }
+
+    /**
+     * Returns the number of nanoseconds spent in writing row groups so far.
+     */
+    I64u writeNanos() const
+    {
+        return _writeNanos;
+    }
+
+private:
+
+    /**
+     * The location of a column chunk in the output file.
+     */
+    struct ChunkLocation
+    {
+        I64u offset;
+        I64u size;
+    };
+
+    /**
+     * Writes the column chunks of the current row group and clears it.
+     */
+    void writeRowGroup()
+    {
+        if (_rowGroup.size() == 0)
+        {
+            return;
+        }
+
+        const vector<AbstractColumn*>& columns = _rowGroup.columns();
+        const I64u start = monotonicNanos();
+
+        _rowGroupSizes.push_back(static_cast<I64u>(_rowGroup.size()));
+
+        for (vector<AbstractColumn*>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+        {
+            ChunkLocation location;
+            location.offset = _writer.offset();
+            (*it)->writeChunk(_writer);
+            location.size = _writer.offset() - location.offset;
+            _chunkLocations.push_back(location);
+        }
+
+        _rowGroup.clear();
+        _writeNanos += monotonicNanos() - start;
+    }
+
+    /**
+     * Writes the schema, the dictionaries and the row group index.
+     */
+    void writeFooter()
+    {
+        const vector<AbstractColumn*>& columns = _rowGroup.columns();
+        const I64u footerOffset = _writer.offset();
+
+        _writer.write(static_cast<I32u>(ColumnarWriter::VERSION));
+        _writer.write(static_cast<I32u>(0));
+        _writer.write(static_cast<I64u>(columns.size()));
+
+        for (vector<AbstractColumn*>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+        {
+            _writer.write(static_cast<I32u>((*it)->type()));
+            _writer.write(static_cast<I32u>((*it)->encoding()));
+            _writer.write(static_cast<I64u>((*it)->width()));
+            _writer.write(static_cast<I64u>((*it)->name().size()));
+            _writer.write((*it)->name().data(), (*it)->name().size());
+            _writer.pad();
+        }
+
+        for (vector<AbstractColumn*>::const_iterator it = columns.begin(); it != columns.end(); ++it)
+        {
+            if ((*it)->encoding() == AbstractColumn::DICTIONARY)
+            {
+                (*it)->writeDictionary(_writer);
+            }
+        }
+
+        _writer.write(static_cast<I64u>(_rowGroupSizes.size()));
+
+        for (size_t i = 0; i < _rowGroupSizes.size(); i++)
+        {
+            _writer.write(_rowGroupSizes[i]);
+
+            for (size_t j = 0; j < columns.size(); j++)
+            {
+                _writer.write(_chunkLocations[i * columns.size() + j]);
+            }
+        }
+
+        _writer.write(footerOffset);
+        _writer.write(ColumnarWriter::MAGIC, std::strlen(ColumnarWriter::MAGIC));
+    }
+
+    /**
+     * The path of the underlying OutputStream.
+     */
+    const Path _outputPath;
+
+    /**
+     * The underlying output stream.
+     */
+    FileOutputStream _outputStream;
+
+    /**
+     * An offset tracking writer for the \p _outputStream.
+     */
+    ColumnarWriter _writer;
+
+    /**
+     * The current row group.
+     */
+    ColumnarRowGroup _rowGroup;
+
+    /**
+     * The number of rows in each written row group.
+     */
+    vector<I64u> _rowGroupSizes;
+
+    /**
+     * The column chunk locations of all written row groups.
+     */
+    vector<ChunkLocation> _chunkLocations;
+
+    /**
+     * The number of nanoseconds spent in writing row groups.
+     */
+    I64u _writeNanos;
+
+    /**
+     * A boolean flag indicating that the underlying \p _outputStream is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* COLUMNAROUTPUTCOLLECTOR_H_ */
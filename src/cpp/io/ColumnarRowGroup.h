@@ -0,0 +1,844 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef COLUMNARROWGROUP_H_
+#define COLUMNARROWGROUP_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+
+#include <ostream>
+#include <vector>
+
+// the columnar format is written in the native byte order without swapping
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The columnar output format is only supported on little-endian hosts"
+#endif
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * A binary output stream wrapper that keeps track of the current output
+ * offset and supports padding to the 8-byte alignment of the columnar output
+ * format.
+ *
+ * All values are written in the native byte order, so the writer is only
+ * supported on little-endian hosts.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ColumnarWriter
+{
+public:
+
+    /**
+     * The magic bytes at the beginning and at the end of each columnar file.
+     */
+    static const char* MAGIC;
+
+    /**
+     * The format version written by the ColumnarOutputCollector.
+     */
+    static const I32u VERSION = 1;
+
+    /**
+     * Constructor.
+     */
+    ColumnarWriter(std::ostream& out) :
+        _out(out),
+        _offset(0)
+    {
+    }
+
+    /**
+     * Returns the number of bytes written so far.
+     */
+    I64u offset() const
+    {
+        return _offset;
+    }
+
+    /**
+     * Writes \p size bytes starting at \p data.
+     */
+    void write(const void* data, size_t size)
+    {
+        _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        _offset += size;
+    }
+
+    /**
+     * Writes the raw bytes of a single \p value.
+     */
+    template<typename T> void write(const T& value)
+    {
+        write(&value, sizeof(T));
+    }
+
+    /**
+     * Writes the \p values vector as a contiguous block followed by padding.
+     */
+    template<typename T> void writeBlock(const vector<T>& values)
+    {
+        if (!values.empty())
+        {
+            write(&values[0], values.size() * sizeof(T));
+        }
+        pad();
+    }
+
+    /**
+     * Writes zero bytes until the offset is 8-byte aligned.
+     */
+    void pad()
+    {
+        static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        if (_offset % 8 != 0)
+        {
+            write(zeros, 8 - static_cast<size_t>(_offset % 8));
+        }
+    }
+
+private:
+
+    std::ostream& _out;
+
+    I64u _offset;
+};
+
+/**
+ * An abstract base for the typed column vectors of a ColumnarRowGroup.
+ *
+ * A column holds \p width values per row - one for scalar fields and the
+ * vector size for vector fields. Each value has a validity bit in an
+ * LSB-first bitmap (as in Apache Arrow), so \c NULL values take no space in
+ * the value buffers besides a zeroed slot.
+ *
+ * A column chunk (the column contents for one row group) is written as
+ * <tt>I64u count, I64u nullCount</tt>, followed by the validity bitmap (only
+ * if <tt>nullCount > 0</tt>) and the encoding specific value buffers. Each
+ * buffer is padded to 8 bytes.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class AbstractColumn
+{
+public:
+
+    /**
+     * The physical value type of the column.
+     */
+    enum ValueType
+    {
+        BOOL = 1, //!< One byte per value (0 or 1).
+        CHAR = 2, //!< One byte per value.
+        INT16 = 3, //!< Signed 16-bit integers.
+        INT32 = 4, //!< Signed 32-bit integers.
+        INT64 = 5, //!< Signed 64-bit integers.
+        UINT16 = 6, //!< Unsigned 16-bit integers.
+        UINT32 = 7, //!< Unsigned 32-bit integers.
+        UINT64 = 8, //!< Unsigned 64-bit integers.
+        DECIMAL = 9, //!< 64-bit floating point numbers.
+        DATE = 10, //!< Signed 32-bit proleptic Gregorian ordinals (0001-01-01 is day 1).
+        STRING = 11 //!< Variable-length byte strings.
+    };
+
+    /**
+     * The encoding of the column values.
+     */
+    enum Encoding
+    {
+        PLAIN = 0, //!< Fixed-width values, or I64u offsets and a byte pool for strings.
+        DICTIONARY = 1 //!< I32u indexes into a per-column STRING dictionary.
+    };
+
+    /**
+     * Constructor.
+     */
+    AbstractColumn(const String& name, ValueType type, Encoding encoding, size_t width) :
+        _name(name),
+        _type(type),
+        _encoding(encoding),
+        _width(width),
+        _size(0),
+        _nullCount(0)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractColumn()
+    {
+    }
+
+    /**
+     * Returns the column name.
+     */
+    const String& name() const
+    {
+        return _name;
+    }
+
+    /**
+     * Returns the physical value type of the column.
+     */
+    ValueType type() const
+    {
+        return _type;
+    }
+
+    /**
+     * Returns the encoding of the column values.
+     */
+    Encoding encoding() const
+    {
+        return _encoding;
+    }
+
+    /**
+     * Returns the number of values per row.
+     */
+    size_t width() const
+    {
+        return _width;
+    }
+
+    /**
+     * Returns the number of values in the column.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Reserves memory for \p rows rows.
+     */
+    void reserve(size_t rows)
+    {
+        _validity.reserve((rows * _width + 7) / 8);
+        reserveValues(rows * _width);
+    }
+
+    /**
+     * Removes all values but keeps the allocated memory and the dictionary.
+     */
+    void clear()
+    {
+        _validity.clear();
+        _size = 0;
+        _nullCount = 0;
+        clearValues();
+    }
+
+    /**
+     * Writes the column chunk for the current row group.
+     */
+    void writeChunk(ColumnarWriter& out) const
+    {
+        out.write(static_cast<I64u>(_size));
+        out.write(static_cast<I64u>(_nullCount));
+
+        if (_nullCount > 0)
+        {
+            out.writeBlock(_validity);
+        }
+
+        writeValues(out);
+    }
+
+    /**
+     * Writes the column dictionary (for DICTIONARY encoded columns only).
+     */
+    virtual void writeDictionary(ColumnarWriter& out) const
+    {
+    }
+
+protected:
+
+    /**
+     * Appends the validity bit for the next value.
+     */
+    void appendValidity(bool valid)
+    {
+        if (_size % 8 == 0)
+        {
+            _validity.push_back(0);
+        }
+
+        if (valid)
+        {
+            _validity.back() |= static_cast<Poco::UInt8>(1 << (_size % 8));
+        }
+        else
+        {
+            _nullCount++;
+        }
+
+        _size++;
+    }
+
+    /**
+     * Checks that a vector value has exactly width() elements.
+     */
+    void checkWidth(size_t size) const
+    {
+        if (size != _width)
+        {
+            throw Poco::RangeException(Poco::format("Unexpected number of values %z for column `%s` (expected %z)", size, _name, _width));
+        }
+    }
+
+    /**
+     * Reserves memory for \p n values in the value buffers.
+     */
+    virtual void reserveValues(size_t n) = 0;
+
+    /**
+     * Removes all values from the value buffers.
+     */
+    virtual void clearValues() = 0;
+
+    /**
+     * Writes the value buffers.
+     */
+    virtual void writeValues(ColumnarWriter& out) const = 0;
+
+private:
+
+    const String _name;
+
+    const ValueType _type;
+
+    const Encoding _encoding;
+
+    const size_t _width;
+
+    size_t _size;
+
+    size_t _nullCount;
+
+    vector<Poco::UInt8> _validity;
+};
+
+/**
+ * A common base for ColumnTraits specializations of value types that are
+ * stored as they are.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename T, AbstractColumn::ValueType valueType> struct DirectColumnTraits
+{
+    typedef T StorageType;
+    static const AbstractColumn::ValueType TYPE = valueType;
+
+    static StorageType store(const T& value)
+    {
+        return value;
+    }
+
+    static bool isNull(const T& value)
+    {
+        return value == nullValue<T>();
+    }
+};
+
+/**
+ * A traits template that maps Myriad value types to the physical column
+ * value types. Specialized for all non-String core types.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename T> struct ColumnTraits;
+
+template<> struct ColumnTraits<Char> : public DirectColumnTraits<Char, AbstractColumn::CHAR> {};
+template<> struct ColumnTraits<I16> : public DirectColumnTraits<I16, AbstractColumn::INT16> {};
+template<> struct ColumnTraits<I32> : public DirectColumnTraits<I32, AbstractColumn::INT32> {};
+template<> struct ColumnTraits<I64> : public DirectColumnTraits<I64, AbstractColumn::INT64> {};
+template<> struct ColumnTraits<I16u> : public DirectColumnTraits<I16u, AbstractColumn::UINT16> {};
+template<> struct ColumnTraits<I32u> : public DirectColumnTraits<I32u, AbstractColumn::UINT32> {};
+template<> struct ColumnTraits<I64u> : public DirectColumnTraits<I64u, AbstractColumn::UINT64> {};
+template<> struct ColumnTraits<Decimal> : public DirectColumnTraits<Decimal, AbstractColumn::DECIMAL> {};
+
+/**
+ * Bool specialization of the ColumnTraits template. Bool values are stored
+ * as single bytes and are never \c NULL.
+ */
+template<> struct ColumnTraits<Bool>
+{
+    typedef Poco::UInt8 StorageType;
+    static const AbstractColumn::ValueType TYPE = AbstractColumn::BOOL;
+
+    static StorageType store(const Bool& value)
+    {
+        return value ? 1 : 0;
+    }
+
+    static bool isNull(const Bool& value)
+    {
+        return false;
+    }
+};
+
+/**
+ * Date specialization of the ColumnTraits template. Dates are stored as their
+ * 32-bit day numbers.
+ */
+template<> struct ColumnTraits<Date>
+{
+    typedef Poco::Int32 StorageType;
+    static const AbstractColumn::ValueType TYPE = AbstractColumn::DATE;
+
+    static StorageType store(const Date& value)
+    {
+        return value.dayNumber();
+    }
+
+    static bool isNull(const Date& value)
+    {
+        return value == nullValue<Date>();
+    }
+};
+
+/**
+ * A PLAIN encoded column of fixed-width values.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename T>
+class PlainColumn: public AbstractColumn
+{
+public:
+
+    typedef typename ColumnTraits<T>::StorageType StorageType;
+
+    /**
+     * Constructor.
+     */
+    PlainColumn(const String& name, size_t width = 1) :
+        AbstractColumn(name, ColumnTraits<T>::TYPE, PLAIN, width)
+    {
+    }
+
+    /**
+     * Appends a single \p value.
+     */
+    void append(const T& value)
+    {
+        const bool valid = !ColumnTraits<T>::isNull(value);
+        appendValidity(valid);
+        _values.push_back(valid ? ColumnTraits<T>::store(value) : StorageType());
+    }
+
+    /**
+     * Appends the elements of a vector field \p value.
+     */
+    void append(const vector<T>& value)
+    {
+        checkWidth(value.size());
+
+        for (typename vector<T>::const_iterator it = value.begin(); it != value.end(); ++it)
+        {
+            append(*it);
+        }
+    }
+
+protected:
+
+    virtual void reserveValues(size_t n)
+    {
+        _values.reserve(n);
+    }
+
+    virtual void clearValues()
+    {
+        _values.clear();
+    }
+
+    virtual void writeValues(ColumnarWriter& out) const
+    {
+        out.writeBlock(_values);
+    }
+
+private:
+
+    vector<StorageType> _values;
+};
+
+/**
+ * A PLAIN encoded String column. The values are stored as <tt>count + 1</tt>
+ * I64u offsets into a byte pool.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class StringColumn: public AbstractColumn
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    StringColumn(const String& name, size_t width = 1) :
+        AbstractColumn(name, STRING, PLAIN, width)
+    {
+        _offsets.push_back(0);
+    }
+
+    /**
+     * Appends a single \p value.
+     */
+    void append(const String& value)
+    {
+        const bool valid = value != nullValue<String>();
+        appendValidity(valid);
+
+        if (valid)
+        {
+            _bytes.insert(_bytes.end(), value.begin(), value.end());
+        }
+
+        _offsets.push_back(static_cast<I64u>(_bytes.size()));
+    }
+
+    /**
+     * Appends the elements of a vector field \p value.
+     */
+    void append(const vector<String>& value)
+    {
+        checkWidth(value.size());
+
+        for (vector<String>::const_iterator it = value.begin(); it != value.end(); ++it)
+        {
+            append(*it);
+        }
+    }
+
+protected:
+
+    virtual void reserveValues(size_t n)
+    {
+        _offsets.reserve(n + 1);
+    }
+
+    virtual void clearValues()
+    {
+        _offsets.resize(1);
+        _bytes.clear();
+    }
+
+    virtual void writeValues(ColumnarWriter& out) const
+    {
+        out.writeBlock(_offsets);
+        out.writeBlock(_bytes);
+    }
+
+private:
+
+    vector<I64u> _offsets;
+
+    vector<char> _bytes;
+};
+
+/**
+ * A DICTIONARY encoded Enum column.
+ *
+ * The values are stored as I32u indexes into the enum set of the field. The
+ * dictionary collects the plain enum values seen by the column and is written
+ * once for all row groups as <tt>I64u size</tt>, followed by a validity bitmap
+ * of the seen entries and the entries in the StringColumn value layout.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class DictionaryColumn: public AbstractColumn
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    DictionaryColumn(const String& name, size_t width = 1) :
+        AbstractColumn(name, STRING, DICTIONARY, width)
+    {
+    }
+
+    /**
+     * Appends the enum \p value with the given \p plain rendering (see
+     * MyriadEnumSet::bytes()).
+     */
+    void append(const Enum& value, const MyriadEnumSet::Bytes& plain)
+    {
+        if (value == nullValue<Enum>())
+        {
+            appendValidity(false);
+            _values.push_back(0);
+            return;
+        }
+
+        if (value >= _dictionary.size() || !_known[value])
+        {
+            learn(value, String(plain.data, plain.size));
+        }
+
+        appendValidity(true);
+        _values.push_back(static_cast<I32u>(value));
+    }
+
+    /**
+     * Appends the enum \p value with the given \p plain string value (see the
+     * generated <tt>xxxEnumValue(i)</tt> record accessors).
+     */
+    void append(const Enum& value, const String& plain)
+    {
+        if (value == nullValue<Enum>())
+        {
+            appendValidity(false);
+            _values.push_back(0);
+            return;
+        }
+
+        if (value >= _dictionary.size() || !_known[value])
+        {
+            learn(value, plain);
+        }
+
+        appendValidity(true);
+        _values.push_back(static_cast<I32u>(value));
+    }
+
+    virtual void writeDictionary(ColumnarWriter& out) const
+    {
+        vector<Poco::UInt8> known((_dictionary.size() + 7) / 8, 0);
+        vector<I64u> offsets(1, 0);
+        vector<char> bytes;
+
+        for (size_t i = 0; i < _dictionary.size(); i++)
+        {
+            if (_known[i])
+            {
+                known[i / 8] |= static_cast<Poco::UInt8>(1 << (i % 8));
+                bytes.insert(bytes.end(), _dictionary[i].begin(), _dictionary[i].end());
+            }
+            offsets.push_back(static_cast<I64u>(bytes.size()));
+        }
+
+        out.write(static_cast<I64u>(_dictionary.size()));
+        out.writeBlock(known);
+        out.writeBlock(offsets);
+        out.writeBlock(bytes);
+    }
+
+protected:
+
+    virtual void reserveValues(size_t n)
+    {
+        _values.reserve(n);
+    }
+
+    virtual void clearValues()
+    {
+        _values.clear();
+    }
+
+    virtual void writeValues(ColumnarWriter& out) const
+    {
+        out.writeBlock(_values);
+    }
+
+private:
+
+    /**
+     * Adds the \p plain value of the enum \p value to the dictionary.
+     */
+    void learn(const Enum& value, const String& plain)
+    {
+        if (value > static_cast<Enum>(std::numeric_limits<I32u>::max() - 1))
+        {
+            throw Poco::RangeException(Poco::format("Enum value %z of column `%s` exceeds the dictionary index range", static_cast<size_t>(value), name()));
+        }
+
+        if (value >= _dictionary.size())
+        {
+            _dictionary.resize(value + 1);
+            _known.resize(value + 1, false);
+        }
+
+        _dictionary[value] = plain;
+        _known[value] = true;
+    }
+
+    vector<I32u> _values;
+
+    vector<String> _dictionary;
+
+    vector<bool> _known;
+};
+
+/**
+ * A set of typed column vectors holding up to capacity() rows.
+ *
+ * The column layout of a record type is defined by the generated
+ * <tt>AbstractOutputCollector<RecordType>::describe()</tt> specialization and
+ * the rows are appended by the generated
+ * <tt>AbstractOutputCollector<RecordType>::serialize(ColumnarRowGroup&, const RecordType&)</tt>
+ * specialization.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ColumnarRowGroup
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    ColumnarRowGroup() :
+        _capacity(65536),
+        _size(0)
+    {
+    }
+
+    /**
+     * Destructor.
+     */
+    ~ColumnarRowGroup()
+    {
+        for (vector<AbstractColumn*>::iterator it = _columns.begin(); it != _columns.end(); ++it)
+        {
+            delete *it;
+        }
+    }
+
+    /**
+     * Adds a new \p column to the row group. The row group takes ownership
+     * of the \p column.
+     */
+    template<class ColumnType> ColumnType& add(ColumnType* column)
+    {
+        _columns.push_back(column);
+        return *column;
+    }
+
+    /**
+     * Returns the column at position \p i.
+     */
+    template<class ColumnType> ColumnType& column(size_t i)
+    {
+        return *static_cast<ColumnType*>(_columns[i]);
+    }
+
+    /**
+     * Returns all columns in the row group.
+     */
+    const vector<AbstractColumn*>& columns() const
+    {
+        return _columns;
+    }
+
+    /**
+     * Returns the maximal number of rows in the row group.
+     */
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    /**
+     * Sets the maximal number of rows in the row group.
+     */
+    void capacity(size_t capacity)
+    {
+        _capacity = capacity > 0 ? capacity : 1;
+    }
+
+    /**
+     * Reserves the column memory for capacity() rows.
+     */
+    void reserve()
+    {
+        for (vector<AbstractColumn*>::iterator it = _columns.begin(); it != _columns.end(); ++it)
+        {
+            (*it)->reserve(_capacity);
+        }
+    }
+
+    /**
+     * Completes a row after all column values have been appended.
+     */
+    void commitRow()
+    {
+        _size++;
+    }
+
+    /**
+     * Returns the number of rows in the row group.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Returns true if the row group contains capacity() rows.
+     */
+    bool full() const
+    {
+        return _size >= _capacity;
+    }
+
+    /**
+     * Removes all rows from the row group.
+     */
+    void clear()
+    {
+        for (vector<AbstractColumn*>::iterator it = _columns.begin(); it != _columns.end(); ++it)
+        {
+            (*it)->clear();
+        }
+
+        _size = 0;
+    }
+
+private:
+
+    /**
+     * Noncopyable.
+     */
+    ColumnarRowGroup(const ColumnarRowGroup&);
+
+    /**
+     * Noncopyable.
+     */
+    ColumnarRowGroup& operator=(const ColumnarRowGroup&);
+
+    vector<AbstractColumn*> _columns;
+
+    size_t _capacity;
+
+    size_t _size;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* COLUMNARROWGROUP_H_ */
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef COMPRESSEDFILEOUTPUTCOLLECTOR_H_
+#define COMPRESSEDFILEOUTPUTCOLLECTOR_H_
+
+#include "io/BlockCompressor.h"
+#include "io/BufferedOutputCollector.h"
+
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Logger.h>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * An AbstractOutputCollector subclass that writes compressed output into the
+ * local file system.
+ *
+ * Records are serialized into a buffer (1MB by default). Each full buffer is
+ * compressed as an independent block by a BlockCompressor, so compression
+ * runs on a small worker pool in parallel with the record generation. The compressed blocks
+ * are written in order as concatenated gzip members (or LZ4 frames), and the
+ * resulting file at <tt>${outputPath}.gz</tt> (or <tt>${outputPath}.lz4</tt>)
+ * is a regular gzip (or LZ4) file.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class CompressedFileOutputCollector: public BufferedOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * The output is written to the \p outputPath with the additional
+     * extension of the compression codec (e.g. '.gz').
+     */
+    CompressedFileOutputCollector(const Path& outputPath, const CompressionOptions& options, const String& collectorName, size_t bufferSize = 1048576) :
+        BufferedOutputCollector<RecordType>(collectorName, bufferSize),
+        _outputPath(outputPath.toString() + options.extension()),
+        _options(options),
+        _compressor(NULL),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    CompressedFileOutputCollector(const CompressedFileOutputCollector& o) :
+        BufferedOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _options(o._options),
+        _compressor(NULL),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the internal FileOutputStream instance if opened.
+     */
+    virtual ~CompressedFileOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Opens the internal FileOutputStream instance and starts the
+     * compression workers.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening compressed local file for output path `%s`", _outputPath.toString()));
+
+	        // make sure that the output-dir exists
+	        File outputDir(_outputPath.parent());
+            outputDir.createDirectories();
+
+	        _outputStream.open(_outputPath.toString(), std::ios::trunc | std::ios::binary);
+	        _compressor = new BlockCompressor(_outputStream, _options);
+	        _isOpen = true;
+
+	        BufferedOutputCollector<RecordType>::writeBufferedHeader();
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened local file at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Compresses the remaining output and closes the internal
+     * FileOutputStream instance.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing compressed local file for output path `%s`", _outputPath.toString()));
+
+	        BufferedOutputCollector<RecordType>::writeBufferedFooter();
+
+	        _compressor->close();
+	        delete _compressor;
+	        _compressor = NULL;
+
+	        _outputStream.close();
+	        _isOpen = false;
+        }
+    }
+
+    /**
+     * Compresses and writes the buffered records and flushes the internal
+     * FileOutputStream instance.
+     */
+    void flush()
+    {
+        if (_isOpen)
+        {
+            BufferedOutputCollector<RecordType>::flushBuffer();
+            _compressor->drain();
+            _outputStream.flush();
+        }
+    }
+
+    /**
+     * Returns the number of blocks that are compressed or waiting to be
+     * written.
+     */
+    I64u queueDepth() const
+    {
+        return _compressor != NULL ? _compressor->pending() : 0;
+    }
+
+protected:
+
+    /**
+     * Hands a block of serialized records over to the compressor.
+     */
+    void writeBytes(const char* data, size_t size)
+    {
+        _compressor->compress(data, size);
+    }
+
+private:
+
+    /**
+     * The path of the underlying OutputStream.
+     */
+    const Path _outputPath;
+
+    /**
+     * The compression settings.
+     */
+    const CompressionOptions _options;
+
+    /**
+     * The underlying output stream.
+     */
+    FileOutputStream _outputStream;
+
+    /**
+     * The compressor writing to the \p _outputStream while the file is open.
+     */
+    BlockCompressor* _compressor;
+
+    /**
+     * A boolean flag indicating that the underlying \p _outputStream is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* COMPRESSEDFILEOUTPUTCOLLECTOR_H_ */
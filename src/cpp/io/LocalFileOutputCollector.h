@@ -18,7 +18,7 @@
 #ifndef LOCALFILEOUTPUTCOLLECTOR_H_
 #define LOCALFILEOUTPUTCOLLECTOR_H_
 
-#include "io/AbstractOutputCollector.h"
+#include "io/BufferedOutputCollector.h"
 
 #include <Poco/File.h>
 #include <Poco/FileStream.h>
@@ -26,6 +26,9 @@
 #include <Poco/NumberFormatter.h>
 #include <Poco/StreamCopier.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 using namespace Poco;
 
 namespace Myriad {
@@ -38,12 +41,13 @@ namespace Myriad {
  * file system.
  *
  * This output collector works with local filesystem output streams and is the
- * default one for all data generator applications.
+ * default one for all data generator applications. Records are serialized into
+ * a buffer (1MB by default) which is written to the file whenever it fills up.
  *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 template<typename RecordType>
-class LocalFileOutputCollector: public AbstractOutputCollector<RecordType>
+class LocalFileOutputCollector: public BufferedOutputCollector<RecordType>
 {
 public:
 
@@ -53,8 +57,8 @@ public:
      * Opens an output stream in a file given by the value of the given
      * \p outputPath parameter.
      */
-    LocalFileOutputCollector(const Path& outputPath, const String& collectorName) :
-        AbstractOutputCollector<RecordType>(collectorName),
+    LocalFileOutputCollector(const Path& outputPath, const String& collectorName, size_t bufferSize = 1048576) :
+        BufferedOutputCollector<RecordType>(collectorName, bufferSize),
         _outputPath(outputPath),
         _isOpen(false),
         _logger(Logger::get(collectorName))
@@ -65,7 +69,7 @@ public:
      * Copy constructor.
      */
     LocalFileOutputCollector(const LocalFileOutputCollector& o) :
-        AbstractOutputCollector<RecordType>(o),
+        BufferedOutputCollector<RecordType>(o),
         _outputPath(o._outputPath),
         _isOpen(false),
         _logger(Logger::get(o._logger.name()))
@@ -109,6 +113,66 @@ public:
         }
     }
 
+    /**
+     * Truncates an existing output file to the given \p offset and opens
+     * the internal FileOutputStream instance for appending.
+     */
+    bool resume(I64u offset)
+    {
+        if (_isOpen)
+        {
+	        throw LogicException(format("Can't resume already opened local file at `%s`", _outputPath.toString()));
+        }
+
+        File outputFile(_outputPath);
+
+        if (!outputFile.exists() || outputFile.getSize() < offset)
+        {
+	        return false;
+        }
+
+        _logger.debug(format("Resuming local file for output path `%s` at offset %Lu", _outputPath.toString(), offset));
+
+        outputFile.setSize(offset);
+
+        _outputStream.open(_outputPath.toString(), std::ios::out | std::ios::app | std::ios::ate | std::ios::binary);
+        _isOpen = true;
+
+        return true;
+    }
+
+    /**
+     * Writes the buffered records, syncs the output file and returns its
+     * current length.
+     */
+    bool checkpoint(I64u& offset)
+    {
+        if (!_isOpen)
+        {
+	        return false;
+        }
+
+        flush();
+
+        // the stream does not expose its descriptor, but fsync() applies
+        // to the file and not to a particular descriptor
+        int fd = ::open(_outputPath.toString().c_str(), O_RDONLY);
+        if (fd < 0 || ::fsync(fd) != 0)
+        {
+	        if (fd >= 0)
+	        {
+		        ::close(fd);
+	        }
+
+	        throw FileException(format("Cannot sync local file at `%s`", _outputPath.toString()));
+        }
+
+        ::close(fd);
+
+        offset = static_cast<I64u>(_outputStream.tellp());
+        return true;
+    }
+
     /**
      * Closes the internal FileOutputStream instance.
      */
@@ -118,29 +182,35 @@ public:
         {
 	        _logger.debug(format("Closing local file for output path `%s`", _outputPath.toString()));
 
+	        BufferedOutputCollector<RecordType>::flushBuffer();
 	        AbstractOutputCollector<RecordType>::writeFooter(_outputStream);
 	        flush();
 	        _outputStream.close();
+	        _isOpen = false;
         }
     }
 
     /**
-     * Flushes the internal FileOutputStream instance and resets the flush counter.
+     * Writes the buffered records and flushes the internal FileOutputStream
+     * instance.
      */
     void flush()
     {
         if (_isOpen)
         {
+            BufferedOutputCollector<RecordType>::flushBuffer();
             _outputStream.flush();
         }
     }
 
+protected:
+
     /**
-     * Output collection method.
+     * Writes a block of serialized records to the internal FileOutputStream.
      */
-    void collect(const RecordType& record)
+    void writeBytes(const char* data, size_t size)
     {
-        LocalFileOutputCollector<RecordType>::serialize(_outputStream, record);
+        _outputStream.write(data, static_cast<std::streamsize>(size));
     }
 
 private:
@@ -0,0 +1,491 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef MAPPEDFILEOUTPUTCOLLECTOR_H_
+#define MAPPEDFILEOUTPUTCOLLECTOR_H_
+
+#include "core/clock.h"
+#include "io/AbstractOutputCollector.h"
+
+#include <Poco/File.h>
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The memory-mapped writer settings for file output collectors.
+ *
+ * The \p window size is bound to the 'application.output-mmap-window' config
+ * parameter. The expected number of \p records is the size of the genID
+ * range generated by the current node.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct MappingOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param records The expected number of records (zero if unknown).
+     * @param window The size of the mapped file window in bytes.
+     */
+    MappingOptions(I64u records = 0, size_t window = 67108864) :
+        records(records),
+        window(window)
+    {
+    }
+
+    I64u records; //!< The expected number of records.
+    size_t window; //!< The size of the mapped window.
+};
+
+/**
+ * An AbstractOutputCollector subclass that serializes records directly into
+ * a memory-mapped output file.
+ *
+ * The file is mapped in windows of MappingOptions::window bytes. Records are
+ * serialized into the current window with the raw buffer serialize() method,
+ * and a new window is mapped at the current file offset whenever a record
+ * does not fit, so records are never copied and no write system calls are
+ * issued.
+ *
+ * The file is preallocated with <tt>fallocate</tt> ahead of the mapped
+ * windows. After the first SAMPLE_SIZE records, the final file size is
+ * estimated from the average record width and the expected number of
+ * records and allocated at once. If the estimate turns out too small, the
+ * allocation grows by one eighth at a time. On close(), the file is
+ * truncated to the length of the written data.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class MappedFileOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * The number of records used to estimate the average record width.
+     */
+    static const I64u SAMPLE_SIZE = 10000;
+
+    /**
+     * Constructor.
+     */
+    MappedFileOutputCollector(const Path& outputPath, const MappingOptions& options, const String& collectorName) :
+        AbstractOutputCollector<RecordType>(collectorName),
+        _outputPath(outputPath),
+        _options(options),
+        _pageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+        _windowSize(std::max<size_t>((options.window + _pageSize - 1) / _pageSize, 1) * _pageSize),
+        _fd(-1),
+        _window(NULL),
+        _windowOffset(0),
+        _cursor(NULL),
+        _end(NULL),
+        _allocated(0),
+        _records(0),
+        _length(0),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    MappedFileOutputCollector(const MappedFileOutputCollector& o) :
+        AbstractOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _options(o._options),
+        _pageSize(o._pageSize),
+        _windowSize(o._windowSize),
+        _fd(-1),
+        _window(NULL),
+        _windowOffset(0),
+        _cursor(NULL),
+        _end(NULL),
+        _allocated(0),
+        _records(0),
+        _length(0),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the output file if opened.
+     */
+    virtual ~MappedFileOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Creates the output file and maps the first window.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening memory-mapped local file for output path `%s`", _outputPath.toString()));
+
+	        // make sure that the output-dir exists
+	        File outputDir(_outputPath.parent());
+            outputDir.createDirectories();
+
+            _fd = ::open(_outputPath.toString().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (_fd < 0)
+            {
+                throw OpenFileException(format("Cannot open output file `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+            }
+
+            _allocated = 0;
+            _records = 0;
+            _length = 0;
+            _isOpen = true;
+            map(0);
+
+	        std::ostringstream out;
+	        AbstractOutputCollector<RecordType>::writeHeader(out);
+	        const std::string header(out.str());
+	        writeBytes(header.data(), header.size());
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened local file at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Writes the footer, unmaps the current window, and truncates the output
+     * file to its real length.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing memory-mapped local file for output path `%s`", _outputPath.toString()));
+
+	        std::ostringstream out;
+	        AbstractOutputCollector<RecordType>::writeFooter(out);
+	        const std::string footer(out.str());
+	        writeBytes(footer.data(), footer.size());
+
+	        _length = offset();
+
+	        _isOpen = false;
+	        unmap();
+
+	        const int result = ftruncate(_fd, static_cast<off_t>(_length));
+	        ::close(_fd);
+	        _fd = -1;
+
+	        if (result != 0)
+	        {
+	            throw WriteFileException(format("Cannot truncate output file `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+	        }
+        }
+    }
+
+    /**
+     * Does nothing. The mapped pages are written back by the kernel.
+     */
+    void flush()
+    {
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        if (!AbstractOutputCollector<RecordType>::serialize(_cursor, _end, record))
+        {
+            // continue in a window starting at the current offset
+            map(offset());
+
+            if (!AbstractOutputCollector<RecordType>::serialize(_cursor, _end, record))
+            {
+                // the record does not fit into a whole window
+                std::ostringstream out;
+                AbstractOutputCollector<RecordType>::serialize(out, record);
+                const std::string s(out.str());
+                writeBytes(s.data(), s.size());
+            }
+        }
+
+        if (++_records == SAMPLE_SIZE)
+        {
+            estimate();
+        }
+    }
+
+    /**
+     * Returns the current file offset, or the final file length once the
+     * collector is closed.
+     */
+    I64u writtenBytes() const
+    {
+        return _isOpen ? offset() : _length;
+    }
+
+    /**
+     * Returns the number of nanoseconds spent in preallocating and mapping
+     * the output file so far.
+     */
+    I64u writeNanos() const
+    {
+        return _writeNanos;
+    }
+
+private:
+
+    /**
+     * Returns the current file offset.
+     */
+    I64u offset() const
+    {
+        return _windowOffset + static_cast<I64u>(_cursor - _window);
+    }
+
+    /**
+     * Copies \p size bytes starting at \p data to the current file offset.
+     */
+    void writeBytes(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (_cursor == _end)
+            {
+                map(offset());
+            }
+
+            const size_t n = std::min(size, static_cast<size_t>(_end - _cursor));
+            std::memcpy(_cursor, data, n);
+            _cursor += n;
+            data += n;
+            size -= n;
+        }
+    }
+
+    /**
+     * Maps the window containing the given file \p position and moves the
+     * cursor to it.
+     */
+    void map(I64u position)
+    {
+        const I64u start = monotonicNanos();
+        const I64u windowOffset = position / _pageSize * _pageSize;
+
+        allocate(windowOffset + _windowSize);
+        unmap();
+
+        void* window = mmap(NULL, _windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, static_cast<off_t>(windowOffset));
+        if (window == MAP_FAILED)
+        {
+            throw SystemException(format("Cannot map output file `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+        }
+
+        _window = static_cast<char*>(window);
+        _windowOffset = windowOffset;
+        _cursor = _window + (position - windowOffset);
+        _end = _window + _windowSize;
+
+        _writeNanos += monotonicNanos() - start;
+    }
+
+    /**
+     * Unmaps the current window.
+     */
+    void unmap()
+    {
+        if (_window != NULL)
+        {
+            munmap(_window, _windowSize);
+            _window = NULL;
+        }
+    }
+
+    /**
+     * Estimates the final file size from the records written so far and
+     * preallocates it.
+     */
+    void estimate()
+    {
+        if (_options.records > _records)
+        {
+            const Decimal width = offset() / static_cast<Decimal>(_records);
+            const I64u size = offset() + static_cast<I64u>(1.05 * width * (_options.records - _records)) + _windowSize;
+
+            _logger.debug(format("Preallocating %Lu bytes for output path `%s` (%.1f bytes per record)", static_cast<UInt64>(size), _outputPath.toString(), width));
+
+            const I64u start = monotonicNanos();
+            allocate(size);
+            _writeNanos += monotonicNanos() - start;
+        }
+    }
+
+    /**
+     * Ensures that the file is at least \p size bytes long. Grows the file by
+     * at least one eighth of its current size. Falls back to a sparse file
+     * only if the file system does not support preallocation.
+     */
+    void allocate(I64u size)
+    {
+        if (size <= _allocated)
+        {
+            return;
+        }
+
+        size = std::max(size, _allocated + _allocated / 8);
+
+#if defined(__linux__)
+        int result;
+        do
+        {
+            result = fallocate(_fd, 0, static_cast<off_t>(_allocated), static_cast<off_t>(size - _allocated));
+        }
+        while (result != 0 && errno == EINTR);
+
+        if (result == 0)
+        {
+            _allocated = size;
+            return;
+        }
+
+        // other errors (e.g. ENOSPC) would only surface as SIGBUS on the
+        // mapped pages, so report them here
+        if (errno != EOPNOTSUPP && errno != ENOSYS)
+        {
+            throw WriteFileException(format("Cannot preallocate output file `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+        }
+#endif
+
+        // fall back to a sparse file if preallocation is not supported
+        if (ftruncate(_fd, static_cast<off_t>(size)) != 0)
+        {
+            throw WriteFileException(format("Cannot extend output file `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+        }
+
+        _allocated = size;
+    }
+
+    /**
+     * The path of the output file.
+     */
+    const Path _outputPath;
+
+    /**
+     * The mapping settings.
+     */
+    const MappingOptions _options;
+
+    /**
+     * The system page size.
+     */
+    const size_t _pageSize;
+
+    /**
+     * The size of the mapped window (a multiple of the page size).
+     */
+    const size_t _windowSize;
+
+    /**
+     * The descriptor of the output file.
+     */
+    int _fd;
+
+    /**
+     * The start of the mapped window.
+     */
+    char* _window;
+
+    /**
+     * The file offset of the mapped window.
+     */
+    I64u _windowOffset;
+
+    /**
+     * The current write position in the mapped window.
+     */
+    char* _cursor;
+
+    /**
+     * The end of the mapped window.
+     */
+    char* _end;
+
+    /**
+     * The current file size.
+     */
+    I64u _allocated;
+
+    /**
+     * The number of records written so far.
+     */
+    I64u _records;
+
+    /**
+     * The length of the output file after close().
+     */
+    I64u _length;
+
+    /**
+     * The number of nanoseconds spent in preallocating and mapping the file.
+     */
+    I64u _writeNanos;
+
+    /**
+     * A boolean flag indicating that the output file is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* MAPPEDFILEOUTPUTCOLLECTOR_H_ */
@@ -19,11 +19,21 @@
 #define OUTPUTCOLLECTOR_H_
 
 #include "io/AbstractOutputCollector.h"
+#include "io/ColumnarOutputCollector.h"
+#include "io/CompressedFileOutputCollector.h"
 #include "io/LocalFileOutputCollector.h"
+#include "io/MappedFileOutputCollector.h"
+#include "io/OutputOptions.h"
+#include "io/PartitionedFileOutputCollector.h"
+#include "io/PipeOutputCollector.h"
+#include "io/RollingFileOutputCollector.h"
+#include "io/ShmRingOutputCollector.h"
 #include "io/SocketStreamOutputCollector.h"
+#include "io/UringFileOutputCollector.h"
 #include "io/VoidOutputCollector.h"
 
 #include <Poco/AutoPtr.h>
+#include <Poco/Logger.h>
 
 namespace Myriad {
 /**
@@ -40,30 +50,93 @@ template<class RecordType> struct OutputCollector
     /**
      * Factory method.
      *
-     * Constructs appropriate output collector based on given \p collectorType.
+     * Constructs appropriate output collector based on the output type of
+     * the given \p options. Text output of 'file' collectors is partitioned,
+     * split into multiple files, and compressed if enabled by the
+     * partitioning, rolling, and compression settings. Columnar files are
+     * never partitioned, split, or compressed. Uncompressed single files are
+     * written with the io_uring backend if requested by the writer settings
+     * and supported by the host, or directly into a preallocated
+     * memory-mapped file with the mapping settings. The size of 'shm' rings
+     * is given by the shm settings, the target and framing of 'unix' and
+     * 'fifo' output by the stream settings.
      *
      * @return The constructed <tt>AbstractOutputCollector<RecordType></tt>
      *         subclass instance.
      */
-    static Poco::AutoPtr< AbstractOutputCollector<RecordType> > factory(const String& collectorType, const I16u collectorPort, const Poco::Path& outputPath, const String& collectorName)
+    static Poco::AutoPtr< AbstractOutputCollector<RecordType> > factory(const Poco::Path& outputPath, const String& collectorName, const OutputOptions& options)
     {
         // local file
-        if (collectorType == "file")
+        if (options.type == "file")
         {
+            // use a binary columnar file for records with a columnar output format
+            ColumnarRowGroup layout;
+            if (AbstractOutputCollector<RecordType>::describe(layout))
+            {
+                return new ColumnarOutputCollector<RecordType>(outputPath, collectorName);
+            }
+
+            // use a partitioning collector if partitioning is enabled
+            if (options.partitioning.enabled())
+            {
+                return new PartitionedFileOutputCollector<RecordType>(outputPath, options, collectorName);
+            }
+            // use a rolling collector if file splitting is enabled
+            if (options.rolling.enabled())
+            {
+                return new RollingFileOutputCollector<RecordType>(outputPath, options.rolling, options.compression, collectorName);
+            }
+            // use a block compressing collector if compression is enabled
+            if (options.compression.enabled())
+            {
+                return new CompressedFileOutputCollector<RecordType>(outputPath, options.compression, collectorName);
+            }
+
+            // use the io_uring writer backend if requested and available
+            if (options.writer.enabled())
+            {
+                if (UringFileWriter::available())
+                {
+                    return new UringFileOutputCollector<RecordType>(outputPath, options.writer, collectorName);
+                }
+
+                Poco::Logger::get(collectorName).warning("io_uring is not available, using the stream writer backend");
+            }
+            // serialize into a memory-mapped file if requested
+            if (options.writer.backend == "mmap")
+            {
+                return new MappedFileOutputCollector<RecordType>(outputPath, options.mapping, collectorName);
+            }
+
             return new LocalFileOutputCollector<RecordType>(outputPath, collectorName);
         }
         // socket stream
-        if (collectorType == "socket")
+        if (options.type == "socket")
+        {
+            return new SocketStreamOutputCollector<RecordType>(outputPath, options.port, collectorName);
+        }
+        // shared memory ring
+        if (options.type == "shm")
+        {
+            return new ShmRingOutputCollector<RecordType>(outputPath, options.shm, collectorName);
+        }
+        // Unix domain socket
+        if (options.type == "unix")
+        {
+            return new PipeOutputCollector<RecordType>(outputPath, PipeOutputCollector<RecordType>::UNIX_SOCKET, options.stream, collectorName);
+        }
+        // named pipe
+        if (options.type == "fifo")
         {
-            return new SocketStreamOutputCollector<RecordType>(outputPath, collectorPort, collectorName);
+            return new PipeOutputCollector<RecordType>(outputPath, PipeOutputCollector<RecordType>::FIFO, options.stream, collectorName);
         }
         // void stream
-        if (collectorType == "void")
+        if (options.type == "void")
         {
             return new VoidOutputCollector<RecordType>(outputPath, collectorName);
         }
         // unknown output collector type
-        throw RuntimeException("Cannot construct output collector of type `" + collectorType + "`");
+        throw RuntimeException("Cannot construct output collector of type `" + options.type + "`");
     }
 };
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef OUTPUTOPTIONS_H_
+#define OUTPUTOPTIONS_H_
+
+#include "config/AbstractGeneratorConfig.h"
+#include "core/types.h"
+#include "io/BlockCompressor.h"
+#include "io/MappedFileOutputCollector.h"
+#include "io/Partitioning.h"
+#include "io/PipeOutputCollector.h"
+#include "io/RollingFileOutputCollector.h"
+#include "io/ShmRingOutputCollector.h"
+#include "io/UringFileWriter.h"
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The output settings of a generator.
+ *
+ * Groups the output type and the settings of all output backends, so that
+ * the OutputCollector factory can pick and construct a collector from a
+ * single value. Only the settings of the chosen backend are used.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct OutputOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param type The output type ('file', 'socket', 'unix', 'fifo', 'shm',
+     *        or 'void').
+     * @param port The port of 'socket' output.
+     */
+    OutputOptions(const String& type = "file", I16u port = 0) :
+        type(type),
+        port(port)
+    {
+    }
+
+    /**
+     * Reads the output settings of the generator identified by the given
+     * \p name from the \p config.
+     */
+    static OutputOptions fromConfig(const AbstractGeneratorConfig& config, const String& name)
+    {
+        OutputOptions options(config.outputType(), config.outputPort());
+
+        options.compression = CompressionOptions(config.outputCompression(), config.outputCompressionLevel(), config.outputCompressionThreads());
+        options.rolling = RollingOptions(config.outputRollBytes(), config.outputRollRecords());
+        options.partitioning = PartitioningOptions(config.outputPartitioningField(name), config.outputPartitioningCount(name), config.outputPartitioningBoundaries(name), config.outputPartitioningBufferSize(name));
+        options.writer = WriterOptions(config.outputWriter(), config.outputWriterDepth(), config.outputWriterBufferSize(), config.outputDirectIO());
+        options.mapping = MappingOptions(config.outputRecordEstimate(name), config.outputMappingWindow());
+        options.shm = ShmRingOptions(config.outputShmSize(), config.outputShmBatchSize(), config.outputShmTimeout());
+        options.stream = StreamOptions(config.outputTarget(), config.outputFraming(), config.outputSplice(), config.outputStreamBufferSize());
+
+        return options;
+    }
+
+    String type; //!< The output type.
+    I16u port; //!< The port of 'socket' output.
+    CompressionOptions compression; //!< The block compression of 'file' output.
+    RollingOptions rolling; //!< The file splitting of 'file' output.
+    PartitioningOptions partitioning; //!< The partitioning of 'file' output.
+    WriterOptions writer; //!< The writer backend of 'file' output.
+    MappingOptions mapping; //!< The memory mapping of 'mmap' file output.
+    ShmRingOptions shm; //!< The ring settings of 'shm' output.
+    StreamOptions stream; //!< The target and framing of 'unix' and 'fifo' output.
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* OUTPUTOPTIONS_H_ */
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef PARTITIONEDFILEOUTPUTCOLLECTOR_H_
+#define PARTITIONEDFILEOUTPUTCOLLECTOR_H_
+
+#include "core/exceptions.h"
+#include "io/AbstractOutputCollector.h"
+#include "io/CompressedFileOutputCollector.h"
+#include "io/LocalFileOutputCollector.h"
+#include "io/OutputOptions.h"
+#include "io/Partitioning.h"
+#include "io/RollingFileOutputCollector.h"
+
+#include <Poco/AutoPtr.h>
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+#include <Poco/NumberFormatter.h>
+
+#include <vector>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * An AbstractOutputCollector subclass that partitions the output by the
+ * value of a record field into multiple files in the local file system.
+ *
+ * The collector owns one file output collector per partition and routes each
+ * record to the collector of its partition, so the record is serialized
+ * directly into the buffer of the partition file. Partition \p i is written
+ * to <tt>${outputPath}.p0000i</tt> by a LocalFileOutputCollector, a
+ * CompressedFileOutputCollector, or a RollingFileOutputCollector depending on
+ * the compression and rolling settings. The memory used for buffering is
+ * bounded by PartitioningOptions::bufferSize per partition. Compressed
+ * partition files are compressed by a single worker thread each.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class PartitionedFileOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * The \p AbstractOutputCollector template specialization for this
+     * \p RecordType.
+     */
+    typedef AbstractOutputCollector<RecordType> AbstractOutputCollectorType;
+
+    /**
+     * Constructor.
+     *
+     * Resolves the partitioning field and creates the partition collectors
+     * with the partitioning, compression and rolling settings of the given
+     * \p options.
+     */
+    PartitionedFileOutputCollector(const Path& outputPath, const OutputOptions& options, const String& collectorName) :
+        AbstractOutputCollectorType(collectorName),
+        _outputPath(outputPath),
+        _partitioning(options.partitioning),
+        _compression(options.compression),
+        _rolling(options.rolling),
+        _field(AbstractOutputCollectorType::partitionField(options.partitioning.field)),
+        _partitioner(options.partitioning),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+        if (_field == 0)
+        {
+            throw InvalidArgumentException(format("Unknown partitioning field `%s`", _partitioning.field));
+        }
+
+        if (!_partitioning.boundaries.empty() && !AbstractOutputCollectorType::partitionOrdered(_field))
+        {
+            throw ConfigException(format("Partition boundaries are not supported for the hashed keys of partitioning field `%s`", _partitioning.field));
+        }
+
+        createPartitions();
+    }
+
+    /**
+     * Copy constructor.
+     */
+    PartitionedFileOutputCollector(const PartitionedFileOutputCollector& o) :
+        AbstractOutputCollectorType(o),
+        _outputPath(o._outputPath),
+        _partitioning(o._partitioning),
+        _compression(o._compression),
+        _rolling(o._rolling),
+        _field(o._field),
+        _partitioner(o._partitioning),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        createPartitions();
+
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the partition collectors if opened.
+     */
+    virtual ~PartitionedFileOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Opens all partition collectors.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening %u partition files for output path `%s`", _partitioner.count(), _outputPath.toString()));
+
+            for (size_t i = 0; i < _partitions.size(); i++)
+            {
+                _partitions[i]->open();
+            }
+	        _isOpen = true;
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened partition files at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Closes all partition collectors.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing partition files for output path `%s`", _outputPath.toString()));
+
+            for (size_t i = 0; i < _partitions.size(); i++)
+            {
+                _partitions[i]->close();
+            }
+	        _isOpen = false;
+        }
+    }
+
+    /**
+     * Flushes all partition collectors.
+     */
+    void flush()
+    {
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            _partitions[i]->flush();
+        }
+    }
+
+    /**
+     * Returns the number of bytes collected by all partition collectors.
+     */
+    I64u writtenBytes() const
+    {
+        I64u bytes = 0;
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            bytes += _partitions[i]->writtenBytes();
+        }
+        return bytes;
+    }
+
+    /**
+     * Returns the write time of all partition collectors.
+     */
+    I64u writeNanos() const
+    {
+        I64u nanos = 0;
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            nanos += _partitions[i]->writeNanos();
+        }
+        return nanos;
+    }
+
+    /**
+     * Returns the queue depth of all partition collectors.
+     */
+    I64u queueDepth() const
+    {
+        I64u depth = 0;
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            depth += _partitions[i]->queueDepth();
+        }
+        return depth;
+    }
+
+    /**
+     * Moves the buffers of all partition collectors to the NUMA node of the
+     * calling thread.
+     */
+    void localize()
+    {
+        for (size_t i = 0; i < _partitions.size(); i++)
+        {
+            _partitions[i]->localize();
+        }
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        _partitions[_partitioner.partition(AbstractOutputCollectorType::partitionKey(record, _field))]->collect(record);
+    }
+
+private:
+
+    /**
+     * Creates a (closed) output collector for each partition.
+     */
+    void createPartitions()
+    {
+        // compress each partition file on a single thread
+        CompressionOptions compression(_compression);
+        compression.threads = 1;
+
+        for (I32u i = 0; i < _partitioner.count(); i++)
+        {
+            const Path path(_outputPath.toString() + ".p" + NumberFormatter::format0(i, 5));
+            const String name(format("%s.p%u", _logger.name(), i));
+
+            if (_rolling.enabled())
+            {
+                _partitions.push_back(new RollingFileOutputCollector<RecordType>(path, _rolling, compression, name, _partitioning.bufferSize));
+            }
+            else if (compression.enabled())
+            {
+                _partitions.push_back(new CompressedFileOutputCollector<RecordType>(path, compression, name, _partitioning.bufferSize));
+            }
+            else
+            {
+                _partitions.push_back(new LocalFileOutputCollector<RecordType>(path, name, _partitioning.bufferSize));
+            }
+        }
+    }
+
+    /**
+     * The path prefix of the partition files.
+     */
+    const Path _outputPath;
+
+    /**
+     * The partitioning settings.
+     */
+    const PartitioningOptions _partitioning;
+
+    /**
+     * The compression settings.
+     */
+    const CompressionOptions _compression;
+
+    /**
+     * The file splitting settings.
+     */
+    const RollingOptions _rolling;
+
+    /**
+     * The ID of the partitioning field.
+     */
+    const I32u _field;
+
+    /**
+     * The partition assignment function.
+     */
+    const Partitioner _partitioner;
+
+    /**
+     * The output collectors of the individual partitions.
+     */
+    std::vector< AutoPtr<AbstractOutputCollectorType> > _partitions;
+
+    /**
+     * A boolean flag indicating that the partition collectors are open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* PARTITIONEDFILEOUTPUTCOLLECTOR_H_ */
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef PARTITIONING_H_
+#define PARTITIONING_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * Maps field values of type \p T to the 64-bit keys used for partitioning.
+ *
+ * Integral, Char, Bool and Enum values are mapped to their numeric value and
+ * Date values to their day number, so these keys preserve the value order
+ * and can be used for range partitioning. Decimal and String values are
+ * mapped to a hash of their binary representation and can only be used for
+ * hash partitioning, which is indicated by a false ORDERED constant.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename T> struct PartitionKey
+{
+    static const bool ORDERED = true;
+
+    static I64 get(const T& value)
+    {
+        return static_cast<I64>(value);
+    }
+};
+
+/**
+ * Date specialization of the PartitionKey template.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<> struct PartitionKey<Date>
+{
+    static const bool ORDERED = true;
+
+    static I64 get(const Date& value)
+    {
+        return value.dayNumber();
+    }
+};
+
+/**
+ * Decimal specialization of the PartitionKey template.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<> struct PartitionKey<Decimal>
+{
+    static const bool ORDERED = false;
+
+    static I64 get(const Decimal& value)
+    {
+        I64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+};
+
+/**
+ * String specialization of the PartitionKey template (64-bit FNV-1a hash).
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<> struct PartitionKey<String>
+{
+    static const bool ORDERED = false;
+
+    static I64 get(const String& value)
+    {
+        I64u hash = 14695981039346656037ULL;
+        for (String::const_iterator it = value.begin(); it != value.end(); ++it)
+        {
+            hash ^= static_cast<unsigned char>(*it);
+            hash *= 1099511628211ULL;
+        }
+        return static_cast<I64>(hash);
+    }
+};
+
+/**
+ * The partitioning settings for file output collectors.
+ *
+ * The settings are bound to the 'generator.${name}.output-partitioning.*'
+ * config parameters of the individual generators. If \p boundaries are
+ * given, records are range partitioned into <tt>boundaries.size() + 1</tt>
+ * partitions and the \p count is ignored. Otherwise, records are hash
+ * partitioned into \p count partitions.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct PartitioningOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param field The name of the partitioning field.
+     * @param count The number of hash partitions.
+     * @param boundaries The ascending range partition boundaries.
+     * @param bufferSize The output buffer size per partition in bytes.
+     */
+    PartitioningOptions(const String& field = "", I32u count = 0, const vector<I64>& boundaries = vector<I64>(), size_t bufferSize = 262144) :
+        field(field),
+        count(count),
+        boundaries(boundaries),
+        bufferSize(bufferSize)
+    {
+    }
+
+    /**
+     * Returns true if the output should be partitioned.
+     */
+    bool enabled() const
+    {
+        return !field.empty();
+    }
+
+    String field; //!< The name of the partitioning field.
+    I32u count; //!< The number of hash partitions.
+    vector<I64> boundaries; //!< The range partition boundaries.
+    size_t bufferSize; //!< The output buffer size per partition.
+};
+
+/**
+ * Assigns partition keys to partitions.
+ *
+ * With range partitioning, partition \p i holds the keys in the
+ * <tt>[boundaries[i-1], boundaries[i])</tt> range, where the first and the
+ * last partition are unbounded from below and above respectively. With hash
+ * partitioning, the key is scrambled with the MurmurHash3 finalizer before
+ * the modulo operation, so consecutive keys are spread across partitions.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class Partitioner
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    Partitioner(const PartitioningOptions& options) :
+        _boundaries(options.boundaries),
+        _count(options.boundaries.empty() ? options.count : static_cast<I32u>(options.boundaries.size() + 1))
+    {
+        if (_count == 0)
+        {
+            throw InvalidArgumentException(format("Invalid number of partitions for partitioning field `%s`", options.field));
+        }
+
+        for (size_t i = 1; i < _boundaries.size(); i++)
+        {
+            if (!(_boundaries[i - 1] < _boundaries[i]))
+            {
+                throw InvalidArgumentException(format("Partition boundaries for partitioning field `%s` are not ascending", options.field));
+            }
+        }
+    }
+
+    /**
+     * Returns the number of partitions.
+     */
+    I32u count() const
+    {
+        return _count;
+    }
+
+    /**
+     * Returns the partition of the given \p key.
+     */
+    I32u partition(I64 key) const
+    {
+        if (!_boundaries.empty())
+        {
+            return static_cast<I32u>(std::upper_bound(_boundaries.begin(), _boundaries.end(), key) - _boundaries.begin());
+        }
+
+        I64u h = static_cast<I64u>(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+
+        return static_cast<I32u>(h % _count);
+    }
+
+private:
+
+    const vector<I64> _boundaries;
+
+    const I32u _count;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* PARTITIONING_H_ */
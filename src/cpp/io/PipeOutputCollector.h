@@ -0,0 +1,778 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef PIPEOUTPUTCOLLECTOR_H_
+#define PIPEOUTPUTCOLLECTOR_H_
+
+#include "core/clock.h"
+#include "io/AbstractOutputCollector.h"
+
+#include <Poco/Buffer.h>
+#include <Poco/File.h>
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The settings for 'unix' and 'fifo' output collectors.
+ *
+ * The settings are bound to the 'application.output-target',
+ * 'application.output-framing', 'application.output-splice', and
+ * 'application.output-stream-buffer-size' config parameters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct StreamOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param target The socket path ('unix') or the FIFO directory ('fifo').
+     * @param framing Whether record batches should be length-prefixed.
+     * @param splice Whether FIFO output should use <tt>vmsplice</tt>.
+     * @param bufferSize The maximal size of a record batch in bytes.
+     */
+    StreamOptions(const String& target = "", bool framing = true, bool splice = true, size_t bufferSize = 1048576) :
+        target(target),
+        framing(framing),
+        splice(splice),
+        bufferSize(bufferSize)
+    {
+    }
+
+    String target; //!< The socket path or the FIFO directory.
+    bool framing; //!< Whether record batches are length-prefixed.
+    bool splice; //!< Whether to splice FIFO output.
+    size_t bufferSize; //!< The maximal size of a record batch.
+};
+
+/**
+ * Blocks SIGPIPE for the calling thread while in scope, so a write into a
+ * pipe without readers fails with EPIPE instead of terminating the process.
+ * A SIGPIPE raised within the scope is discarded when the scope is left.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class SigpipeGuard
+{
+public:
+
+    SigpipeGuard()
+    {
+        sigemptyset(&_sigpipe);
+        sigaddset(&_sigpipe, SIGPIPE);
+
+        // a SIGPIPE that is already pending is not ours to discard
+        sigset_t pending;
+        sigpending(&pending);
+        _wasPending = sigismember(&pending, SIGPIPE) == 1;
+
+        pthread_sigmask(SIG_BLOCK, &_sigpipe, &_mask);
+    }
+
+    ~SigpipeGuard()
+    {
+        const int error = errno;
+
+        if (!_wasPending)
+        {
+            struct timespec zero = { 0, 0 };
+            sigtimedwait(&_sigpipe, NULL, &zero);
+        }
+
+        pthread_sigmask(SIG_SETMASK, &_mask, NULL);
+        errno = error;
+    }
+
+private:
+
+    /**
+     * Noncopyable.
+     */
+    SigpipeGuard(const SigpipeGuard&);
+
+    /**
+     * Noncopyable.
+     */
+    SigpipeGuard& operator=(const SigpipeGuard&);
+
+    sigset_t _sigpipe;
+
+    sigset_t _mask;
+
+    bool _wasPending;
+};
+
+/**
+ * An AbstractOutputCollector subclass that writes the output into a Unix
+ * domain stream socket or a named pipe.
+ *
+ * With the 'unix' collector type, each collector opens its own connection to
+ * the socket at StreamOptions::target. With the 'fifo' collector type, each
+ * collector writes into the named pipe <tt>${target}/${output-file}</tt>,
+ * which is created if it does not exist. Opening a pipe blocks until the
+ * consumer has opened it for reading.
+ *
+ * Records are serialized into a batch buffer. If framing is enabled, each
+ * batch is prefixed with its length as a 4-byte little-endian integer and the
+ * stream is terminated by an empty batch, otherwise the serialized records
+ * are written as is.
+ *
+ * On Linux, pipe output is handed over to the kernel with <tt>vmsplice</tt>
+ * instead of being copied into the pipe. Since the pipe then references the
+ * batch buffer pages, the collector rotates through several buffers and
+ * reuses a buffer only after the consumer has read all of its bytes.
+ *
+ * If the consumer goes away, the next write fails with a WriteFileException
+ * (SIGPIPE is blocked around pipe writes).
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class PipeOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * The supported output kinds.
+     */
+    enum Kind
+    {
+        UNIX_SOCKET, FIFO
+    };
+
+    /**
+     * The number of rotated buffers in splice mode.
+     */
+    static const size_t SPLICE_BUFFERS = 4;
+
+    /**
+     * Constructor.
+     */
+    PipeOutputCollector(const Path& outputPath, Kind kind, const StreamOptions& options, const String& collectorName) :
+        AbstractOutputCollector<RecordType>(collectorName),
+        _outputPath(outputPath),
+        _kind(kind),
+        _options(options),
+        _prefix(options.framing ? 4 : 0),
+        _fd(-1),
+        _splice(false),
+        _pipeSize(0),
+        _written(0),
+        _writeNanos(0),
+        _current(0),
+        _cursor(NULL),
+        _end(NULL),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    PipeOutputCollector(const PipeOutputCollector& o) :
+        AbstractOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _kind(o._kind),
+        _options(o._options),
+        _prefix(o._prefix),
+        _fd(-1),
+        _splice(false),
+        _pipeSize(0),
+        _written(0),
+        _writeNanos(0),
+        _current(0),
+        _cursor(NULL),
+        _end(NULL),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the output stream if opened.
+     */
+    virtual ~PipeOutputCollector()
+    {
+        close();
+
+        for (size_t i = 0; i < _buffers.size(); i++)
+        {
+            delete _buffers[i];
+        }
+    }
+
+    /**
+     * Connects to the socket or opens the named pipe.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            if (_kind == UNIX_SOCKET)
+            {
+                connect();
+            }
+            else
+            {
+                openPipe();
+            }
+
+            // allocate the batch buffers
+            const size_t count = _splice ? SPLICE_BUFFERS : 1;
+            while (_buffers.size() < count)
+            {
+                _buffers.push_back(new Poco::Buffer<char>(_prefix + _options.bufferSize));
+                _released.push_back(0);
+            }
+
+            _written = 0;
+            _current = 0;
+            _cursor = _buffers[0]->begin() + _prefix;
+            _end = _buffers[0]->end();
+	        _isOpen = true;
+
+	        std::ostringstream out;
+	        AbstractOutputCollector<RecordType>::writeHeader(out);
+	        writeBatch(out.str());
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened stream for output path `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Writes the footer and closes the output stream.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing stream for output path `%s`", _outputPath.toString()));
+
+	        try
+	        {
+	            flush();
+
+	            std::ostringstream out;
+	            AbstractOutputCollector<RecordType>::writeFooter(out);
+	            writeBatch(out.str());
+
+	            if (_options.framing)
+	            {
+	                // terminate the stream with an empty batch
+	                writeFrame(NULL, 0);
+	            }
+
+	            // the pipe must not reference the buffers after they are released
+	            for (size_t i = 0; _splice && i < _buffers.size(); i++)
+	            {
+	                awaitBuffer(i);
+	            }
+	        }
+	        catch(...)
+	        {
+	            // the stream is broken, do not retry from the destructor
+	            ::close(_fd);
+	            _fd = -1;
+	            _isOpen = false;
+	            throw;
+	        }
+
+	        ::close(_fd);
+	        _fd = -1;
+	        _isOpen = false;
+        }
+    }
+
+    /**
+     * Writes the buffered records as one batch.
+     */
+    void flush()
+    {
+        if (!_isOpen)
+        {
+            return;
+        }
+
+        char* begin = _buffers[_current]->begin();
+
+        if (_cursor == begin + _prefix)
+        {
+            return;
+        }
+
+        const size_t size = static_cast<size_t>(_cursor - begin);
+        if (_options.framing)
+        {
+            encodeLength(begin, size - _prefix);
+        }
+
+        const I64u start = monotonicNanos();
+        if (_splice)
+        {
+            splice(begin, size);
+            _released[_current] = _written;
+
+            // continue with the next buffer once the consumer has read it
+            _current = (_current + 1) % _buffers.size();
+            awaitBuffer(_current);
+        }
+        else
+        {
+            writeFully(begin, size, NULL, 0);
+        }
+        _writeNanos += monotonicNanos() - start;
+
+        _cursor = _buffers[_current]->begin() + _prefix;
+        _end = _buffers[_current]->end();
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        if (!AbstractOutputCollector<RecordType>::serialize(_cursor, _end, record))
+        {
+            flush();
+
+            if (!AbstractOutputCollector<RecordType>::serialize(_cursor, _end, record))
+            {
+                // the record does not fit into an empty buffer
+                std::ostringstream out;
+                AbstractOutputCollector<RecordType>::serialize(out, record);
+                writeBatch(out.str());
+            }
+        }
+    }
+
+    /**
+     * Returns the total number of bytes written to the output stream,
+     * including the length prefixes.
+     */
+    I64u writtenBytes() const
+    {
+        return _written;
+    }
+
+    /**
+     * Returns the number of nanoseconds spent in writing batches and waiting
+     * for the consumer so far.
+     */
+    I64u writeNanos() const
+    {
+        return _writeNanos;
+    }
+
+private:
+
+    /**
+     * Connects a Unix domain stream socket to StreamOptions::target.
+     */
+    void connect()
+    {
+        _logger.debug(format("Opening Unix socket `%s` for output path `%s`", _options.target, _outputPath.toString()));
+
+        struct sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (_options.target.empty() || _options.target.size() >= sizeof(address.sun_path))
+        {
+            throw InvalidArgumentException(format("Invalid Unix socket path `%s`", _options.target));
+        }
+
+        std::memcpy(address.sun_path, _options.target.data(), _options.target.size());
+
+        _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (_fd < 0)
+        {
+            throw SystemException(format("Cannot create Unix socket: %s", string(std::strerror(errno))));
+        }
+
+        if (::connect(_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            const int error = errno;
+            ::close(_fd);
+            _fd = -1;
+            throw RuntimeException(format("Could not connect to Unix socket at `%s`: %s", _options.target, string(std::strerror(error))));
+        }
+    }
+
+    /**
+     * Opens (and if necessary creates) the named pipe for the output file.
+     */
+    void openPipe()
+    {
+        Path path(_options.target);
+        path.makeDirectory();
+        path.setFileName(_outputPath.getFileName());
+
+        _logger.debug(format("Opening named pipe `%s` for output path `%s`", path.toString(), _outputPath.toString()));
+
+        File(path.parent()).createDirectories();
+
+        if (mkfifo(path.toString().c_str(), 0644) != 0 && errno != EEXIST)
+        {
+            throw SystemException(format("Cannot create named pipe `%s`: %s", path.toString(), string(std::strerror(errno))));
+        }
+
+        struct stat st;
+        if (stat(path.toString().c_str(), &st) != 0 || !S_ISFIFO(st.st_mode))
+        {
+            throw OpenFileException(format("Output target `%s` is not a named pipe", path.toString()));
+        }
+
+        // blocks until the consumer opens the pipe for reading
+        _fd = ::open(path.toString().c_str(), O_WRONLY);
+        if (_fd < 0)
+        {
+            throw OpenFileException(format("Cannot open named pipe `%s`: %s", path.toString(), string(std::strerror(errno))));
+        }
+
+#if defined(__linux__)
+        if (_options.splice)
+        {
+#if defined(F_SETPIPE_SZ)
+            fcntl(_fd, F_SETPIPE_SZ, static_cast<int>(_options.bufferSize));
+            const int pipeSize = fcntl(_fd, F_GETPIPE_SZ);
+#else
+            const int pipeSize = 65536;
+#endif
+            if (pipeSize > 0)
+            {
+                _pipeSize = static_cast<I64u>(pipeSize);
+                _splice = true;
+            }
+        }
+#endif
+    }
+
+    /**
+     * Writes the non-empty string \p s as one batch.
+     */
+    void writeBatch(const std::string& s)
+    {
+        if (!s.empty())
+        {
+            writeFrame(s.data(), s.size());
+        }
+    }
+
+    /**
+     * Writes \p size bytes starting at \p data with a length prefix (if
+     * framing is enabled) from an unshared buffer.
+     */
+    void writeFrame(const char* data, size_t size)
+    {
+        if (static_cast<I64u>(size) > 0xFFFFFFFFULL)
+        {
+            throw WriteFileException(format("Record batch of %z bytes is too large for output path `%s`", size, _outputPath.toString()));
+        }
+
+        char prefix[4];
+        encodeLength(prefix, size);
+
+        const I64u start = monotonicNanos();
+        writeFully(prefix, _prefix, data, size);
+        _writeNanos += monotonicNanos() - start;
+    }
+
+    /**
+     * Writes the 4-byte little-endian \p length at \p out.
+     */
+    static void encodeLength(char* out, size_t length)
+    {
+        const I32u n = static_cast<I32u>(length);
+        out[0] = static_cast<char>(n & 0xFF);
+        out[1] = static_cast<char>((n >> 8) & 0xFF);
+        out[2] = static_cast<char>((n >> 16) & 0xFF);
+        out[3] = static_cast<char>((n >> 24) & 0xFF);
+    }
+
+    /**
+     * Writes the two ranges <tt>[a, a + aSize)</tt> and
+     * <tt>[b, b + bSize)</tt> to the output stream.
+     */
+    void writeFully(const char* a, size_t aSize, const char* b, size_t bSize)
+    {
+        struct iovec iov[2];
+        iov[0].iov_base = const_cast<char*>(a);
+        iov[0].iov_len = aSize;
+        iov[1].iov_base = const_cast<char*>(b);
+        iov[1].iov_len = bSize;
+
+        struct iovec* next = iov;
+        int count = 2;
+
+        while (count > 0)
+        {
+            if (next->iov_len == 0)
+            {
+                next++;
+                count--;
+                continue;
+            }
+
+            ssize_t n;
+            if (_kind == UNIX_SOCKET)
+            {
+                struct msghdr message;
+                std::memset(&message, 0, sizeof(message));
+                message.msg_iov = next;
+                message.msg_iovlen = count;
+                n = sendmsg(_fd, &message, MSG_NOSIGNAL);
+            }
+            else
+            {
+                SigpipeGuard guard;
+                n = writev(_fd, next, count);
+            }
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (errno == EPIPE)
+                {
+                    throw WriteFileException(format("Consumer closed the output stream for output path `%s`", _outputPath.toString()));
+                }
+
+                throw WriteFileException(format("Cannot write to output stream for output path `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+            }
+
+            _written += static_cast<I64u>(n);
+            advance(next, count, static_cast<size_t>(n));
+        }
+    }
+
+    /**
+     * Hands the \p size bytes starting at \p data over to the pipe.
+     */
+    void splice(const char* data, size_t size)
+    {
+#if defined(__linux__)
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data);
+        iov.iov_len = size;
+
+        struct iovec* next = &iov;
+        int count = 1;
+
+        while (count > 0)
+        {
+            ssize_t n;
+            {
+                SigpipeGuard guard;
+                n = vmsplice(_fd, next, static_cast<unsigned long>(count), 0);
+            }
+
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (errno == EPIPE)
+                {
+                    throw WriteFileException(format("Consumer closed the named pipe for output path `%s`", _outputPath.toString()));
+                }
+
+                throw WriteFileException(format("Cannot splice into named pipe for output path `%s`: %s", _outputPath.toString(), string(std::strerror(errno))));
+            }
+
+            _written += static_cast<I64u>(n);
+            advance(next, count, static_cast<size_t>(n));
+        }
+#else
+        writeFully(data, size, NULL, 0);
+#endif
+    }
+
+    /**
+     * Advances the iovec array at \p next by \p n written bytes.
+     */
+    static void advance(struct iovec*& next, int& count, size_t n)
+    {
+        while (count > 0 && n >= next->iov_len)
+        {
+            n -= next->iov_len;
+            next++;
+            count--;
+        }
+
+        if (count > 0)
+        {
+            next->iov_base = static_cast<char*>(next->iov_base) + n;
+            next->iov_len -= n;
+        }
+    }
+
+    /**
+     * Waits until the pipe no longer references the pages of the buffer with
+     * the given \p index.
+     *
+     * @throw WriteFileException If the consumer closes the pipe before
+     *        reading the buffer.
+     */
+    void awaitBuffer(size_t index)
+    {
+        // the pipe holds at most _pipeSize bytes, so the buffer has been read
+        // if at least that many bytes were written after it
+        while (_written - _released[index] < _pipeSize)
+        {
+            int pending = 0;
+            if (ioctl(_fd, FIONREAD, &pending) != 0 || _written - static_cast<I64u>(pending) >= _released[index])
+            {
+                return;
+            }
+
+            // the unread bytes are lost if the consumer has closed the pipe
+            struct pollfd p = { _fd, POLLOUT, 0 };
+            if (poll(&p, 1, 0) > 0 && (p.revents & POLLERR) != 0)
+            {
+                throw WriteFileException(format("Consumer closed the named pipe for output path `%s` with %d unread bytes", _outputPath.toString(), pending));
+            }
+
+            struct timespec t = { 0, 50000 };
+            nanosleep(&t, NULL);
+        }
+    }
+
+    /**
+     * The output path of the collector.
+     */
+    const Path _outputPath;
+
+    /**
+     * The output kind.
+     */
+    const Kind _kind;
+
+    /**
+     * The stream settings.
+     */
+    const StreamOptions _options;
+
+    /**
+     * The number of bytes reserved for the length prefix of each batch.
+     */
+    const size_t _prefix;
+
+    /**
+     * The output descriptor.
+     */
+    int _fd;
+
+    /**
+     * A boolean flag indicating that batches are spliced into the pipe.
+     */
+    bool _splice;
+
+    /**
+     * The capacity of the pipe in bytes.
+     */
+    I64u _pipeSize;
+
+    /**
+     * The total number of bytes written to the output descriptor.
+     */
+    I64u _written;
+
+    /**
+     * The number of nanoseconds spent in writing to the output descriptor.
+     */
+    I64u _writeNanos;
+
+    /**
+     * The batch buffers.
+     */
+    std::vector<Poco::Buffer<char>*> _buffers;
+
+    /**
+     * The value of \p _written after each buffer was last spliced.
+     */
+    std::vector<I64u> _released;
+
+    /**
+     * The index of the current batch buffer.
+     */
+    size_t _current;
+
+    /**
+     * The current write position in the current batch buffer.
+     */
+    char* _cursor;
+
+    /**
+     * The end of the current batch buffer.
+     */
+    char* _end;
+
+    /**
+     * A boolean flag indicating that the output stream is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* PIPEOUTPUTCOLLECTOR_H_ */
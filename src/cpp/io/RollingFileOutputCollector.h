@@ -0,0 +1,363 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef ROLLINGFILEOUTPUTCOLLECTOR_H_
+#define ROLLINGFILEOUTPUTCOLLECTOR_H_
+
+#include "io/BlockCompressor.h"
+#include "io/BufferedOutputCollector.h"
+
+#include <Poco/File.h>
+#include <Poco/FileStream.h>
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+#include <Poco/NumberFormatter.h>
+
+#include <vector>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The file splitting settings for file output collectors.
+ *
+ * The settings are bound to the 'application.output-roll-bytes' and
+ * 'application.output-roll-records' config parameters. A limit of zero
+ * disables the corresponding criterion.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct RollingOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param maxBytes The (uncompressed) size after which a new file is
+     *                 started.
+     * @param maxRecords The number of records after which a new file is
+     *                   started.
+     */
+    RollingOptions(I64u maxBytes = 0, I64u maxRecords = 0) :
+        maxBytes(maxBytes),
+        maxRecords(maxRecords)
+    {
+    }
+
+    /**
+     * Returns true if the output should be split into multiple files.
+     */
+    bool enabled() const
+    {
+        return maxBytes > 0 || maxRecords > 0;
+    }
+
+    I64u maxBytes; //!< The file size limit in bytes.
+    I64u maxRecords; //!< The file size limit in records.
+};
+
+/**
+ * An AbstractOutputCollector subclass that splits the output into a sequence
+ * of numbered files in the local file system.
+ *
+ * A new file is started once the current one contains at least
+ * RollingOptions::maxBytes bytes or RollingOptions::maxRecords records, so
+ * files exceed the byte limit by at most one record. The files are named
+ * <tt>${outputPath}.00000</tt>, <tt>${outputPath}.00001</tt>, etc., and each
+ * of them contains the output specific header and footer. If compression is
+ * enabled, each file is compressed separately with a BlockCompressor (the
+ * byte limit still refers to the uncompressed size) and gets the additional
+ * extension of the compression codec (e.g. '.gz').
+ *
+ * The collector maintains a manifest at <tt>${outputPath}.manifest</tt> that
+ * lists the completed files. The manifest is rewritten whenever a file is
+ * completed, so after a failure it covers all files that can be loaded. Each
+ * manifest line consists of the following tab separated fields: file name,
+ * number of records, uncompressed size in bytes, first genID and last genID
+ * plus one. The genID range of a file without records is empty.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class RollingFileOutputCollector: public BufferedOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    RollingFileOutputCollector(const Path& outputPath, const RollingOptions& rolling, const CompressionOptions& compression, const String& collectorName, size_t bufferSize = 1048576) :
+        BufferedOutputCollector<RecordType>(collectorName, bufferSize),
+        _outputPath(outputPath),
+        _rolling(rolling),
+        _compression(compression),
+        _compressor(NULL),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    RollingFileOutputCollector(const RollingFileOutputCollector& o) :
+        BufferedOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _rolling(o._rolling),
+        _compression(o._compression),
+        _compressor(NULL),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the current file if opened.
+     */
+    virtual ~RollingFileOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Opens the first file of the sequence.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening rolling local files for output path `%s`", _outputPath.toString()));
+
+	        // make sure that the output-dir exists
+	        File outputDir(_outputPath.parent());
+            outputDir.createDirectories();
+
+            _parts.clear();
+            openPart();
+	        _isOpen = true;
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened local files at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Closes the current file and writes the final manifest.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing rolling local files for output path `%s`", _outputPath.toString()));
+
+	        closePart();
+	        _isOpen = false;
+        }
+    }
+
+    /**
+     * Writes the buffered records and flushes the current file.
+     */
+    void flush()
+    {
+        if (_isOpen)
+        {
+            BufferedOutputCollector<RecordType>::flushBuffer();
+            if (_compressor != NULL)
+            {
+                _compressor->drain();
+            }
+            _outputStream.flush();
+        }
+    }
+
+    /**
+     * Output collection method. Starts a new file if the current one has
+     * reached one of the configured limits.
+     */
+    void collect(const RecordType& record)
+    {
+        Part& part = _parts.back();
+
+        if (part.records > 0 && ((_rolling.maxRecords > 0 && part.records >= _rolling.maxRecords) || (_rolling.maxBytes > 0 && part.bytes + BufferedOutputCollector<RecordType>::bufferedBytes() >= _rolling.maxBytes)))
+        {
+            closePart();
+            openPart();
+        }
+
+        BufferedOutputCollector<RecordType>::collect(record);
+
+        Part& current = _parts.back();
+        if (current.records == 0)
+        {
+            current.genIDBegin = record.genID();
+        }
+        current.genIDEnd = record.genID() + 1;
+        current.records++;
+    }
+
+protected:
+
+    /**
+     * Writes a block of serialized records to the current file.
+     */
+    void writeBytes(const char* data, size_t size)
+    {
+        _parts.back().bytes += size;
+
+        if (_compressor != NULL)
+        {
+            _compressor->compress(data, size);
+        }
+        else
+        {
+            _outputStream.write(data, static_cast<std::streamsize>(size));
+        }
+    }
+
+private:
+
+    /**
+     * A manifest entry.
+     */
+    struct Part
+    {
+        Part(const String& name) :
+            name(name),
+            records(0),
+            bytes(0),
+            genIDBegin(0),
+            genIDEnd(0)
+        {
+        }
+
+        String name;
+        I64u records;
+        I64u bytes;
+        I64u genIDBegin;
+        I64u genIDEnd;
+    };
+
+    /**
+     * Opens the next file of the sequence and writes the header.
+     */
+    void openPart()
+    {
+        Path path(_outputPath.toString() + "." + NumberFormatter::format0(static_cast<UInt64>(_parts.size()), 5) + _compression.extension());
+
+        _parts.push_back(Part(path.getFileName()));
+
+	    _outputStream.open(path.toString(), std::ios::trunc | std::ios::binary);
+	    if (_compression.enabled())
+	    {
+	        _compressor = new BlockCompressor(_outputStream, _compression);
+	    }
+
+	    BufferedOutputCollector<RecordType>::writeBufferedHeader();
+    }
+
+    /**
+     * Writes the footer, closes the current file, and rewrites the manifest.
+     */
+    void closePart()
+    {
+        BufferedOutputCollector<RecordType>::writeBufferedFooter();
+
+        if (_compressor != NULL)
+        {
+            _compressor->close();
+            delete _compressor;
+            _compressor = NULL;
+        }
+
+        _outputStream.close();
+
+        writeManifest();
+    }
+
+    /**
+     * Writes the manifest of all files up to and including the current one.
+     */
+    void writeManifest()
+    {
+        FileOutputStream manifest(_outputPath.toString() + ".manifest", std::ios::trunc);
+
+        for (typename std::vector<Part>::const_iterator it = _parts.begin(); it != _parts.end(); ++it)
+        {
+            manifest << it->name << '\t' << it->records << '\t' << it->bytes << '\t' << it->genIDBegin << '\t' << it->genIDEnd << '\n';
+        }
+
+        manifest.close();
+    }
+
+    /**
+     * The path prefix of the output files.
+     */
+    const Path _outputPath;
+
+    /**
+     * The file splitting settings.
+     */
+    const RollingOptions _rolling;
+
+    /**
+     * The compression settings.
+     */
+    const CompressionOptions _compression;
+
+    /**
+     * The files written so far, including the current one.
+     */
+    std::vector<Part> _parts;
+
+    /**
+     * The output stream of the current file.
+     */
+    FileOutputStream _outputStream;
+
+    /**
+     * The compressor writing to the \p _outputStream if compression is
+     * enabled.
+     */
+    BlockCompressor* _compressor;
+
+    /**
+     * A boolean flag indicating that the current file is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* ROLLINGFILEOUTPUTCOLLECTOR_H_ */
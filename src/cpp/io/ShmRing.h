@@ -0,0 +1,627 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SHMRING_H_
+#define SHMRING_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+#include <Poco/Timestamp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The layout of a single-producer/single-consumer ring buffer in POSIX shared
+ * memory.
+ *
+ * A segment consists of a Header page followed by \p capacity data bytes
+ * (a power of two). The producer and the consumer publish their monotonically
+ * increasing byte positions in the \p head and \p tail header fields, which
+ * are placed on separate cache lines. A position is published with release
+ * semantics only after the corresponding data has been written (respectively
+ * read), so no locks are needed. The consumer announces itself in the
+ * \p consumer header field, so a producer waiting for free space can fail
+ * once the consumer has gone away.
+ *
+ * The data bytes are a sequence of 8-byte aligned frames. Each frame starts
+ * with a Frame header followed by \p size payload bytes. The payload of a
+ * frame without flags is a batch of complete serialized records. Payloads
+ * that are too large for a single frame are split into several frames, all
+ * but the last one carrying the PARTIAL flag. Frames never wrap around the
+ * end of the ring - the remaining bytes are skipped with a PADDING frame.
+ *
+ * The segment name is derived from the output path of the producing
+ * collector with segmentName().
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct ShmRing
+{
+    /**
+     * The state of the producer.
+     */
+    enum State
+    {
+        INITIALIZING = 0, OPEN = 1, CLOSED = 2
+    };
+
+    /**
+     * The state of the consumer.
+     */
+    enum ConsumerState
+    {
+        UNATTACHED = 0, ATTACHED = 1, DETACHED = 2
+    };
+
+    /**
+     * Frame flags.
+     */
+    enum Flags
+    {
+        PADDING = 1, //!< The rest of the ring is unused, continue at position zero.
+        PARTIAL = 2 //!< The payload is continued in the next frame.
+    };
+
+    /**
+     * The segment header.
+     */
+    struct Header
+    {
+        char magic[8]; //!< Always equal to MAGIC.
+        I32u version; //!< The layout version.
+        I32u state; //!< The producer State.
+        I64u capacity; //!< The number of data bytes.
+        I32u consumer; //!< The ConsumerState.
+        char padding0[36];
+        I64u head; //!< The producer position.
+        char padding1[56];
+        I64u tail; //!< The consumer position.
+        char padding2[56];
+    };
+
+    /**
+     * The frame header.
+     */
+    struct Frame
+    {
+        I32u size; //!< The number of payload bytes.
+        I32u flags; //!< The frame Flags.
+    };
+
+    /**
+     * The magic bytes at the beginning of each segment.
+     */
+    static const char* MAGIC;
+
+    /**
+     * The layout version.
+     */
+    static const I32u VERSION = 2;
+
+    /**
+     * The offset of the data bytes in the segment.
+     */
+    static const size_t DATA_OFFSET = 4096;
+
+    /**
+     * Returns the shared memory segment name for the given output \p path.
+     */
+    static string segmentName(const string& path)
+    {
+        string name("/myriad");
+
+        for (string::const_iterator it = path.begin(); it != path.end(); ++it)
+        {
+            name.push_back(*it == '/' ? '.' : *it);
+        }
+
+        return name;
+    }
+
+    /**
+     * Returns the total frame length for a payload of the given \p size.
+     */
+    static I64u frameLength(size_t size)
+    {
+        return (sizeof(Frame) + size + 7) & ~static_cast<I64u>(7);
+    }
+
+    /**
+     * Waits a little while polling for the other side of the ring. The
+     * first \p 64 rounds yield the CPU, later rounds sleep for 50us.
+     */
+    static void backoff(size_t& round)
+    {
+        if (round++ < 64)
+        {
+            sched_yield();
+        }
+        else
+        {
+            struct timespec t = { 0, 50000 };
+            nanosleep(&t, NULL);
+        }
+    }
+};
+
+/**
+ * The producing side of a ShmRing.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ShmRingWriter
+{
+public:
+
+    /**
+     * Creates a new segment with the given \p name and \p capacity (rounded up
+     * to a power of two). An existing segment with the same name is
+     * replaced.
+     *
+     * A write fails if the ring stays full for \p timeout milliseconds
+     * without the consumer releasing any bytes (0 waits forever).
+     */
+    ShmRingWriter(const string& name, size_t capacity, unsigned long timeout = 60000) :
+        _name(name),
+        _header(NULL),
+        _data(NULL),
+        _capacity(4096),
+        _size(0),
+        _timeout(timeout)
+    {
+        while (_capacity < capacity)
+        {
+            _capacity <<= 1;
+        }
+
+        _size = ShmRing::DATA_OFFSET + _capacity;
+
+        // remove a stale segment left behind by a previous run
+        shm_unlink(_name.c_str());
+
+        int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            throw SystemException(format("Cannot create shared memory segment `%s`: %s", _name, string(std::strerror(errno))));
+        }
+
+        if (ftruncate(fd, static_cast<off_t>(_size)) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            shm_unlink(_name.c_str());
+            throw SystemException(format("Cannot resize shared memory segment `%s`: %s", _name, string(std::strerror(error))));
+        }
+
+        void* memory = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+
+        if (memory == MAP_FAILED)
+        {
+            shm_unlink(_name.c_str());
+            throw SystemException(format("Cannot map shared memory segment `%s`: %s", _name, string(std::strerror(error))));
+        }
+
+        _header = static_cast<ShmRing::Header*>(memory);
+        _data = static_cast<char*>(memory) + ShmRing::DATA_OFFSET;
+
+        std::memcpy(_header->magic, ShmRing::MAGIC, sizeof(_header->magic));
+        _header->version = ShmRing::VERSION;
+        _header->capacity = _capacity;
+        _header->consumer = ShmRing::UNATTACHED;
+        _header->head = 0;
+        _header->tail = 0;
+        __atomic_store_n(&_header->state, static_cast<I32u>(ShmRing::OPEN), __ATOMIC_RELEASE);
+    }
+
+    /**
+     * Destructor. Closes the ring if still open and unmaps the segment.
+     */
+    ~ShmRingWriter()
+    {
+        close();
+        munmap(_header, _size);
+    }
+
+    /**
+     * Returns the name of the segment.
+     */
+    const string& name() const
+    {
+        return _name;
+    }
+
+    /**
+     * Returns the largest payload written in a single frame.
+     */
+    size_t maxFrameSize() const
+    {
+        return _capacity / 2 - sizeof(ShmRing::Frame);
+    }
+
+    /**
+     * Writes \p size bytes starting at \p data as one batch. Blocks while the
+     * ring is full.
+     *
+     * @throw WriteFileException If the consumer has detached or has not
+     *        released any bytes within the configured timeout.
+     */
+    void write(const char* data, size_t size)
+    {
+        do
+        {
+            const size_t chunk = std::min(size, maxFrameSize());
+            const I32u flags = chunk < size ? ShmRing::PARTIAL : 0;
+
+            writeFrame(data, chunk, flags);
+
+            data += chunk;
+            size -= chunk;
+        }
+        while (size > 0);
+    }
+
+    /**
+     * Marks the ring as closed. The consumer drains the remaining frames and
+     * stops afterwards.
+     */
+    void close()
+    {
+        if (__atomic_load_n(&_header->state, __ATOMIC_RELAXED) != ShmRing::CLOSED)
+        {
+            __atomic_store_n(&_header->state, static_cast<I32u>(ShmRing::CLOSED), __ATOMIC_RELEASE);
+        }
+    }
+
+private:
+
+    /**
+     * Noncopyable.
+     */
+    ShmRingWriter(const ShmRingWriter&);
+
+    /**
+     * Noncopyable.
+     */
+    ShmRingWriter& operator=(const ShmRingWriter&);
+
+    /**
+     * Writes a single frame.
+     */
+    void writeFrame(const char* data, size_t size, I32u flags)
+    {
+        const I64u length = ShmRing::frameLength(size);
+
+        I64u head = _header->head;
+        I64u offset = head & (_capacity - 1);
+
+        if (_capacity - offset < length)
+        {
+            // skip the rest of the ring
+            const I64u padding = _capacity - offset;
+            await(head + padding);
+
+            ShmRing::Frame* frame = reinterpret_cast<ShmRing::Frame*>(_data + offset);
+            frame->size = 0;
+            frame->flags = ShmRing::PADDING;
+
+            head += padding;
+            offset = 0;
+            __atomic_store_n(&_header->head, head, __ATOMIC_RELEASE);
+        }
+
+        await(head + length);
+
+        ShmRing::Frame* frame = reinterpret_cast<ShmRing::Frame*>(_data + offset);
+        frame->size = static_cast<I32u>(size);
+        frame->flags = flags;
+        std::memcpy(_data + offset + sizeof(ShmRing::Frame), data, size);
+
+        __atomic_store_n(&_header->head, head + length, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * Waits until the consumer has released all bytes before \p position
+     * minus the capacity. The timeout is restarted whenever the consumer
+     * makes progress.
+     */
+    void await(I64u position)
+    {
+        size_t round = 0;
+        I64u tail = __atomic_load_n(&_header->tail, __ATOMIC_ACQUIRE);
+        Timestamp progress;
+
+        while (position - tail > _capacity)
+        {
+            if (__atomic_load_n(&_header->consumer, __ATOMIC_ACQUIRE) == ShmRing::DETACHED)
+            {
+                throw WriteFileException(format("Consumer detached from shared memory segment `%s`", _name));
+            }
+
+            ShmRing::backoff(round);
+
+            const I64u current = __atomic_load_n(&_header->tail, __ATOMIC_ACQUIRE);
+            if (current != tail)
+            {
+                tail = current;
+                progress.update();
+            }
+            else if (_timeout > 0 && progress.isElapsed(static_cast<Timestamp::TimeDiff>(_timeout) * 1000))
+            {
+                throw WriteFileException(format("Consumer of shared memory segment `%s` made no progress for %lu ms", _name, _timeout));
+            }
+        }
+    }
+
+    const string _name;
+
+    ShmRing::Header* _header;
+
+    char* _data;
+
+    size_t _capacity;
+
+    size_t _size;
+
+    const unsigned long _timeout;
+};
+
+/**
+ * The consuming side of a ShmRing. A minimal reference consumer looks like
+ * this:
+ *
+ * <pre>
+ * ShmRingReader reader(ShmRing::segmentName("/path/to/output/file"));
+ * ShmRingReader::Batch batch;
+ * while (reader.next(batch))
+ * {
+ *     consume(batch.data, batch.size, batch.partial);
+ *     reader.release();
+ * }
+ * </pre>
+ *
+ * The reader removes the segment name once attached, so the segment is freed
+ * as soon as both sides have unmapped it. A reader destroyed before the end
+ * of the stream makes the blocked producer fail instead of waiting for the
+ * timeout.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class ShmRingReader
+{
+public:
+
+    /**
+     * A batch of serialized records pointing into the ring.
+     */
+    struct Batch
+    {
+        const char* data; //!< The first payload byte.
+        size_t size; //!< The number of payload bytes.
+        bool partial; //!< True if the batch is continued by the next one.
+    };
+
+    /**
+     * Attaches to the segment with the given \p name, waiting up to
+     * \p timeout milliseconds for the producer to create and initialize it.
+     */
+    ShmRingReader(const string& name, unsigned long timeout = 60000) :
+        _name(name),
+        _header(NULL),
+        _data(NULL),
+        _capacity(0),
+        _size(0),
+        _next(0)
+    {
+        for (unsigned long waited = 0; !attach(); waited += 10)
+        {
+            if (waited >= timeout)
+            {
+                throw TimeoutException(format("Shared memory segment `%s` was not created within %lu ms", _name, timeout));
+            }
+
+            struct timespec t = { 0, 10000000 };
+            nanosleep(&t, NULL);
+        }
+
+        _capacity = _header->capacity;
+        _next = _header->tail;
+
+        __atomic_store_n(&_header->consumer, static_cast<I32u>(ShmRing::ATTACHED), __ATOMIC_RELEASE);
+        shm_unlink(_name.c_str());
+    }
+
+    /**
+     * Destructor. Detaches from and unmaps the segment.
+     */
+    ~ShmRingReader()
+    {
+        __atomic_store_n(&_header->consumer, static_cast<I32u>(ShmRing::DETACHED), __ATOMIC_RELEASE);
+        munmap(_header, _size);
+    }
+
+    /**
+     * Waits for the next batch. The batch stays valid until release() is
+     * called.
+     *
+     * @return False if the producer has closed the ring and all batches have
+     *         been consumed.
+     */
+    bool next(Batch& batch)
+    {
+        size_t round = 0;
+
+        for (;;)
+        {
+            // read the state before the head, so no frame is missed on close
+            const I32u state = __atomic_load_n(&_header->state, __ATOMIC_ACQUIRE);
+            const I64u head = __atomic_load_n(&_header->head, __ATOMIC_ACQUIRE);
+            const I64u tail = _header->tail;
+
+            if (head != tail)
+            {
+                const I64u offset = tail & (_capacity - 1);
+                const ShmRing::Frame* frame = reinterpret_cast<const ShmRing::Frame*>(_data + offset);
+
+                if (frame->flags & ShmRing::PADDING)
+                {
+                    __atomic_store_n(&_header->tail, tail + (_capacity - offset), __ATOMIC_RELEASE);
+                    continue;
+                }
+
+                batch.data = _data + offset + sizeof(ShmRing::Frame);
+                batch.size = frame->size;
+                batch.partial = (frame->flags & ShmRing::PARTIAL) != 0;
+
+                _next = tail + ShmRing::frameLength(frame->size);
+                return true;
+            }
+
+            if (state == ShmRing::CLOSED)
+            {
+                return false;
+            }
+
+            ShmRing::backoff(round);
+        }
+    }
+
+    /**
+     * Releases the batch returned by the last next() call to the producer.
+     */
+    void release()
+    {
+        __atomic_store_n(&_header->tail, _next, __ATOMIC_RELEASE);
+    }
+
+private:
+
+    /**
+     * Maps the segment if the producer has created and initialized it.
+     *
+     * @return False if the segment does not exist yet, has not been resized
+     *         yet, or its header is still being initialized.
+     */
+    bool attach()
+    {
+        const int fd = shm_open(_name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            if (errno == ENOENT)
+            {
+                return false;
+            }
+
+            throw SystemException(format("Cannot open shared memory segment `%s`: %s", _name, string(std::strerror(errno))));
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw SystemException(format("Cannot stat shared memory segment `%s`: %s", _name, string(std::strerror(error))));
+        }
+
+        // the producer creates the segment before resizing it
+        if (static_cast<size_t>(st.st_size) <= ShmRing::DATA_OFFSET)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        const size_t size = static_cast<size_t>(st.st_size);
+
+        void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+
+        if (memory == MAP_FAILED)
+        {
+            throw SystemException(format("Cannot map shared memory segment `%s`: %s", _name, string(std::strerror(error))));
+        }
+
+        ShmRing::Header* header = static_cast<ShmRing::Header*>(memory);
+
+        // the header is valid once the producer leaves the INITIALIZING state
+        if (__atomic_load_n(&header->state, __ATOMIC_ACQUIRE) == ShmRing::INITIALIZING)
+        {
+            munmap(memory, size);
+            return false;
+        }
+
+        if (std::memcmp(header->magic, ShmRing::MAGIC, sizeof(header->magic)) != 0 || header->version != ShmRing::VERSION || header->capacity + ShmRing::DATA_OFFSET != size)
+        {
+            munmap(memory, size);
+            throw DataException(format("Unsupported shared memory segment format in `%s`", _name));
+        }
+
+        _header = header;
+        _data = static_cast<char*>(memory) + ShmRing::DATA_OFFSET;
+        _size = size;
+        return true;
+    }
+
+    /**
+     * Noncopyable.
+     */
+    ShmRingReader(const ShmRingReader&);
+
+    /**
+     * Noncopyable.
+     */
+    ShmRingReader& operator=(const ShmRingReader&);
+
+    const string _name;
+
+    ShmRing::Header* _header;
+
+    char* _data;
+
+    I64u _capacity;
+
+    size_t _size;
+
+    I64u _next;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* SHMRING_H_ */
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef SHMRINGOUTPUTCOLLECTOR_H_
+#define SHMRINGOUTPUTCOLLECTOR_H_
+
+#include "io/BufferedOutputCollector.h"
+#include "io/ShmRing.h"
+
+#include <Poco/Logger.h>
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The shared memory ring settings for 'shm' output collectors.
+ *
+ * The settings are bound to the 'application.output-shm-size',
+ * 'application.output-shm-batch-size' and 'application.output-shm-timeout'
+ * config parameters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct ShmRingOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param capacity The number of data bytes in the ring.
+     * @param batchSize The maximal size of a record batch in bytes.
+     * @param timeout The time in milliseconds to wait for the consumer while
+     *        the ring is full (0 waits forever).
+     */
+    ShmRingOptions(size_t capacity = 67108864, size_t batchSize = 1048576, unsigned long timeout = 60000) :
+        capacity(capacity),
+        batchSize(batchSize),
+        timeout(timeout)
+    {
+    }
+
+    size_t capacity; //!< The number of data bytes in the ring.
+    size_t batchSize; //!< The maximal size of a record batch.
+    unsigned long timeout; //!< The consumer wait timeout in milliseconds.
+};
+
+/**
+ * An AbstractOutputCollector subclass that writes the output into a
+ * single-producer/single-consumer ring buffer in POSIX shared memory.
+ *
+ * Records are serialized into a local buffer which is published as one ring
+ * frame (a batch of complete records) whenever it is full. The ring segment
+ * is named after the output path (see ShmRing::segmentName()), so co-located
+ * consumers can attach to it with a ShmRingReader.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class ShmRingOutputCollector: public BufferedOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    ShmRingOutputCollector(const Path& outputPath, const ShmRingOptions& options, const String& collectorName) :
+        BufferedOutputCollector<RecordType>(collectorName, std::min(options.batchSize, options.capacity / 4)),
+        _outputPath(outputPath),
+        _options(options),
+        _ring(NULL),
+    	_isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    ShmRingOutputCollector(const ShmRingOutputCollector& o) :
+        BufferedOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _options(o._options),
+        _ring(NULL),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the ring if opened.
+     */
+    virtual ~ShmRingOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Creates the shared memory ring.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            const string name(ShmRing::segmentName(_outputPath.toString()));
+
+            _logger.debug(format("Opening shared memory ring `%s` for output path `%s`", name, _outputPath.toString()));
+
+            _ring = new ShmRingWriter(name, _options.capacity, _options.timeout);
+	        _isOpen = true;
+            BufferedOutputCollector<RecordType>::writeBufferedHeader();
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened shared memory ring for output path `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Writes the footer and closes the ring.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing shared memory ring for output path `%s`", _outputPath.toString()));
+
+	        BufferedOutputCollector<RecordType>::writeBufferedFooter();
+	        _isOpen = false;
+
+	        delete _ring;
+	        _ring = NULL;
+        }
+    }
+
+    /**
+     * Publishes the buffered records.
+     */
+    void flush()
+    {
+        BufferedOutputCollector<RecordType>::flushBuffer();
+    }
+
+protected:
+
+    /**
+     * Publishes a batch of serialized records. The batch is discarded if the
+     * ring is not open.
+     */
+    void writeBytes(const char* data, size_t size)
+    {
+        if (_isOpen)
+        {
+            _ring->write(data, size);
+        }
+    }
+
+private:
+
+    /**
+     * The output path the ring segment name is derived from.
+     */
+    const Path _outputPath;
+
+    /**
+     * The ring settings.
+     */
+    const ShmRingOptions _options;
+
+    /**
+     * The producing side of the ring.
+     */
+    ShmRingWriter* _ring;
+
+    /**
+     * A boolean flag indicating that the \p _ring is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* SHMRINGOUTPUTCOLLECTOR_H_ */
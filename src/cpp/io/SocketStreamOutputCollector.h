@@ -18,9 +18,8 @@
 #ifndef SOCKETSTREAMOUTPUTCOLLECTOR_H_
 #define SOCKETSTREAMOUTPUTCOLLECTOR_H_
 
-#include "io/AbstractOutputCollector.h"
+#include "io/BufferedOutputCollector.h"
 
-#include <Poco/Buffer.h>
 #include <Poco/Logger.h>
 #include <Poco/Net/SocketAddress.h>
 #include <Poco/Net/StreamSocket.h>
@@ -38,7 +37,7 @@ namespace Myriad {
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 template<typename RecordType>
-class SocketStreamOutputCollector: public AbstractOutputCollector<RecordType>
+class SocketStreamOutputCollector: public BufferedOutputCollector<RecordType>
 {
 public:
 
@@ -49,12 +48,10 @@ public:
      * socket specified by the given \p outputPort.
      */
     SocketStreamOutputCollector(const Path& outputPath, const I16u outputPort, const String& collectorName) :
-        AbstractOutputCollector<RecordType>(collectorName),
+        BufferedOutputCollector<RecordType>(collectorName, 4194304), // 4MB buffer
         _outputPath(outputPath),
         _outputSocket(Poco::Net::IPAddress::IPv4),
         _outputPort(outputPort),
-        _outputBufferSize(4194304), // 4MB buffer
-        _outputBuffer(_outputBufferSize),
     	_isOpen(false),
         _logger(Logger::get(collectorName))
     {
@@ -64,12 +61,10 @@ public:
      * Copy constructor.
      */
     SocketStreamOutputCollector(const SocketStreamOutputCollector& o) :
-        AbstractOutputCollector<RecordType>(o),
+        BufferedOutputCollector<RecordType>(o),
         _outputPath(o._outputPath),
         _outputSocket(o._outputSocket),
         _outputPort(o._outputPort),
-        _outputBufferSize(4194304), // 4MB buffer
-        _outputBuffer(_outputBufferSize),
         _isOpen(false),
         _logger(Logger::get(o._logger.name()))
     {
@@ -100,7 +95,6 @@ public:
 
             try
             {
-                Poco::Net::StreamSocket socket(Poco::Net::IPAddress::IPv4);
                 _outputSocket.connect(Poco::Net::SocketAddress("localhost", _outputPort));
             }
             catch(const Poco::Exception& e)
@@ -108,11 +102,8 @@ public:
                 throw RuntimeException(format("Could not connect to socket at address localhost:%hu", _outputPort));
             }
 
-            AbstractOutputCollector<RecordType>::writeHeader(_recordsBuffer);
 	        _isOpen = true;
-
-	        _recordsBuffer.str("");
-			_recordsBuffer.clear();
+            BufferedOutputCollector<RecordType>::writeBufferedHeader();
         }
         else
         {
@@ -129,91 +120,37 @@ public:
         {
 	        _logger.debug(format("Closing socket stream for output path `%s`", _outputPath.toString()));
 
-	        AbstractOutputCollector<RecordType>::writeFooter(_recordsBuffer);
-	        flush();
+	        BufferedOutputCollector<RecordType>::writeBufferedFooter();
 	        _outputSocket.close();
+	        _isOpen = false;
         }
     }
 
     /**
-     * Flushes the internal FileOutputStream instance and resets the flush counter.
+     * Writes the buffered records to the output socket.
      */
     void flush()
     {
-        if (_isOpen)
-        {
-            Poco::Net::SocketStream socketStream(_outputSocket);
-            StreamCopier::copyStream(_recordsBuffer, socketStream, _outputBufferSize);
-            socketStream.flush();
-        }
-
-        _recordsBuffer.str("");
-        _recordsBuffer.clear();
-    }
-
-    /**
-     * Output collection method.
-     */
-    void collect(const RecordType& record)
-    {
-    	std::ostream::pos_type p2, p1 = _recordsBuffer.tellp();
-        if (p1 == -1)
-        {
-        	throw RuntimeException("Failed to read before-position from output stream");
-        }
-
-        SocketStreamOutputCollector<RecordType>::serialize(_recordsBuffer, record);
-
-        p2 = _recordsBuffer.tellp();
-        if (p2 == -1)
-        {
-        	throw RuntimeException("Failed to read after-position from output stream");
-        }
-
-        if (static_cast<size_t>(p2) >= _outputBufferSize)
-        {
-            writeToOutputSocket();
-        }
+        BufferedOutputCollector<RecordType>::flushBuffer();
     }
 
-private:
+protected:
 
     /**
-     * Writes the contents of the \p _recordsBuffer to the \p _outputSocket.
-     *
-     * Internally, the operation uses the \p _outputBuffer to perform copy
-     * operations of \p _outputBufferSize chars at a time.
+     * Writes a block of serialized records to the \p _outputSocket. The
+     * block is discarded if the socket is not open.
      */
-    void writeToOutputSocket()
+    void writeBytes(const char* data, size_t size)
     {
         if (_isOpen)
         {
-            size_t N = static_cast<size_t>(_recordsBuffer.tellp()) / _outputBufferSize;
-
-            for (size_t i = 0; i < N; i++)
-            {
-                _recordsBuffer.read(_outputBuffer.begin(), _outputBufferSize);
-
-                Poco::Net::SocketStream socketStream(_outputSocket);
-                socketStream.write(_outputBuffer.begin(), _recordsBuffer.gcount());
-            }
-
-            _recordsBuffer.read(_outputBuffer.begin(), _outputBufferSize);
-            _recordsBuffer.str("");
-            _recordsBuffer.clear();
-            _recordsBuffer.write(_outputBuffer.begin(), _recordsBuffer.gcount());
-        }
-        else
-        {
-            _recordsBuffer.str("");
-            _recordsBuffer.clear();
+            Poco::Net::SocketStream socketStream(_outputSocket);
+            socketStream.write(data, static_cast<std::streamsize>(size));
+            socketStream.flush();
         }
     }
 
-    /**
-     * A stringstream buffer holding the serialized record objects.
-     */
-    std::stringstream _recordsBuffer;
+private:
 
     /**
      * The path of the underlying OutputStream.
@@ -230,16 +167,6 @@ private:
      */
     const I16u _outputPort;
 
-    /**
-     * The size of buffer that is flushed to the output stream.
-     */
-    size_t _outputBufferSize;
-
-    /**
-     * A char buffer for transfer from the \p _recordsBuffer to the \p _outputSocket.
-     */
-    Poco::Buffer<char> _outputBuffer;
-
     /**
      * A boolean flag indicating that the underlying \p _outputSocket is open.
      */
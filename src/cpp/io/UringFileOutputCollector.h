@@ -0,0 +1,326 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef URINGFILEOUTPUTCOLLECTOR_H_
+#define URINGFILEOUTPUTCOLLECTOR_H_
+
+#include "core/clock.h"
+#include "io/AbstractOutputCollector.h"
+#include "io/UringFileWriter.h"
+
+#include <Poco/Buffer.h>
+#include <Poco/File.h>
+#include <Poco/Logger.h>
+
+#include <sstream>
+
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * An AbstractOutputCollector subclass that writes the output into the local
+ * file system through an UringFileWriter.
+ *
+ * Records are serialized directly into the writer buffers. Every buffer is
+ * filled completely before it is submitted - a record that does not fit into
+ * the rest of the current buffer is serialized into a small spill buffer and
+ * split across the buffer boundary. Because of that, all writes except for
+ * the last one cover whole buffers, which keeps them aligned for direct I/O.
+ *
+ * The OutputCollector factory only uses this collector if
+ * UringFileWriter::available() is true and falls back to the
+ * LocalFileOutputCollector otherwise.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+template<typename RecordType>
+class UringFileOutputCollector: public AbstractOutputCollector<RecordType>
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    UringFileOutputCollector(const Path& outputPath, const WriterOptions& options, const String& collectorName) :
+        AbstractOutputCollector<RecordType>(collectorName),
+        _outputPath(outputPath),
+        _options(options),
+        _writer(NULL),
+        _cursor(NULL),
+        _end(NULL),
+        _spill(65536),
+        _submitted(0),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(collectorName))
+    {
+    }
+
+    /**
+     * Copy constructor.
+     */
+    UringFileOutputCollector(const UringFileOutputCollector& o) :
+        AbstractOutputCollector<RecordType>(o),
+        _outputPath(o._outputPath),
+        _options(o._options),
+        _writer(NULL),
+        _cursor(NULL),
+        _end(NULL),
+        _spill(o._spill.size()),
+        _submitted(0),
+        _writeNanos(0),
+        _isOpen(false),
+        _logger(Logger::get(o._logger.name()))
+    {
+        if (o._isOpen)
+        {
+	        open();
+        }
+    }
+
+    /**
+     * Destructor.
+     *
+     * Closes the underlying file if opened.
+     */
+    virtual ~UringFileOutputCollector()
+    {
+        close();
+    }
+
+    /**
+     * Opens the underlying file.
+     */
+    void open()
+    {
+        if (!_isOpen)
+        {
+            _logger.debug(format("Opening io_uring local file for output path `%s`", _outputPath.toString()));
+
+	        // make sure that the output-dir exists
+	        File outputDir(_outputPath.parent());
+            outputDir.createDirectories();
+
+	        _writer = new UringFileWriter(_outputPath.toString(), _options);
+	        _submitted = 0;
+	        _cursor = _writer->buffer();
+	        _end = _cursor + _writer->capacity();
+	        _isOpen = true;
+
+	        if (_options.direct && !_writer->direct())
+	        {
+	            _logger.information(format("O_DIRECT is not supported for output path `%s`", _outputPath.toString()));
+	        }
+
+	        std::ostringstream out;
+	        AbstractOutputCollector<RecordType>::writeHeader(out);
+	        const std::string header(out.str());
+	        writeBytes(header.data(), header.size());
+        }
+        else
+        {
+	        throw LogicException(format("Can't open already opened local file at `%s`", _outputPath.toString()));
+        }
+    }
+
+    /**
+     * Writes the remaining output and closes the underlying file.
+     */
+    void close()
+    {
+        if (_isOpen)
+        {
+	        _logger.debug(format("Closing io_uring local file for output path `%s`", _outputPath.toString()));
+
+	        std::ostringstream out;
+	        AbstractOutputCollector<RecordType>::writeFooter(out);
+	        const std::string footer(out.str());
+	        writeBytes(footer.data(), footer.size());
+
+	        _isOpen = false;
+	        _submitted += static_cast<I64u>(_cursor - _writer->buffer());
+	        _writer->close(static_cast<size_t>(_cursor - _writer->buffer()));
+	        delete _writer;
+	        _writer = NULL;
+        }
+    }
+
+    /**
+     * Waits for the writes in flight. Without direct I/O, the partially
+     * filled current buffer is written as well.
+     */
+    void flush()
+    {
+        if (_isOpen)
+        {
+            const I64u start = monotonicNanos();
+            if (!_writer->direct())
+            {
+                _submitted += static_cast<I64u>(_cursor - _writer->buffer());
+                nextBuffer(_writer->submit(static_cast<size_t>(_cursor - _writer->buffer())));
+            }
+            _writer->drain();
+            _writeNanos += monotonicNanos() - start;
+        }
+    }
+
+    /**
+     * Output collection method.
+     */
+    void collect(const RecordType& record)
+    {
+        if (!AbstractOutputCollector<RecordType>::serialize(_cursor, _end, record))
+        {
+            char* spill = _spill.begin();
+
+            if (AbstractOutputCollector<RecordType>::serialize(spill, _spill.end(), record))
+            {
+                writeBytes(_spill.begin(), static_cast<size_t>(spill - _spill.begin()));
+            }
+            else
+            {
+                // the record does not fit into the spill buffer
+                std::ostringstream out;
+                AbstractOutputCollector<RecordType>::serialize(out, record);
+                const std::string s(out.str());
+                writeBytes(s.data(), s.size());
+            }
+        }
+    }
+
+    /**
+     * Returns the number of bytes submitted for writing plus the number of
+     * bytes serialized into the current buffer.
+     */
+    I64u writtenBytes() const
+    {
+        return _writer != NULL ? _submitted + static_cast<I64u>(_cursor - _writer->buffer()) : _submitted;
+    }
+
+    /**
+     * Returns the number of nanoseconds spent in submitting and waiting for
+     * writes so far.
+     */
+    I64u writeNanos() const
+    {
+        return _writeNanos;
+    }
+
+    /**
+     * Returns the number of buffers with writes in flight.
+     */
+    I64u queueDepth() const
+    {
+        return _writer != NULL ? _writer->inFlight() : 0;
+    }
+
+private:
+
+    /**
+     * Copies \p size bytes starting at \p data into the writer buffers and
+     * submits each buffer as soon as it is full.
+     */
+    void writeBytes(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const size_t n = std::min(size, static_cast<size_t>(_end - _cursor));
+            std::memcpy(_cursor, data, n);
+            _cursor += n;
+            data += n;
+            size -= n;
+
+            if (_cursor == _end)
+            {
+                // submit() blocks only if all buffers are in flight
+                const I64u start = monotonicNanos();
+                _submitted += _writer->capacity();
+                nextBuffer(_writer->submit(_writer->capacity()));
+                _writeNanos += monotonicNanos() - start;
+            }
+        }
+    }
+
+    /**
+     * Continues serialization at the start of the given \p buffer.
+     */
+    void nextBuffer(char* buffer)
+    {
+        _cursor = buffer;
+        _end = buffer + _writer->capacity();
+    }
+
+    /**
+     * The path of the output file.
+     */
+    const Path _outputPath;
+
+    /**
+     * The writer settings.
+     */
+    const WriterOptions _options;
+
+    /**
+     * The writer of the open file.
+     */
+    UringFileWriter* _writer;
+
+    /**
+     * The current write position in the current writer buffer.
+     */
+    char* _cursor;
+
+    /**
+     * The end of the current writer buffer.
+     */
+    char* _end;
+
+    /**
+     * A buffer for records that span two writer buffers.
+     */
+    Poco::Buffer<char> _spill;
+
+    /**
+     * The number of bytes handed over to the writer so far.
+     */
+    I64u _submitted;
+
+    /**
+     * The number of nanoseconds spent in submitting and waiting for writes.
+     */
+    I64u _writeNanos;
+
+    /**
+     * A boolean flag indicating that the output file is open.
+     */
+    bool _isOpen;
+
+    /**
+     * Logger instance.
+     */
+    Logger& _logger;
+};
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* URINGFILEOUTPUTCOLLECTOR_H_ */
@@ -0,0 +1,644 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef URINGFILEWRITER_H_
+#define URINGFILEWRITER_H_
+
+#include "core/types.h"
+
+#include <Poco/Exception.h>
+#include <Poco/Format.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#endif
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup io
+ * @{*/
+
+/**
+ * The asynchronous writer settings for file output collectors.
+ *
+ * The settings are bound to the 'application.output-writer',
+ * 'application.output-writer-depth', 'application.output-writer-buffer-size',
+ * and 'application.output-direct-io' config parameters.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+struct WriterOptions
+{
+    /**
+     * Constructor.
+     *
+     * @param backend The writer backend ('stream' or 'uring').
+     * @param depth The number of buffers in flight.
+     * @param bufferSize The size of each buffer in bytes.
+     * @param direct Whether the file should be opened with O_DIRECT.
+     */
+    WriterOptions(const String& backend = "stream", size_t depth = 4, size_t bufferSize = 4194304, bool direct = false) :
+        backend(backend),
+        depth(depth),
+        bufferSize(bufferSize),
+        direct(direct)
+    {
+    }
+
+    /**
+     * Returns true if the io_uring writer backend is requested.
+     */
+    bool enabled() const
+    {
+        return backend == "uring";
+    }
+
+    String backend; //!< The writer backend.
+    size_t depth; //!< The number of buffers in flight.
+    size_t bufferSize; //!< The size of each buffer.
+    bool direct; //!< Whether to bypass the page cache.
+};
+
+#if defined(__NR_io_uring_setup)
+
+/**
+ * A sequential file writer based on the Linux io_uring interface.
+ *
+ * The writer owns WriterOptions::depth page-aligned buffers which are
+ * registered with the kernel as fixed buffers, so the kernel does not need
+ * to map the buffer pages for every write. Clients fill the buffer returned
+ * by buffer() and hand it over with submit(), which queues an asynchronous
+ * write at the current file offset and returns the next free buffer. The
+ * calling thread only blocks if all buffers are in flight, so up to
+ * \p depth writes are outstanding per file without additional threads.
+ *
+ * With WriterOptions::direct, the file is opened with <tt>O_DIRECT</tt> if
+ * the file system supports it. Direct writes must start at block aligned
+ * offsets, so all submitted buffers except for the last one must be full.
+ * The last buffer is padded to the alignment and the file is truncated to
+ * its real length by close().
+ *
+ * The io_uring system calls are used directly, so no additional library is
+ * required. If the buffers cannot be registered (e.g. because of the
+ * <tt>RLIMIT_MEMLOCK</tt> limit), plain vectored writes are used instead.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class UringFileWriter
+{
+public:
+
+    /**
+     * The alignment of the buffers and of direct writes.
+     */
+    static const size_t ALIGNMENT = 4096;
+
+    /**
+     * Checks whether io_uring is supported by the running kernel and
+     * permitted for the current process.
+     */
+    static bool available()
+    {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        long fd = syscall(__NR_io_uring_setup, 1, &params);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        ::close(static_cast<int>(fd));
+        return true;
+    }
+
+    /**
+     * Constructor. Creates (or truncates) the file at the given \p path.
+     */
+    UringFileWriter(const string& path, const WriterOptions& options) :
+        _path(path),
+        _fd(-1),
+        _ringFd(-1),
+        _direct(false),
+        _fixed(false),
+        _bufferSize((std::max<size_t>(options.bufferSize, 1) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT),
+        _slots(std::max<size_t>(options.depth, 1)),
+        _current(0),
+        _inFlight(0),
+        _offset(0),
+        _sqRing(MAP_FAILED),
+        _cqRing(MAP_FAILED),
+        _sqes(MAP_FAILED)
+    {
+        try
+        {
+            openFile(options.direct);
+            setupRing();
+            allocateBuffers();
+        }
+        catch(...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    /**
+     * Destructor. Waits for the writes in flight but does not write the
+     * current buffer.
+     */
+    ~UringFileWriter()
+    {
+        try
+        {
+            while (_inFlight > 0)
+            {
+                reap();
+            }
+        }
+        catch(...)
+        {
+        }
+
+        release();
+    }
+
+    /**
+     * Returns the start of the current buffer.
+     */
+    char* buffer()
+    {
+        return _slots[_current].data;
+    }
+
+    /**
+     * Returns the capacity of each buffer.
+     */
+    size_t capacity() const
+    {
+        return _bufferSize;
+    }
+
+    /**
+     * Returns true if the file has been opened with O_DIRECT.
+     */
+    bool direct() const
+    {
+        return _direct;
+    }
+
+    /**
+     * Returns the number of buffers with writes in flight.
+     */
+    size_t inFlight() const
+    {
+        return _inFlight;
+    }
+
+    /**
+     * Queues the write of the first \p length bytes of the current buffer at
+     * the end of the file and returns the next free buffer.
+     */
+    char* submit(size_t length)
+    {
+        if (length > 0)
+        {
+            Slot& slot = _slots[_current];
+
+            slot.length = length;
+            slot.written = 0;
+            slot.offset = _offset;
+            _offset += length;
+
+            // direct writes must cover whole blocks
+            if (_direct && length % ALIGNMENT != 0)
+            {
+                size_t padded = (length + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+                std::memset(slot.data + length, 0, padded - length);
+                slot.length = padded;
+            }
+
+            slot.busy = true;
+            _inFlight++;
+            enqueue(_current);
+
+            // advance to the next free buffer
+            _current = (_current + 1) % _slots.size();
+            while (_slots[_current].busy)
+            {
+                reap();
+            }
+        }
+
+        return _slots[_current].data;
+    }
+
+    /**
+     * Waits until all queued writes are completed.
+     */
+    void drain()
+    {
+        while (_inFlight > 0)
+        {
+            reap();
+        }
+    }
+
+    /**
+     * Writes the first \p length bytes of the current buffer, waits for all
+     * writes, truncates the file to its real length, and closes it.
+     */
+    void close(size_t length)
+    {
+        submit(length);
+        drain();
+
+        if (ftruncate(_fd, static_cast<off_t>(_offset)) != 0)
+        {
+            throw WriteFileException(format("Cannot truncate output file `%s`: %s", _path, string(std::strerror(errno))));
+        }
+
+        release();
+    }
+
+private:
+
+    /**
+     * A buffer together with the state of its pending write.
+     */
+    struct Slot
+    {
+        Slot() :
+            data(NULL),
+            length(0),
+            written(0),
+            offset(0),
+            busy(false)
+        {
+        }
+
+        char* data;
+        size_t length;
+        size_t written;
+        I64u offset;
+        struct iovec iov;
+        bool busy;
+    };
+
+    /**
+     * Noncopyable.
+     */
+    UringFileWriter(const UringFileWriter&);
+
+    /**
+     * Noncopyable.
+     */
+    UringFileWriter& operator=(const UringFileWriter&);
+
+    void openFile(bool direct)
+    {
+        if (direct)
+        {
+            _fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+            _direct = _fd >= 0;
+        }
+
+        // not all file systems support O_DIRECT (e.g. tmpfs)
+        if (_fd < 0)
+        {
+            _fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        }
+
+        if (_fd < 0)
+        {
+            throw OpenFileException(format("Cannot open output file `%s`: %s", _path, string(std::strerror(errno))));
+        }
+    }
+
+    void setupRing()
+    {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        long fd = syscall(__NR_io_uring_setup, static_cast<unsigned>(_slots.size()), &params);
+        if (fd < 0)
+        {
+            throw SystemException(format("Cannot set up io_uring instance: %s", string(std::strerror(errno))));
+        }
+        _ringFd = static_cast<int>(fd);
+
+        _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        _sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+        _sqRing = mmap(NULL, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+        _cqRing = mmap(NULL, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_CQ_RING);
+        _sqes = mmap(NULL, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+
+        if (_sqRing == MAP_FAILED || _cqRing == MAP_FAILED || _sqes == MAP_FAILED)
+        {
+            throw SystemException(format("Cannot map io_uring queues: %s", string(std::strerror(errno))));
+        }
+
+        char* sq = static_cast<char*>(_sqRing);
+        _sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(_cqRing);
+        _cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    void allocateBuffers()
+    {
+        std::vector<struct iovec> iovecs(_slots.size());
+
+        for (size_t i = 0; i < _slots.size(); i++)
+        {
+            void* data = NULL;
+            if (posix_memalign(&data, ALIGNMENT, _bufferSize) != 0)
+            {
+                throw OutOfMemoryException(format("Cannot allocate %z bytes for output buffers", _bufferSize));
+            }
+
+            _slots[i].data = static_cast<char*>(data);
+            iovecs[i].iov_base = data;
+            iovecs[i].iov_len = _bufferSize;
+        }
+
+        // fall back to vectored writes if the buffers cannot be registered
+        _fixed = syscall(__NR_io_uring_register, _ringFd, IORING_REGISTER_BUFFERS, &iovecs[0], static_cast<unsigned>(iovecs.size())) == 0;
+    }
+
+    /**
+     * Queues the write of the remaining bytes of the slot with the given
+     * \p index and enters the kernel to submit it.
+     */
+    void enqueue(size_t index)
+    {
+        Slot& slot = _slots[index];
+
+        const unsigned tail = *_sqTail;
+        const unsigned i = tail & _sqMask;
+
+        struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(_sqes) + i;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->fd = _fd;
+        sqe->off = slot.offset + slot.written;
+        sqe->user_data = index;
+
+        if (_fixed)
+        {
+            sqe->opcode = IORING_OP_WRITE_FIXED;
+            sqe->addr = reinterpret_cast<unsigned long>(slot.data + slot.written);
+            sqe->len = static_cast<unsigned>(slot.length - slot.written);
+            sqe->buf_index = static_cast<unsigned short>(index);
+        }
+        else
+        {
+            slot.iov.iov_base = slot.data + slot.written;
+            slot.iov.iov_len = slot.length - slot.written;
+            sqe->opcode = IORING_OP_WRITEV;
+            sqe->addr = reinterpret_cast<unsigned long>(&slot.iov);
+            sqe->len = 1;
+        }
+
+        _sqArray[i] = i;
+        __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        while (syscall(__NR_io_uring_enter, _ringFd, 1, 0, 0, NULL, 0) < 0)
+        {
+            if (errno != EINTR && errno != EAGAIN)
+            {
+                throw WriteFileException(format("Cannot submit write to `%s`: %s", _path, string(std::strerror(errno))));
+            }
+        }
+    }
+
+    /**
+     * Waits for a single completion and releases or resubmits its buffer.
+     */
+    void reap()
+    {
+        unsigned head = *_cqHead;
+
+        while (head == __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE))
+        {
+            if (syscall(__NR_io_uring_enter, _ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+            {
+                throw WriteFileException(format("Cannot wait for writes to `%s`: %s", _path, string(std::strerror(errno))));
+            }
+        }
+
+        const struct io_uring_cqe& cqe = _cqes[head & _cqMask];
+        const size_t index = static_cast<size_t>(cqe.user_data);
+        const int result = cqe.res;
+        __atomic_store_n(_cqHead, head + 1, __ATOMIC_RELEASE);
+
+        Slot& slot = _slots[index];
+
+        if (result < 0)
+        {
+            slot.busy = false;
+            _inFlight--;
+            throw WriteFileException(format("Cannot write to `%s`: %s", _path, string(std::strerror(-result))));
+        }
+
+        slot.written += static_cast<size_t>(result);
+
+        if (slot.written < slot.length && result > 0)
+        {
+            // resubmit the rest of a short write
+            enqueue(index);
+        }
+        else if (slot.written < slot.length)
+        {
+            slot.busy = false;
+            _inFlight--;
+            throw WriteFileException(format("Cannot write to `%s`: no progress", _path));
+        }
+        else
+        {
+            slot.busy = false;
+            _inFlight--;
+        }
+    }
+
+    void release()
+    {
+        if (_sqes != MAP_FAILED)
+        {
+            munmap(_sqes, _sqesSize);
+            _sqes = MAP_FAILED;
+        }
+        if (_cqRing != MAP_FAILED)
+        {
+            munmap(_cqRing, _cqRingSize);
+            _cqRing = MAP_FAILED;
+        }
+        if (_sqRing != MAP_FAILED)
+        {
+            munmap(_sqRing, _sqRingSize);
+            _sqRing = MAP_FAILED;
+        }
+        if (_ringFd >= 0)
+        {
+            ::close(_ringFd);
+            _ringFd = -1;
+        }
+        if (_fd >= 0)
+        {
+            ::close(_fd);
+            _fd = -1;
+        }
+        for (size_t i = 0; i < _slots.size(); i++)
+        {
+            std::free(_slots[i].data);
+            _slots[i].data = NULL;
+        }
+    }
+
+    const string _path;
+
+    int _fd;
+
+    int _ringFd;
+
+    bool _direct;
+
+    bool _fixed;
+
+    const size_t _bufferSize;
+
+    std::vector<Slot> _slots;
+
+    size_t _current;
+
+    size_t _inFlight;
+
+    I64u _offset;
+
+    void* _sqRing;
+
+    void* _cqRing;
+
+    void* _sqes;
+
+    size_t _sqRingSize;
+
+    size_t _cqRingSize;
+
+    size_t _sqesSize;
+
+    unsigned* _sqTail;
+
+    unsigned _sqMask;
+
+    unsigned* _sqArray;
+
+    unsigned* _cqHead;
+
+    unsigned* _cqTail;
+
+    unsigned _cqMask;
+
+    struct io_uring_cqe* _cqes;
+};
+
+#else
+
+/**
+ * A placeholder for platforms without io_uring support.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class UringFileWriter
+{
+public:
+
+    static bool available()
+    {
+        return false;
+    }
+
+    UringFileWriter(const string& path, const WriterOptions& options)
+    {
+        throw NotImplementedException("io_uring is not supported on this platform");
+    }
+
+    char* buffer()
+    {
+        return NULL;
+    }
+
+    size_t capacity() const
+    {
+        return 0;
+    }
+
+    bool direct() const
+    {
+        return false;
+    }
+
+    size_t inFlight() const
+    {
+        return 0;
+    }
+
+    char* submit(size_t length)
+    {
+        return NULL;
+    }
+
+    void drain()
+    {
+    }
+
+    void close(size_t length)
+    {
+    }
+};
+
+#endif
+
+/** @}*/// add to io group
+} // namespace Myriad
+
+#endif /* URINGFILEWRITER_H_ */
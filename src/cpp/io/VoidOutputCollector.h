@@ -18,7 +18,7 @@
 #ifndef VOIDOUTPUTCOLLECTOR_H_
 #define VOIDOUTPUTCOLLECTOR_H_
 
-#include "io/AbstractOutputCollector.h"
+#include "io/BufferedOutputCollector.h"
 
 #include <Poco/Buffer.h>
 #include <Poco/Logger.h>
@@ -32,10 +32,13 @@ namespace Myriad {
 /**
  * A VoidOutputCollector subclass that merely consumes the output.
  *
+ * Records are serialized into a small buffer which is discarded whenever it
+ * fills up, so the serialization cost is still measured.
+ *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 template<typename RecordType>
-class VoidOutputCollector: public AbstractOutputCollector<RecordType>
+class VoidOutputCollector: public BufferedOutputCollector<RecordType>
 {
 public:
 
@@ -45,7 +48,7 @@ public:
      * Opens a null output stream.
      */
     VoidOutputCollector(const Path& outputPath, const String& collectorName) :
-        AbstractOutputCollector<RecordType>(collectorName),
+        BufferedOutputCollector<RecordType>(collectorName, 65536), // 64kB buffer
         _outputPath(outputPath),
         _isOpen(false),
         _logger(Logger::get(collectorName))
@@ -56,7 +59,7 @@ public:
      * Copy constructor.
      */
     VoidOutputCollector(const VoidOutputCollector& o) :
-        AbstractOutputCollector<RecordType>(o),
+        BufferedOutputCollector<RecordType>(o),
         _outputPath(o._outputPath),
         _isOpen(false),
         _logger(Logger::get(o._logger.name()))
@@ -104,8 +107,10 @@ public:
         {
             _logger.debug(format("Closing null output stream for output path `%s`", _outputPath.toString()));
 
+            BufferedOutputCollector<RecordType>::flushBuffer();
             AbstractOutputCollector<RecordType>::writeFooter(_outputStream);
             flush();
+            _isOpen = false;
         }
     }
 
@@ -120,12 +125,13 @@ public:
         }
     }
 
+protected:
+
     /**
-     * Output collection method.
+     * Discards a block of serialized records.
      */
-    void collect(const RecordType& record)
+    void writeBytes(const char* data, size_t size)
     {
-        VoidOutputCollector<RecordType>::serialize(_outputStream, record);
     }
 
 private:
@@ -18,11 +18,13 @@
 #ifndef COMBINEDPRFUNCTION_H_
 #define COMBINEDPRFUNCTION_H_
 
+#include "core/BinarySpecification.h"
 #include "core/exceptions.h"
 #include "core/types.h"
 #include "math/Function.h"
 
 #include <Poco/Any.h>
+#include <Poco/AutoPtr.h>
 #include <Poco/File.h>
 #include <Poco/NumberParser.h>
 #include <Poco/Path.h>
@@ -46,6 +48,11 @@ namespace Myriad
  * distinct values, a set of bucket probabilities, and a special probability for
  * the \p T domain NULL value.
  *
+ * If a precompiled BinarySpecification exists next to the configuration file,
+ * it is used instead of the textual one. In that case, the probability arrays
+ * point directly into the read-only file mapping, and only the domain values
+ * and buckets are decoded into private arrays.
+ *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 template<typename T>
@@ -285,6 +292,17 @@ public:
      */
     void initialize(istream& in, size_t& currentLineNumber);
 
+    /**
+     * Initialization routine.
+     *
+     * Initializes the function with the combined function section stored at
+     * the given byte \p offset of a mapped binary \p specification.
+     *
+     * @param specification The mapped binary specification.
+     * @param offset The byte offset of the combined function section.
+     */
+    void initialize(const AutoPtr<BinarySpecification>& specification, size_t offset);
+
     /**
      * Returns the number of buckets for this (configured) function.
      *
@@ -333,6 +351,8 @@ public:
 
 private:
 
+    template<typename T1, typename T2> friend class ConditionalCombinedPrFunction;
+
     void reset();
 
     void normalize();
@@ -343,6 +363,8 @@ private:
 
     size_t findBucket(const T x, bool exact = true) const;
 
+    T valueAt(const size_t i, const Decimal y) const;
+
     static RegularExpression headerLine1Format;
     static RegularExpression headerLine2Format;
     static RegularExpression headerLine3Format;
@@ -366,6 +388,8 @@ private:
     Decimal* _cumulativeProbabilites;
 
     Decimal _EPSILON;
+
+    AutoPtr<BinarySpecification> _specification;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -424,7 +448,10 @@ void CombinedPrFunction<T>::reset()
     _valueProbability = 0.0;
     _bucketProbability = 0.0;
 
-    if (_numberOfValues > 0 || _numberOfBuckets > 0)
+    // probability arrays of mapped specifications are not owned
+    bool ownsProbabilities = _specification.isNull();
+
+    if ((_numberOfValues > 0 || _numberOfBuckets > 0) && ownsProbabilities)
     {
         delete[] _cumulativeProbabilites;
     }
@@ -433,15 +460,23 @@ void CombinedPrFunction<T>::reset()
     {
         _numberOfValues = 0;
         delete[] _values;
-        delete[] _valueProbabilities;
+        if (ownsProbabilities)
+        {
+            delete[] _valueProbabilities;
+        }
     }
 
     if (_numberOfBuckets > 0)
     {
         _numberOfBuckets = 0;
         delete[] _buckets;
-        delete[] _bucketProbabilities;
+        if (ownsProbabilities)
+        {
+            delete[] _bucketProbabilities;
+        }
     }
+
+    _specification = NULL;
 }
 
 template<typename T>
@@ -690,6 +725,12 @@ void CombinedPrFunction<T>::initialize(const Path& path)
         throw ConfigException(format("Cannot find file at `%s`", path.toString()));
     }
 
+    if (BinarySpecification::available(path))
+    {
+        initialize(new BinarySpecification(BinarySpecification::compiledPath(path), BinarySpecification::COMBINED_PR_FUNCTION), sizeof(BinarySpecification::Header));
+        return;
+    }
+
     File file(path);
 
     if (!file.canRead())
@@ -940,6 +981,92 @@ void CombinedPrFunction<T>::initialize(istream& in, size_t& currentLineNumber)
     }
 }
 
+template<typename T>
+void CombinedPrFunction<T>::initialize(const AutoPtr<BinarySpecification>& specification, size_t offset)
+{
+    // reset old state
+    reset();
+
+    const I32u encoding = specification->header().valueEncoding;
+
+    // read section header
+    const I64u* counts = specification->at<I64u>(offset, 2);
+    const Decimal* probabilities = specification->at<Decimal>(offset + 2 * sizeof(I64u), 3);
+
+    if (counts[0] > numeric_limits<size_t>::max()/4U || counts[1] > numeric_limits<size_t>::max()/4U || counts[0] + counts[1] == 0)
+    {
+        throw DataException(format("Invalid number of values or buckets in binary specification `%s`", specification->path()));
+    }
+
+    size_t numberOfValues = static_cast<size_t>(counts[0]);
+    size_t numberOfBuckets = static_cast<size_t>(counts[1]);
+
+    // compute section layout
+    size_t valuesOffset = offset + 2 * sizeof(I64u) + 3 * sizeof(Decimal);
+    size_t valueProbabilitiesOffset = valuesOffset + numberOfValues * sizeof(I64);
+    size_t bucketBoundsOffset = valueProbabilitiesOffset + numberOfValues * sizeof(Decimal);
+    size_t bucketProbabilitiesOffset = bucketBoundsOffset + 2 * numberOfBuckets * sizeof(I64);
+    size_t cumulativeProbabilitiesOffset = bucketProbabilitiesOffset + numberOfBuckets * sizeof(Decimal);
+
+    const I64* values = specification->at<I64>(valuesOffset, numberOfValues);
+    const I64* bucketBounds = specification->at<I64>(bucketBoundsOffset, 2 * numberOfBuckets);
+
+    _specification = specification;
+
+    _notNullProbability = probabilities[0];
+    _valueProbability = probabilities[1];
+    _bucketProbability = probabilities[2];
+
+    // probabilities are used in place
+    _valueProbabilities = const_cast<Decimal*>(specification->at<Decimal>(valueProbabilitiesOffset, numberOfValues));
+    _bucketProbabilities = const_cast<Decimal*>(specification->at<Decimal>(bucketProbabilitiesOffset, numberOfBuckets));
+    _cumulativeProbabilites = const_cast<Decimal*>(specification->at<Decimal>(cumulativeProbabilitiesOffset, numberOfValues + numberOfBuckets));
+
+    // values and buckets are decoded
+    _numberOfValues = numberOfValues;
+    if (_numberOfValues > 0)
+    {
+        _values = new T[_numberOfValues];
+
+        for (size_t i = 0; i < _numberOfValues; i++)
+        {
+            _values[i] = BinarySpecificationSlot<T>::decode(values + i, encoding);
+        }
+    }
+
+    _numberOfBuckets = numberOfBuckets;
+    if (_numberOfBuckets > 0)
+    {
+        _buckets = new Interval<T>[_numberOfBuckets];
+
+        for (size_t i = 0; i < _numberOfBuckets; i++)
+        {
+            _buckets[i].set(BinarySpecificationSlot<T>::decode(bucketBounds + 2*i, encoding), BinarySpecificationSlot<T>::decode(bucketBounds + 2*i + 1, encoding));
+        }
+    }
+
+    // compute active domain
+    T min, max;
+
+    if (_numberOfValues == 0)
+    {
+        min = _buckets[0].min();
+        max = _buckets[_numberOfBuckets-1].max();
+    }
+    else if (_numberOfBuckets == 0)
+    {
+        min = _values[0];
+        max = static_cast<T>(_values[_numberOfValues-1]+1);
+    }
+    else
+    {
+        min = std::min<T>(_buckets[0].min(), _values[0]);
+        max = std::max<T>(_buckets[_numberOfBuckets-1].max(), static_cast<T>(_values[_numberOfValues-1]+1));
+    }
+
+    _activeDomain.set(min, max);
+}
+
 template<typename T>
 inline size_t CombinedPrFunction<T>::numberOfBuckets() const
 {
@@ -1037,38 +1164,46 @@ T CombinedPrFunction<T>::invcdf(Decimal y) const
 {
     if (y < _notNullProbability)
     {
-        size_t i = findIndex(y);
-
-        if (i < _numberOfValues)
-        {
-	        return _values[i];
-        }
-        else
-        {
-	        const Interval<T>& b = _buckets[i-_numberOfValues];
-	        Decimal cdfBefore = i > 0 ? _cumulativeProbabilites[i-1] : 0;
+        return valueAt(findIndex(y), y);
+    }
+    else
+    {
+        return nullValue<T>();
+    }
+}
 
-	        Decimal z = ((y - cdfBefore) / _bucketProbabilities[i-_numberOfValues]) * b.length();
+/**
+ * Returns the domain value associated with the cumulative probability \p y,
+ * where \p i is the cumulative probability index found for \p y.
+ */
+template<typename T>
+inline T CombinedPrFunction<T>::valueAt(const size_t i, const Decimal y) const
+{
+    if (i < _numberOfValues)
+    {
+        return _values[i];
+    }
+    else
+    {
+        const Interval<T>& b = _buckets[i-_numberOfValues];
+        Decimal cdfBefore = i > 0 ? _cumulativeProbabilites[i-1] : 0;
 
-	        T x = static_cast<T>(b.min() + static_cast<I32u>(z));
+        Decimal z = ((y - cdfBefore) / _bucketProbabilities[i-_numberOfValues]) * b.length();
 
-	        if ((z - static_cast<I32u>(z) >= 0.999999))
-	        {
-		        x++;
-	        }
+        T x = static_cast<T>(b.min() + static_cast<I32u>(z));
 
-	        // FIXME: a quick and dirty hack to protect against out of range behavior, needs rewrite
-	        if (x >= b.max())
-	        {
-		        x--;
-	        }
+        if ((z - static_cast<I32u>(z) >= 0.999999))
+        {
+            x++;
+        }
 
-	        return x;
+        // FIXME: a quick and dirty hack to protect against out of range behavior, needs rewrite
+        if (x >= b.max())
+        {
+            x--;
         }
-    }
-    else
-    {
-        return nullValue<T>();
+
+        return x;
     }
 }
 
@@ -23,6 +23,7 @@
 #include "math/probability/CombinedPrFunction.h"
 
 #include <Poco/Any.h>
+#include <Poco/AutoPtr.h>
 #include <Poco/Exception.h>
 #include <Poco/String.h>
 #include <Poco/RegularExpression.h>
@@ -47,6 +48,17 @@ namespace Myriad
  * CombinedProbabilityFunction objects, each one defining the probability
  * conditioned on a range of \p T2 values from the condition domain.
  *
+ * After loading, the function prepares a lookup table that is kept in a
+ * single contiguous allocation. The table contains a guide table for each
+ * of the conditional components, which allows sampling from a component in
+ * expected constant time. If \p T2 is an integral type with a sufficiently
+ * small condition domain, the table also contains a dense index that maps
+ * each \p x2 value directly to its component, so that the binary search over
+ * the condition buckets can be skipped.
+ *
+ * As with CombinedPrFunction, a precompiled BinarySpecification located next
+ * to the configuration file is preferred over the textual one.
+ *
  * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
  */
 template<typename T1, typename T2>
@@ -63,7 +75,7 @@ public:
      * @param path The location of the function configuration file.
      */
     ConditionalCombinedPrFunction(const string& path) :
-        BivariatePrFunction<T1, T2>(""), _numberOfx2Buckets(0), _x1Pr(NULL)
+        BivariatePrFunction<T1, T2>(""), _numberOfx2Buckets(0), _x2Buckets(NULL), _x1Pr(NULL), _x2IndexSize(0), _lookupTable(NULL), _x2Index(NULL), _x1GuideOffsets(NULL), _x1Guides(NULL)
     {
         initialize(path);
     }
@@ -78,7 +90,7 @@ public:
      * @param path The location of the function configuration file.
      */
     ConditionalCombinedPrFunction(const string& name, const string& path) :
-        BivariatePrFunction<T1, T2>(name), _numberOfx2Buckets(0), _x1Pr(NULL)
+        BivariatePrFunction<T1, T2>(name), _numberOfx2Buckets(0), _x2Buckets(NULL), _x1Pr(NULL), _x2IndexSize(0), _lookupTable(NULL), _x2Index(NULL), _x1GuideOffsets(NULL), _x1Guides(NULL)
     {
         initialize(path);
     }
@@ -92,7 +104,7 @@ public:
      * @param params An array containing the required function parameters.
      */
     ConditionalCombinedPrFunction(map<string, Any>& params) :
-        BivariatePrFunction<T1, T2>(""), _numberOfx2Buckets(0), _x1Pr(NULL)
+        BivariatePrFunction<T1, T2>(""), _numberOfx2Buckets(0), _x2Buckets(NULL), _x1Pr(NULL), _x2IndexSize(0), _lookupTable(NULL), _x2Index(NULL), _x1GuideOffsets(NULL), _x1Guides(NULL)
     {
         initialize(AnyCast<string>(params["path"]));
     }
@@ -107,7 +119,7 @@ public:
      * @param params An array containing the required function parameters.
      */
     ConditionalCombinedPrFunction(const string& name, map<string, Any>& params) :
-        BivariatePrFunction<T1, T2>(name), _numberOfx2Buckets(0), _x1Pr(NULL)
+        BivariatePrFunction<T1, T2>(name), _numberOfx2Buckets(0), _x2Buckets(NULL), _x1Pr(NULL), _x2IndexSize(0), _lookupTable(NULL), _x2Index(NULL), _x1GuideOffsets(NULL), _x1Guides(NULL)
     {
         initialize(AnyCast<string>(params["path"]));
     }
@@ -140,6 +152,16 @@ public:
      */
     void initialize(istream& path);
 
+    /**
+     * Initialization routine.
+     *
+     * Initializes the function with the configuration stored in the given
+     * mapped binary \p specification.
+     *
+     * @param specification The mapped binary specification.
+     */
+    void initialize(const AutoPtr<BinarySpecification>& specification);
+
     /**
      * @see UnivariatePrFunction::operator()
      */
@@ -165,18 +187,51 @@ public:
      */
     T1 sample(Decimal r, T2 x2) const;
 
+    /**
+     * Returns the number of \p x2 condition ranges.
+     */
+    size_t numberOfConditions() const
+    {
+        return _numberOfx2Buckets;
+    }
+
+    /**
+     * Returns the \p i-th \p x2 condition range.
+     */
+    const Interval<T2>& condition(size_t i) const
+    {
+        return _x2Buckets[i];
+    }
+
 private:
 
     void reset();
 
+    void prepare();
+
     size_t findBucket(const T2 x) const;
 
+    size_t findCondition(const T2 x) const;
+
+    T1 conditionalInvcdf(size_t i, Decimal y) const;
+
     static RegularExpression headerLine1Format;
     static RegularExpression headerLine2Format;
 
+    /**
+     * Maximal number of entries in the dense \p x2 index.
+     */
+    static const size_t MAX_DENSE_INDEX_SIZE = 65536;
+
     size_t _numberOfx2Buckets;
     Interval<T2>* _x2Buckets;
     CombinedPrFunction<T1>* _x1Pr;
+
+    size_t _x2IndexSize; //!< The number of dense index entries (zero if disabled).
+    I32u* _lookupTable; //!< The backing allocation of the lookup table.
+    I32u* _x2Index; //!< Maps (x2 - _x2Buckets[0].min()) to a condition bucket.
+    I32u* _x1GuideOffsets; //!< Offsets of the per-condition guide tables.
+    I32u* _x1Guides; //!< The concatenated per-condition guide tables.
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -198,6 +253,35 @@ inline String __headerLine2Format<Char>()
     return "\\s*@condition\\s*=\\s*\\[\\s*'(.+)'\\s*,\\s*'(.+)'\\s*\\)\\s*(#(.+))?";
 }
 
+// offsets into the dense x2 index are only defined for integral condition types
+template<typename T, bool isInteger = numeric_limits<T>::is_integer>
+struct __DenseConditionIndex
+{
+    static bool supported()
+    {
+        return false;
+    }
+
+    static I64u offset(const T x, const T min)
+    {
+        return nullValue<I64u>();
+    }
+};
+
+template<typename T>
+struct __DenseConditionIndex<T, true>
+{
+    static bool supported()
+    {
+        return true;
+    }
+
+    static I64u offset(const T x, const T min)
+    {
+        return static_cast<I64u>(static_cast<I64>(x) - static_cast<I64>(min));
+    }
+};
+
 template<typename T1, typename T2> RegularExpression ConditionalCombinedPrFunction<T1, T2>::headerLine1Format("\\s*@numberofconditions\\s*=\\s*([+]?[0-9]+)\\s*(#(.+))?");
 template<typename T1, typename T2> RegularExpression ConditionalCombinedPrFunction<T1, T2>::headerLine2Format(__headerLine2Format<T2>());
 
@@ -210,6 +294,16 @@ template<typename T1, typename T2> RegularExpression ConditionalCombinedPrFuncti
 
 template<typename T1, typename T2> inline void ConditionalCombinedPrFunction<T1, T2>::reset()
 {
+    if (_lookupTable != NULL)
+    {
+        delete[] _lookupTable;
+        _lookupTable = NULL;
+        _x2Index = NULL;
+        _x1GuideOffsets = NULL;
+        _x1Guides = NULL;
+        _x2IndexSize = 0;
+    }
+
     if (_numberOfx2Buckets > 0)
     {
         _numberOfx2Buckets = 0;
@@ -218,6 +312,99 @@ template<typename T1, typename T2> inline void ConditionalCombinedPrFunction<T1,
     }
 }
 
+/**
+ * Builds the lookup table for the loaded condition buckets and components.
+ *
+ * The guide table for a component with \p n cumulative probabilities has
+ * \p n entries, where the k-th entry is the first index whose cumulative
+ * probability exceeds k/n. The search for a given \p y therefore starts at
+ * the guide entry for floor(y*n) and yields the same index as the binary
+ * search in CombinedPrFunction::findIndex() (ties within the _EPSILON range
+ * are resolved by falling back to the binary search).
+ */
+template<typename T1, typename T2> void ConditionalCombinedPrFunction<T1, T2>::prepare()
+{
+    if (_numberOfx2Buckets == 0)
+    {
+        return;
+    }
+
+    // compute the size of the dense x2 index (if applicable)
+    size_t x2IndexSize = 0;
+    if (__DenseConditionIndex<T2>::supported())
+    {
+        I64u x2Range = __DenseConditionIndex<T2>::offset(_x2Buckets[_numberOfx2Buckets-1].max(), _x2Buckets[0].min());
+
+        if (x2Range <= MAX_DENSE_INDEX_SIZE)
+        {
+            x2IndexSize = static_cast<size_t>(x2Range);
+        }
+    }
+
+    // compute the total size of the guide tables
+    size_t guidesSize = 0;
+    for (size_t i = 0; i < _numberOfx2Buckets; i++)
+    {
+        guidesSize += _x1Pr[i]._numberOfValues + _x1Pr[i]._numberOfBuckets;
+    }
+
+    size_t lookupTableSize = x2IndexSize + _numberOfx2Buckets + guidesSize;
+
+    // the lookup table is addressed with 32-bit offsets
+    if (lookupTableSize >= nullValue<I32u>())
+    {
+        return;
+    }
+
+    _lookupTable = new I32u[lookupTableSize];
+    _x2Index = _lookupTable;
+    _x1GuideOffsets = _x2Index + x2IndexSize;
+    _x1Guides = _x1GuideOffsets + _numberOfx2Buckets;
+    _x2IndexSize = x2IndexSize;
+
+    // fill the dense x2 index
+    for (size_t k = 0; k < _x2IndexSize; k++)
+    {
+        _x2Index[k] = nullValue<I32u>();
+    }
+
+    for (size_t i = 0; _x2IndexSize > 0 && i < _numberOfx2Buckets; i++)
+    {
+        I64u kMin = __DenseConditionIndex<T2>::offset(_x2Buckets[i].min(), _x2Buckets[0].min());
+        I64u kMax = __DenseConditionIndex<T2>::offset(_x2Buckets[i].max(), _x2Buckets[0].min());
+
+        for (I64u k = kMin; k < kMax && k < _x2IndexSize; k++)
+        {
+            _x2Index[k] = static_cast<I32u>(i);
+        }
+    }
+
+    // fill the guide tables
+    I32u guideOffset = 0;
+    for (size_t i = 0; i < _numberOfx2Buckets; i++)
+    {
+        const CombinedPrFunction<T1>& pr = _x1Pr[i];
+        const size_t n = pr._numberOfValues + pr._numberOfBuckets;
+
+        _x1GuideOffsets[i] = guideOffset;
+
+        size_t j = 0;
+        for (size_t k = 0; k < n; k++)
+        {
+            Decimal y = static_cast<Decimal>(k) / static_cast<Decimal>(n) - 2 * pr._EPSILON;
+
+            while (j < n-1 && pr._cumulativeProbabilites[j] <= y)
+            {
+                j++;
+            }
+
+            _x1Guides[guideOffset + k] = static_cast<I32u>(j);
+        }
+
+        guideOffset += static_cast<I32u>(n);
+    }
+}
+
 template<typename T1, typename T2> inline size_t ConditionalCombinedPrFunction<T1, T2>::findBucket(const T2 x) const
 {
     // we assert that the value x is in the [_min, _max] range
@@ -252,6 +439,63 @@ template<typename T1, typename T2> inline size_t ConditionalCombinedPrFunction<T
     return nullValue<size_t>();
 }
 
+template<typename T1, typename T2> inline size_t ConditionalCombinedPrFunction<T1, T2>::findCondition(const T2 x) const
+{
+    if (_x2IndexSize > 0)
+    {
+        // values below the first bucket wrap around to large offsets
+        I64u k = __DenseConditionIndex<T2>::offset(x, _x2Buckets[0].min());
+
+        if (k < _x2IndexSize && _x2Index[k] != nullValue<I32u>())
+        {
+            return _x2Index[k];
+        }
+    }
+
+    return findBucket(x);
+}
+
+template<typename T1, typename T2> inline T1 ConditionalCombinedPrFunction<T1, T2>::conditionalInvcdf(size_t i, Decimal y) const
+{
+    const CombinedPrFunction<T1>& pr = _x1Pr[i];
+
+    if (_lookupTable == NULL)
+    {
+        return pr.invcdf(y);
+    }
+
+    if (y < pr._notNullProbability)
+    {
+        const size_t n = pr._numberOfValues + pr._numberOfBuckets;
+        size_t j = n-1;
+
+        if (y < 1.0)
+        {
+            // start at the guide entry and scan to the first cumulative
+            // probability that is not below y
+            j = _x1Guides[_x1GuideOffsets[i] + static_cast<size_t>(y * n)];
+
+            while (j < n-1 && pr._cumulativeProbabilites[j] < y - pr._EPSILON)
+            {
+                j++;
+            }
+
+            // y matches a cumulative probability, defer to the binary search
+            // in order to resolve ties between zero-probability entries
+            if (pr._cumulativeProbabilites[j] <= y + pr._EPSILON)
+            {
+                j = pr.findIndex(y);
+            }
+        }
+
+        return pr.valueAt(j, y);
+    }
+    else
+    {
+        return nullValue<T1>();
+    }
+}
+
 template<typename T1, typename T2> inline Decimal ConditionalCombinedPrFunction<T1, T2>::operator()(const T1 x1, const T2 x2) const
 {
     return cdf(x1, x2);
@@ -268,6 +512,12 @@ template<typename T1, typename T2> inline T1 ConditionalCombinedPrFunction<T1, T
 template<typename T1, typename T2>
 void ConditionalCombinedPrFunction<T1, T2>::initialize(const string& path)
 {
+    if (BinarySpecification::available(path))
+    {
+        initialize(new BinarySpecification(BinarySpecification::compiledPath(path), BinarySpecification::CONDITIONAL_COMBINED_PR_FUNCTION));
+        return;
+    }
+
     ifstream in(path.c_str());
 
     if (!in.is_open())
@@ -396,6 +646,50 @@ void ConditionalCombinedPrFunction<T1, T2>::initialize(istream& in)
     {
         throw RuntimeException("Unexpected state in ConditionalCombinedPrFunction reader at line " + currentLineNumber);
     }
+
+    // build the lookup table for the loaded components
+    prepare();
+}
+
+/**
+ * Load the distribution data from a mapped binary specification. The condition
+ * components reference the probability arrays of the mapping in place.
+ */
+template<typename T1, typename T2>
+void ConditionalCombinedPrFunction<T1, T2>::initialize(const AutoPtr<BinarySpecification>& specification)
+{
+    // reset old state
+    reset();
+
+    const BinarySpecification::Header& header = specification->header();
+
+    if (header.count == 0 || header.count > numeric_limits<I32u>::max())
+    {
+        throw DataException(format("Invalid number of conditions in binary specification `%s`", specification->path()));
+    }
+
+    size_t numberOfx2Buckets = static_cast<size_t>(header.count);
+    size_t boundsOffset = sizeof(BinarySpecification::Header);
+    size_t sectionOffsetsOffset = boundsOffset + 2 * numberOfx2Buckets * sizeof(I64);
+
+    const I64* bounds = specification->at<I64>(boundsOffset, 2 * numberOfx2Buckets);
+    const I64u* sectionOffsets = specification->at<I64u>(sectionOffsetsOffset, numberOfx2Buckets);
+
+    _numberOfx2Buckets = numberOfx2Buckets;
+    _x2Buckets = new Interval<T2>[numberOfx2Buckets];
+    _x1Pr = new CombinedPrFunction<T1>[numberOfx2Buckets];
+
+    for (size_t i = 0; i < _numberOfx2Buckets; i++)
+    {
+        T2 min = BinarySpecificationSlot<T2>::decode(bounds + 2*i, header.conditionEncoding);
+        T2 max = BinarySpecificationSlot<T2>::decode(bounds + 2*i + 1, header.conditionEncoding);
+
+        _x2Buckets[i].set(min, max);
+        _x1Pr[i].initialize(specification, static_cast<size_t>(sectionOffsets[i]));
+    }
+
+    // build the lookup table for the loaded components
+    prepare();
 }
 
 template<typename T1, typename T2>
@@ -427,14 +721,14 @@ Decimal ConditionalCombinedPrFunction<T1, T2>::cdf(T1 x1, T2 x2) const
 template<typename T1, typename T2>
 T1 ConditionalCombinedPrFunction<T1, T2>::invcdf(Decimal y, T2 x2) const
 {
-    size_t i = findBucket(x2);
+    size_t i = findCondition(x2);
 
     if (i == nullValue<size_t>())
     {
         throw LogicException(format("Unknown distribution for evidence x2 = '%s'", toString<T2>(x2)));
     }
 
-    return _x1Pr[i].invcdf(y);
+    return conditionalInvcdf(i, y);
 }
 
 //@}
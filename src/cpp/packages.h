@@ -19,6 +19,13 @@
 // Module Documentation
 // ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~
 
+/**
+ * @defgroup bench Package 'bench'
+ *
+ * The 'bench' package contains microbenchmarks for the toolkit hot paths
+ * (PRNGs, probability functions, record inspection and output collection).
+ */
+
 /**
  * @defgroup config Package 'config'
  *
@@ -131,7 +131,10 @@ public:
         I64u nestedRecordGenID = cxtRecordPtr->genID();
         I64u parentRecordGenID = nestedRecordGenID/_maxChildrenValue;
 
-        if (_reference.isNull() || _reference->genID() != parentRecordGenID)
+        const bool hit = !_reference.isNull() && _reference->genID() == parentRecordGenID;
+        ProgressSlot::referenceLookup(hit);
+
+        if (!hit)
         {
             try
             {
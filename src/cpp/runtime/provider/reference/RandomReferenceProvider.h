@@ -98,7 +98,10 @@ public:
         I64u genID = random(genIDRange.min(), genIDRange.max());
 
         // lazy-instantiate the corresponding reference
-        if (_reference.isNull() || _reference->genID() != genID)
+        const bool hit = !_reference.isNull() && _reference->genID() == genID;
+        ProgressSlot::referenceLookup(hit);
+
+        if (!hit)
         {
             // protect against InvalidRecordExceptions
             I16u x = 0;
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2010-2013 DIMA Research Group, TU Berlin
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef SETTERPROFILER_H_
+#define SETTERPROFILER_H_
+
+#include "core/clock.h"
+#include "core/types.h"
+
+#include <Poco/Format.h>
+#include <Poco/Logger.h>
+#include <Poco/Mutex.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Poco;
+
+namespace Myriad {
+/**
+ * @addtogroup runtime_setter
+ * @{*/
+
+/**
+ * The setter costs collected by the SetterProfiler instances of all setter
+ * chains in the current process, grouped by record type.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class SetterProfile
+{
+public:
+
+    /**
+     * Returns the profile shared by all setter chains.
+     */
+    static SetterProfile& defaultProfile()
+    {
+        static SetterProfile profile;
+        return profile;
+    }
+
+    /**
+     * Adds the \p cycles spent in each of the given \p setters of a
+     * \p recordType over \p samples profiled records.
+     */
+    void merge(const string& recordType, const vector<string>& setters, const vector<I64u>& cycles, I64u samples)
+    {
+        FastMutex::ScopedLock lock(_mutex);
+
+        Entry& entry = _entries[recordType];
+
+        if (entry.setters.empty())
+        {
+            entry.setters = setters;
+            entry.cycles.assign(setters.size(), 0);
+        }
+
+        for (size_t i = 0; i < entry.cycles.size() && i < cycles.size(); i++)
+        {
+            entry.cycles[i] += cycles[i];
+        }
+
+        entry.samples += samples;
+    }
+
+    /**
+     * Logs the setters collected since the last report ranked by their
+     * average cost per record, together with their share of the setter
+     * chain of their record type and of all profiled setter chains, and
+     * resets the profile.
+     */
+    void report(Logger& logger, const string& title)
+    {
+        map<string, Entry> entries;
+
+        {
+            FastMutex::ScopedLock lock(_mutex);
+            entries.swap(_entries);
+        }
+
+        vector<Row> rows;
+        I64u totalCycles = 0;
+
+        for (map<string, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            const Entry& entry = it->second;
+
+            if (entry.samples == 0)
+            {
+                continue;
+            }
+
+            I64u chainCycles = entry.total();
+
+            for (size_t i = 0; i < entry.cycles.size(); i++)
+            {
+                Row row;
+                row.name = it->first + "." + entry.setters[i];
+                row.cycles = entry.cycles[i];
+                row.perRecord = entry.cycles[i] / static_cast<Decimal>(entry.samples);
+                row.ofRecord = chainCycles > 0 ? 100.0 * entry.cycles[i] / chainCycles : 0.0;
+                rows.push_back(row);
+            }
+
+            totalCycles += chainCycles;
+        }
+
+        if (rows.empty())
+        {
+            return;
+        }
+
+        sort(rows.begin(), rows.end(), Row::byCost);
+
+        logger.information(format("Setter profile %s (cycles per record, ranked by cost):", title));
+        logger.information(format("%6s  %-48s %14s %10s %10s", string("rank"), string("setter"), string("cycles/record"), string("of record"), string("of total")));
+
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            const Row& row = rows[i];
+            Decimal ofTotal = totalCycles > 0 ? 100.0 * row.cycles / totalCycles : 0.0;
+            logger.information(format("%6z  %-48s %14.1f %9.1f%% %9.1f%%", i + 1, row.name, row.perRecord, row.ofRecord, ofTotal));
+        }
+
+        for (map<string, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            const Entry& entry = it->second;
+
+            if (entry.samples == 0)
+            {
+                continue;
+            }
+
+            logger.information(format("%6s  %-48s %14.1f (%Lu sampled records)", string(""), it->first + " (setter chain)", entry.total() / static_cast<Decimal>(entry.samples), entry.samples));
+        }
+    }
+
+private:
+
+    struct Entry
+    {
+        Entry() : samples(0)
+        {
+        }
+
+        I64u total() const
+        {
+            I64u result = 0;
+            for (size_t i = 0; i < cycles.size(); i++)
+            {
+                result += cycles[i];
+            }
+            return result;
+        }
+
+        vector<string> setters;
+        vector<I64u> cycles;
+        I64u samples;
+    };
+
+    struct Row
+    {
+        static bool byCost(const Row& x, const Row& y)
+        {
+            return x.perRecord > y.perRecord;
+        }
+
+        string name;
+        I64u cycles;
+        Decimal perRecord;
+        Decimal ofRecord;
+    };
+
+    FastMutex _mutex;
+
+    map<string, Entry> _entries;
+};
+
+/**
+ * A sampling profiler for the setters of a single setter chain.
+ *
+ * When enabled, the setter chain asks the profiler on each invocation
+ * whether the current record should be profiled. For every interval-th record
+ * the chain reads the cycle counter (see cycleCount()) around each setter and
+ * records the difference, all other records pass with a single counter
+ * decrement. Since each setter wraps exactly one value or reference provider,
+ * the setter costs are also the costs of their providers; the cost of a
+ * reference setter includes the generation of the referenced record. The
+ * collected costs are merged into the SetterProfile::defaultProfile() when
+ * the chain is destroyed. On platforms without a cycle counter, the costs are
+ * measured in nanoseconds.
+ *
+ * @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+ */
+class SetterProfiler
+{
+public:
+
+    /**
+     * Creates a profiler for the setter chain of \p recordType that profiles
+     * every \p interval-th record (0 disables the profiler).
+     */
+    SetterProfiler(const string& recordType, I32u interval) :
+        _recordType(recordType),
+        _interval(interval),
+        _countdown(interval),
+        _samples(0)
+    {
+    }
+
+    /**
+     * Copy constructor. The copy starts with empty counters.
+     */
+    SetterProfiler(const SetterProfiler& other) :
+        _recordType(other._recordType),
+        _setters(other._setters),
+        _cycles(other._setters.size(), 0),
+        _interval(other._interval),
+        _countdown(other._interval),
+        _samples(0)
+    {
+    }
+
+    ~SetterProfiler()
+    {
+        if (_samples > 0)
+        {
+            SetterProfile::defaultProfile().merge(_recordType, _setters, _cycles, _samples);
+        }
+    }
+
+    /**
+     * Registers the next setter of the chain.
+     */
+    void add(const string& setter)
+    {
+        _setters.push_back(setter);
+        _cycles.push_back(0);
+    }
+
+    /**
+     * Returns true if the current record should be profiled.
+     */
+    bool sample()
+    {
+        if (_interval == 0 || --_countdown > 0)
+        {
+            return false;
+        }
+
+        _countdown = _interval;
+        _samples++;
+        return true;
+    }
+
+    /**
+     * Returns the cycle counter value at which the first setter starts.
+     */
+    I64u start() const
+    {
+        return cycleCount();
+    }
+
+    /**
+     * Adds the cycles since \p start to the cost of the \p i-th setter and
+     * returns the cycle counter value at which the next setter starts.
+     */
+    I64u stop(size_t i, I64u start)
+    {
+        I64u now = cycleCount();
+        _cycles[i] += now - start;
+        return now;
+    }
+
+private:
+
+    SetterProfiler& operator=(const SetterProfiler&);
+
+    const string _recordType;
+
+    vector<string> _setters;
+
+    vector<I64u> _cycles;
+
+    const I32u _interval;
+
+    I32u _countdown;
+
+    I64u _samples;
+};
+
+/** @}*/// add to runtime_setter group
+} // namespace Myriad
+
+#endif /* SETTERPROFILER_H_ */
@@ -24,6 +24,7 @@ import sys
 
 import myriad.event
 import myriad.error
+import myriad.task.bench
 import myriad.task.compile
 import myriad.task.initialize
 
@@ -87,7 +88,10 @@ class Assistant(object):
     def initialize(self, argv):
 
         try:
+            # register `bench:*` tasks
+            self.registerTask(myriad.task.bench.PrototypesBenchmarkTask(self))
             # register `compile:*` tasks
+            self.registerTask(myriad.task.compile.CompileDistributionsTask(self))
             self.registerTask(myriad.task.compile.CompileOligosTask(self))
             self.registerTask(myriad.task.compile.CompilePrototypeTask(self))
             # register `initialize:*` tasks
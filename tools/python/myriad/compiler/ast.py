@@ -1197,6 +1197,43 @@ class CsvOutputFormatterNode(AbstractOutputFormatterNode):
             raise ParseTypeError("Bad %s type" % str(cls).split('.').pop()[0:-6])
 
 
+class ColumnarOutputFormatterNode(AbstractOutputFormatterNode):
+    '''
+    classdocs
+    '''
+    
+    # the type pattern for this class
+    __type_pattern = re.compile('^columnar$')
+    
+    def __init__(self, *args, **kwargs):
+        kwargs.update(type="columnar")
+        kwargs.update(template_type="ColumnarOutputFormatter")
+        super(ColumnarOutputFormatterNode, self).__init__(*args, **kwargs)
+        
+    def getConcreteType(self):
+        recordType = StringTransformer.us2ccAll(self.getParent().getAttribute("key"))
+
+        return "Myriad::ColumnarOutputFormatter< %s >" % (recordType)
+        
+    def getXMLArguments(self):
+        return [ { 'key': 'row_group_size', 'type': 'I64u', 'default': '65536' },
+                 { 'key': 'field', 'type': 'collection[field_ref]' }, 
+               ]
+        
+    def getConstructorArguments(self):
+        return [ 'Literal(row_group_size)',
+                 'FieldSetterRef(field)'
+               ]
+    
+    @classmethod
+    def parseType(cls, type):
+        m = cls.__type_pattern.match(type)
+        if m is not None:
+            return [], {}
+        else:
+            raise ParseTypeError("Bad %s type" % str(cls).split('.').pop()[0:-6])
+
+
 class EmptyOutputFormatterNode(AbstractOutputFormatterNode):
     '''
     classdocs
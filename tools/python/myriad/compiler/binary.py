@@ -0,0 +1,318 @@
+'''
+Copyright 2010-2013 DIMA Research Group, TU Berlin
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Created on Oct 18, 2013
+
+@author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+'''
+
+import datetime
+import logging
+import os
+import re
+import struct
+
+class BinarySpecificationError(Exception):
+    '''
+    An error raised for malformed textual specifications.
+    '''
+
+    def __init__(self, path, lineNumber, message):
+        super(BinarySpecificationError, self).__init__()
+        self.path = path
+        self.lineNumber = lineNumber
+        self.message = message
+
+    def __str__(self):
+        return "%s, line %d: %s" % (self.path, self.lineNumber, self.message)
+
+
+class SpecificationLineReader(object):
+    '''
+    Iterates over the non-empty, non-comment lines of a textual specification.
+    '''
+
+    def __init__(self, path):
+        self.path = path
+        self.lineNumber = 0
+        self.__lines = open(path, "r").read().split('\n')
+        self.__position = 0
+
+    def next(self):
+        while self.__position < len(self.__lines):
+            line = self.__lines[self.__position].strip()
+            self.__position += 1
+            self.lineNumber = self.__position
+            if len(line) > 0 and line[0] != '#':
+                return line
+        return None
+
+    def expect(self, pattern, message):
+        line = self.next()
+        m = pattern.search(line) if line is not None else None
+        if m is None:
+            raise BinarySpecificationError(self.path, self.lineNumber, message)
+        return m
+
+
+class BinarySpecificationCompiler(object):
+    '''
+    Compiles textual *.distribution and *.domain specifications into the
+    binary format read by the C++ Myriad::BinarySpecification class.
+
+    The binary files are written next to their sources as `${path}.bin`. The
+    loaders of the C++ runtime use them instead of the textual specifications
+    whenever they are not older than their sources.
+    '''
+
+    MAGIC = "MYRIADBS"
+    VERSION = 1
+
+    # specification kinds
+    COMBINED_PR_FUNCTION = 1
+    CONDITIONAL_COMBINED_PR_FUNCTION = 2
+    ENUM_SET = 3
+
+    # value encodings
+    NONE = 0
+    INTEGER = 1
+    DECIMAL = 2
+    CHAR = 3
+    DATE = 4
+
+    # see CombinedPrFunction::_EPSILON
+    EPSILON = 0.000000001
+
+    _number = '([+]?[0-9]*\.?[0-9]+([eE][-+]?[0-9]+)?)'
+
+    _numberOfConditionsPattern = re.compile('\s*@numberofconditions\s*=\s*([+]?[0-9]+)\s*(#(.+))?')
+    _conditionPattern = re.compile('\s*@condition\s*=\s*\[\s*(.+)\s*,\s*(.+)\s*\)\s*(#(.+))?')
+    _numberOfValuesPattern = re.compile('\s*@numberofexactvals\s*=\s*([+]?[0-9]+)\s*(#(.+))?')
+    _numberOfBucketsPattern = re.compile('\s*@numberofbins\s*=\s*([+]?[0-9]+)\s*(#(.+))?')
+    _nullProbabilityPattern = re.compile('\s*@nullprobability\s*=\s*%s\s*(#(.+))?' % _number)
+    _valueLinePattern = re.compile('\s*p\(X\)\s*=\s*%s\s+for\s+X\s*=\s*\{\s*(.+)\s*\}\s*(#(.+))?' % _number)
+    _bucketLinePattern = re.compile('\s*p\(X\)\s*=\s*%s\s+for\s+X\s*=\s*\{\s*x\s+in\s+\[\s*(.+)\s*,\s*(.+)\s*\)\s*\}\s*(#(.+))?' % _number)
+    _enumHeaderPattern = re.compile('\s*@numberofvalues\s*=\s*([+]?[0-9]+)\s*(#(.+))?')
+    _enumValuePattern = re.compile('\s*[0-9]*\s*\.\.\.+\s*"(.*)"\s*(#(.+))?')
+
+    _charPattern = re.compile("^'(.)'$")
+    _datePattern = re.compile('^(\d{4})-(\d{2})-(\d{2})')
+    _integerPattern = re.compile('^[+-]?\d+$')
+
+    def __init__(self, *args, **kwargs):
+        self._log = logging.getLogger("binary.compiler")
+
+    def compileAll(self, configPath):
+        '''
+        Compiles all *.distribution and *.domain files under `configPath`.
+        '''
+        for dirPath, _, fileNames in os.walk(configPath):
+            for fileName in sorted(fileNames):
+                path = os.path.join(dirPath, fileName)
+                if fileName.endswith(".distribution"):
+                    self.compileDistribution(path)
+                elif fileName.endswith(".domain"):
+                    self.compileEnumSet(path)
+
+    def compileDistribution(self, path):
+        self._log.info("Compiling distribution `%s`." % (path))
+
+        reader = SpecificationLineReader(path)
+        line = reader.next()
+        if line is not None and self._numberOfConditionsPattern.search(line):
+            self.__write(path, self.__compileConditionalCombinedPrFunction(path))
+        else:
+            self.__write(path, self.__compileCombinedPrFunction(path))
+
+    def compileEnumSet(self, path):
+        self._log.info("Compiling enum set `%s`." % (path))
+
+        reader = SpecificationLineReader(path)
+        m = reader.expect(self._enumHeaderPattern, "Bad header line, should be: '@numberofvalues = $N'")
+        numberOfValues = int(m.group(1))
+
+        pool = []
+        offsets = [0]
+        for _ in range(numberOfValues):
+            m = reader.expect(self._enumValuePattern, "Bad enum value line, should be: '$i ........... $value'")
+            value = m.group(1).replace('\\"', '"').replace('\\n', '\n')
+            pool.append(value)
+            offsets.append(offsets[-1] + len(value))
+
+        data = self.__header(self.ENUM_SET, self.NONE, self.NONE, numberOfValues)
+        data += struct.pack('<%dQ' % len(offsets), *offsets)
+        data += ''.join(pool)
+
+        self.__write(path, data)
+
+    def __compileCombinedPrFunction(self, path):
+        reader = SpecificationLineReader(path)
+        function = self.__readCombinedPrFunction(reader)
+        encoding = self.__encoding(function['values'] + function['bounds'])
+
+        data = self.__header(self.COMBINED_PR_FUNCTION, encoding, self.NONE, 1)
+        data += self.__section(function, encoding)
+        return data
+
+    def __compileConditionalCombinedPrFunction(self, path):
+        reader = SpecificationLineReader(path)
+        m = reader.expect(self._numberOfConditionsPattern, "Bad header line, should be: '@numberofconditions = $N'")
+        numberOfConditions = int(m.group(1))
+
+        bounds = []
+        functions = []
+        for _ in range(numberOfConditions):
+            m = reader.expect(self._conditionPattern, "Bad header line, should be: '@condition = [$x, $y)'")
+            bounds.extend([m.group(1).strip(), m.group(2).strip()])
+            functions.append(self.__readCombinedPrFunction(reader))
+
+        encoding = self.__encoding(reduce(lambda x, f: x + f['values'] + f['bounds'], functions, []))
+        conditionEncoding = self.__encoding(bounds)
+
+        sections = [self.__section(f, encoding) for f in functions]
+
+        data = self.__header(self.CONDITIONAL_COMBINED_PR_FUNCTION, encoding, conditionEncoding, numberOfConditions)
+        data += ''.join([self.__slot(b, conditionEncoding) for b in bounds])
+
+        offset = len(data) + 8 * numberOfConditions
+        for section in sections:
+            data += struct.pack('<Q', offset)
+            offset += len(section)
+
+        data += ''.join(sections)
+        return data
+
+    def __readCombinedPrFunction(self, reader):
+        '''
+        Reads a combined probability function and computes its (normalized)
+        cumulative probabilities exactly as CombinedPrFunction::initialize()
+        and CombinedPrFunction::normalize() do.
+        '''
+        m = reader.expect(self._numberOfValuesPattern, "Bad header line, should be: '@numberofexactvals = $N'")
+        numberOfValues = int(m.group(1))
+        m = reader.expect(self._numberOfBucketsPattern, "Bad header line, should be: '@numberofbins = $N'")
+        numberOfBuckets = int(m.group(1))
+        m = reader.expect(self._nullProbabilityPattern, "Bad header line, should be: '@nullprobability = $N'")
+        notNullProbability = 1.0 - float(m.group(1))
+
+        if numberOfValues == 0 and numberOfBuckets == 0:
+            raise BinarySpecificationError(reader.path, reader.lineNumber, "Cannot specify a combined probability with zero values and zero buckets")
+
+        values = []
+        valueProbabilities = []
+        bounds = []
+        bucketProbabilities = []
+
+        for _ in range(numberOfValues):
+            m = reader.expect(self._valueLinePattern, "Bad value probability line, should be: 'p(X) = $p_x for X = { $x }'")
+            valueProbabilities.append(float(m.group(1)))
+            values.append(m.group(3).strip())
+
+        for _ in range(numberOfBuckets):
+            m = reader.expect(self._bucketLinePattern, "Bad bucket probability line, should be: 'p(X) = $p_x for X = { x \\in [$x_min, $x_max) }'")
+            bucketProbabilities.append(float(m.group(1)))
+            bounds.extend([m.group(3).strip(), m.group(4).strip()])
+
+        valueProbability = 0.0
+        bucketProbability = 0.0
+        cumulativeProbabilities = []
+
+        for p in valueProbabilities:
+            valueProbability += p
+            cumulativeProbabilities.append(valueProbability)
+        for p in bucketProbabilities:
+            bucketProbability += p
+            cumulativeProbabilities.append(valueProbability + bucketProbability)
+
+        # check if extra normalization is required
+        if abs(valueProbability + bucketProbability - notNullProbability) >= self.EPSILON:
+            normalizationFactor = 1.0 / (valueProbability + bucketProbability + (1.0 - notNullProbability))
+
+            valueProbability = 0.0
+            bucketProbability = 0.0
+            cumulativeProbabilities = []
+
+            for i in range(numberOfValues):
+                valueProbabilities[i] = valueProbabilities[i] * normalizationFactor
+                valueProbability += valueProbabilities[i]
+                cumulativeProbabilities.append(valueProbability)
+            for i in range(numberOfBuckets):
+                bucketProbabilities[i] = bucketProbabilities[i] * normalizationFactor
+                bucketProbability += bucketProbabilities[i]
+                cumulativeProbabilities.append(valueProbability + bucketProbability)
+
+            notNullProbability = valueProbability + bucketProbability
+
+        return { 'notNullProbability': notNullProbability,
+                 'valueProbability': valueProbability,
+                 'bucketProbability': bucketProbability,
+                 'values': values,
+                 'valueProbabilities': valueProbabilities,
+                 'bounds': bounds,
+                 'bucketProbabilities': bucketProbabilities,
+                 'cumulativeProbabilities': cumulativeProbabilities }
+
+    def __section(self, function, encoding):
+        numberOfValues = len(function['values'])
+        numberOfBuckets = len(function['bucketProbabilities'])
+
+        data = struct.pack('<QQddd', numberOfValues, numberOfBuckets, function['notNullProbability'], function['valueProbability'], function['bucketProbability'])
+        data += ''.join([self.__slot(v, encoding) for v in function['values']])
+        data += struct.pack('<%dd' % numberOfValues, *function['valueProbabilities'])
+        data += ''.join([self.__slot(b, encoding) for b in function['bounds']])
+        data += struct.pack('<%dd' % numberOfBuckets, *function['bucketProbabilities'])
+        data += struct.pack('<%dd' % (numberOfValues + numberOfBuckets), *function['cumulativeProbabilities'])
+        return data
+
+    def __encoding(self, literals):
+        encoding = self.NONE
+        for literal in literals:
+            if self._charPattern.match(literal):
+                current = self.CHAR
+            elif self._datePattern.match(literal):
+                current = self.DATE
+            elif self._integerPattern.match(literal):
+                current = self.INTEGER
+            else:
+                current = self.DECIMAL
+
+            if encoding == self.NONE or (encoding == self.INTEGER and current == self.DECIMAL):
+                encoding = current
+            elif encoding == self.DECIMAL and current == self.INTEGER:
+                pass
+            elif encoding != current:
+                raise RuntimeError("Mixed value types in specification (literal `%s`)" % (literal))
+
+        return encoding
+
+    def __slot(self, literal, encoding):
+        if encoding == self.CHAR:
+            return struct.pack('<q', ord(self._charPattern.match(literal).group(1)))
+        elif encoding == self.DATE:
+            m = self._datePattern.match(literal)
+            return struct.pack('<q', datetime.date(int(m.group(1)), int(m.group(2)), int(m.group(3))).toordinal())
+        elif encoding == self.INTEGER:
+            value = int(literal)
+            return struct.pack('<Q' if value >= 2**63 else '<q', value)
+        else:
+            return struct.pack('<d', float(literal))
+
+    def __header(self, kind, valueEncoding, conditionEncoding, count):
+        return struct.pack('<8sIIIIQ', self.MAGIC, kind, valueEncoding, conditionEncoding, self.VERSION, count)
+
+    def __write(self, path, data):
+        wfile = open("%s.bin" % (path), "wb")
+        wfile.write(data)
+        wfile.close()
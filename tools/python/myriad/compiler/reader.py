@@ -572,6 +572,7 @@ class PrototypeSpecificationReader(object):
             resolvedRecordReferenceNode = ResolvedRecordReferenceNode()
             resolvedRecordReferenceNode.setAttribute('name', unresolvedRecordReferenceNode.getAttribute("name"))
             resolvedRecordReferenceNode.setAttribute('type', StringTransformer.ucFirst(StringTransformer.us2cc(unresolvedRecordReferenceNode.getAttribute("type"))))
+            resolvedRecordReferenceNode.setAttribute('key', fqName)
             resolvedRecordReferenceNode.setRecordTypeRef(recordTypeNode)
             resolvedRecordReferenceNode.orderkey = unresolvedRecordReferenceNode.orderkey
             parent.setReference(resolvedRecordReferenceNode)
@@ -957,7 +958,7 @@ class PrototypeSpecificationReader(object):
                 pass
         
         if outputFormatter is None:    
-            raise RuntimeError('Unexpected output formatter type `%s` (expected one of `(csv|empty)`)' % (t))
+            raise RuntimeError('Unexpected output formatter type `%s` (expected one of `(csv|columnar|empty)`)' % (t))
         
         # recursively read range provider arguments
         ArgumentReader.readArguments(outputFormatterXMLNode, outputFormatter)
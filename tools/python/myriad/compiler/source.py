@@ -27,12 +27,15 @@ from myriad.compiler.ast import AbstractFunctionNode
 from myriad.compiler.ast import AbstractRuntimeComponentNode
 from myriad.compiler.ast import ArgumentCollectionNode
 from myriad.compiler.ast import CallbackValueProviderNode
+from myriad.compiler.ast import CombinedProbabilityFunctionNode
+from myriad.compiler.ast import ConditionalCombinedProbabilityFunctionNode
 from myriad.compiler.ast import DepthFirstNodeFilter
 from myriad.compiler.ast import EnumSetNode
 from myriad.compiler.ast import LiteralArgumentNode
 from myriad.compiler.ast import RandomSequenceNode
 from myriad.compiler.ast import ResolvedFieldRefArgumentNode
 from myriad.compiler.ast import ResolvedFunctionRefArgumentNode
+from myriad.compiler.ast import ResolvedRecordReferenceNode
 from myriad.compiler.ast import RecordEnumFieldNode
 from myriad.util.stringutil import StringTransformer
 
@@ -342,10 +345,87 @@ class FrontendCompiler(SourceCompiler):
             print >> wfile, ''
             print >> wfile, '// define the application main method'
             print >> wfile, 'POCO_APP_MAIN(Myriad::Frontend)'
-    
+
             wfile.close()
 
 
+class BenchmarkCompiler(SourceCompiler):
+    '''
+    Compiles the microbenchmarks of the configured functions and record
+    sequences. The generated sources are linked only into the separate
+    benchmark binary built by `make bench`.
+    '''
+
+    def __init__(self, *args, **kwargs):
+        '''
+        Constructor
+        '''
+        super(BenchmarkCompiler, self).__init__(*args, **kwargs)
+
+    def compileCode(self, astRoot):
+        self._log.info("Compiling benchmark C++ sources.")
+        self.compileBaseBenchmarks(astRoot)
+
+    def compileBaseBenchmarks(self, astRoot):
+        try:
+            os.makedirs("%s/cpp/bench/base" % (self._srcPath))
+        except OSError:
+            pass
+
+        wfile = open("%s/cpp/bench/base/BaseBenchmarks.cpp" % (self._srcPath), "w", SourceCompiler.BUFFER_SIZE)
+
+        print >> wfile, '// auto-generatad base benchmarks C++ file'
+        print >> wfile, ''
+        print >> wfile, '#include "bench/BenchmarkFrontend.h"'
+        print >> wfile, '#include "bench/InspectorBenchmark.h"'
+        print >> wfile, '#include "bench/OutputCollectorBenchmark.h"'
+        print >> wfile, '#include "bench/PrFunctionBenchmark.h"'
+        print >> wfile, '#include "config/GeneratorConfig.h"'
+        print >> wfile, '#include "core/constants.h"'
+        print >> wfile, '#include "generator/GeneratorPool.h"'
+
+        for recordSequence in astRoot.getSpecification().getRecordSequences().getRecordSequences():
+            print >> wfile, '#include "generator/%sGenerator.h"' % (StringTransformer.us2ccAll(recordSequence.getAttribute("key")))
+
+        print >> wfile, ''
+        print >> wfile, 'namespace Myriad {'
+        print >> wfile, ''
+        print >> wfile, '/**'
+        print >> wfile, ' * Application name.'
+        print >> wfile, ' */'
+        print >> wfile, 'const String Constant::APP_NAME = "%s - Microbenchmarks";' % (self._args.dgen_name)
+        print >> wfile, ''
+        print >> wfile, '/**'
+        print >> wfile, ' * Application version.'
+        print >> wfile, ' */'
+        print >> wfile, 'const String Constant::APP_VERSION = "0.1.0";'
+        print >> wfile, ''
+        print >> wfile, 'void registerProjectBenchmarks(BenchmarkSuite& suite, GeneratorConfig& config, GeneratorPool& generatorPool)'
+        print >> wfile, '{'
+        print >> wfile, '    // register prototype function benchmarks'
+
+        nodeFilter = DepthFirstNodeFilter(filterType=AbstractFunctionNode)
+        for function in nodeFilter.getAll(astRoot.getSpecification().getFunctions()):
+            print >> wfile, '    suite.add(new PrFunctionBenchmark< %(t)s >("%(k)s", config.function< %(t)s >("%(k)s")));' % {'t': function.getConcreteType(), 'k': function.getAttribute("key")}
+
+        print >> wfile, ''
+        print >> wfile, '    // register record sequence benchmarks'
+
+        for recordSequence in astRoot.getSpecification().getRecordSequences().getRecordSequences():
+            parameters = {'ns': self._args.dgen_ns, 't': StringTransformer.us2ccAll(recordSequence.getAttribute("key"))}
+            print >> wfile, '    InspectorBenchmark<%(ns)s::%(t)s>::registerAll(suite, generatorPool.get<%(ns)s::%(t)sGenerator>());' % parameters
+            print >> wfile, '    OutputCollectorBenchmark<%(ns)s::%(t)s>::registerAll(suite, generatorPool.get<%(ns)s::%(t)sGenerator>());' % parameters
+
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, '} // Myriad namespace'
+        print >> wfile, ''
+        print >> wfile, '// define the benchmark main method'
+        print >> wfile, 'POCO_APP_MAIN(Myriad::BenchmarkFrontend)'
+
+        wfile.close()
+
+
 class GeneratorSubsystemCompiler(SourceCompiler):
     '''
     classdocs
@@ -633,7 +713,11 @@ class ConfigCompiler(SourceCompiler):
         nodeFilter = DepthFirstNodeFilter(filterType=AbstractFunctionNode)
         for function in nodeFilter.getAll(astRoot.getSpecification().getFunctions()):
             argsCode = ArgumentTransformer.compileConstructorArguments(function, {'config': None})
-            print >> wfile, '        function(new %(t)s(%(a)s));' % {'t': function.getConcreteType(), 'a': ', '.join(argsCode)}
+            if isinstance(function, (CombinedProbabilityFunctionNode, ConditionalCombinedProbabilityFunctionNode)):
+                # file based functions are loaded concurrently after configureSets()
+                print >> wfile, '        function< %(t)s >(%(a)s);' % {'t': function.getConcreteType(), 'a': ', '.join(argsCode)}
+            else:
+                print >> wfile, '        function(new %(t)s(%(a)s));' % {'t': function.getConcreteType(), 'a': ', '.join(argsCode)}
 
         print >> wfile, '    }'
         print >> wfile, ''
@@ -644,7 +728,7 @@ class ConfigCompiler(SourceCompiler):
         literalTransformer = LiteralTransfomer()
         nodeFilter = DepthFirstNodeFilter(filterType=EnumSetNode)
         for enumSet in nodeFilter.getAll(astRoot):
-            print >> wfile, '        enumSet(new MyriadEnumSet("%(n)s", %(p)s));' % {'n': enumSet.getAttribute("key"), 'p': literalTransformer.transform(enumSet.getArgument("path"), None).pop()}
+            print >> wfile, '        enumSet("%(n)s", %(p)s);' % {'n': enumSet.getAttribute("key"), 'p': literalTransformer.transform(enumSet.getArgument("path"), None).pop()}
 
         print >> wfile, '    }'
         print >> wfile, '};'
@@ -801,7 +885,7 @@ class RecordTypeCompiler(SourceCompiler):
         
         if recordType.hasEnumFields():
             print >> wfile, '    Base%(t)sMeta(const Myriad::EnumSetPool& enumSets) : ' % {'t': typeNameCC}
-            print >> wfile, '        %s' % ', '.join([ '%(n)s(enumSets.get("%(r)s").values())' % {'n': field.getAttribute("name"), 'r': field.getAttribute("enumref")} for field in recordType.getEnumFields() ])
+            print >> wfile, '        %s' % ', '.join([ '%(n)s(enumSets.get("%(r)s").values()), %(c)sEnumSet(enumSets.get("%(r)s"))' % {'n': field.getAttribute("name"), 'c': StringTransformer.us2cc(field.getAttribute("name")), 'r': field.getAttribute("enumref")} for field in recordType.getEnumFields() ])
             print >> wfile, '    {'
             print >> wfile, '    }'
         else:
@@ -812,6 +896,7 @@ class RecordTypeCompiler(SourceCompiler):
         print >> wfile, '    // enum set refecences'
         for field in recordType.getEnumFields():
             print >> wfile, '    const vector<String>& %s;' % field.getAttribute("name")
+            print >> wfile, '    const Myriad::MyriadEnumSet& %sEnumSet;' % StringTransformer.us2cc(field.getAttribute("name"))
         print >> wfile, '};'
         print >> wfile, ''
         print >> wfile, '} // namespace %s' % (self._args.dgen_ns)
@@ -937,6 +1022,7 @@ class RecordTypeCompiler(SourceCompiler):
                         print >> wfile, ''
                     else:
                         print >> wfile, '    const String& %sEnumValue() const;' % (StringTransformer.us2cc(field.getAttribute("name")))
+                        print >> wfile, '    Myriad::MyriadEnumSet::Bytes %sEnumBytes(Myriad::MyriadEnumSet::Rendering rendering) const;' % (StringTransformer.us2cc(field.getAttribute("name")))
                         print >> wfile, ''
                 else:
                     print >> wfile, ''
@@ -1014,6 +1100,11 @@ class RecordTypeCompiler(SourceCompiler):
                     print >> wfile, '    }'
                     print >> wfile, '}'
                     print >> wfile, ''
+                    print >> wfile, 'inline Myriad::MyriadEnumSet::Bytes Base%s::%sEnumBytes(Myriad::MyriadEnumSet::Rendering rendering) const' % (typeNameCC, StringTransformer.us2cc(field.getAttribute("name")))
+                    print >> wfile, '{'
+                    print >> wfile, '    return _meta.%(c)sEnumSet.bytes(_%(n)s, rendering);' % {'n': field.getAttribute("name"), 'c': StringTransformer.us2cc(field.getAttribute("name"))}
+                    print >> wfile, '}'
+                    print >> wfile, ''
         
         for reference in recordType.getReferences():
             print >> wfile, 'inline void Base%s::%s(const AutoPtr<%s>& v)' % (typeNameCC, StringTransformer.us2cc(reference.getAttribute("name")), reference.getAttribute("type"))
@@ -1077,7 +1168,7 @@ class RecordTypeCompiler(SourceCompiler):
                 fieldName = field.getAttribute("name")
                 
                 if fieldType == "Enum":
-                    print >> wfile, '    write(out, %s, %s);' % ("record." + StringTransformer.us2cc(fieldName) + "EnumValue()", outputFormatIsQuoted)
+                    print >> wfile, '    write(out, %s);' % ("record." + StringTransformer.us2cc(fieldName) + "EnumBytes(Myriad::MyriadEnumSet::%s)" % ("QUOTED" if outputFormatIsQuoted == 'true' else "PLAIN"))
                 elif fieldType == 'String' or (field.isVectorType() and field.coreType() == 'Char'):
                     print >> wfile, '    write(out, %s, %s);' % ("record." + StringTransformer.us2cc(fieldName) + "()", outputFormatIsQuoted)
                 else:
@@ -1087,6 +1178,160 @@ class RecordTypeCompiler(SourceCompiler):
             
         print >> wfile, '}'
         print >> wfile, ''
+        print >> wfile, 'template<>' 
+        print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::Base%(t)s>::serialize(char*& cursor, char* end, const %(ns)s::Base%(t)s& record)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        
+        if recordSequence.hasOutputFormatter() and outputFormatter.getAttribute("type") == "csv":
+            # produce the CSV output directly into the [cursor, end) buffer range
+            outputFormatDelimiter = outputFormatter.getArgument("delimiter").getAttribute("value")
+            outputFormatIsQuoted = str(outputFormatter.getArgument("quoted").getAttribute("value").lower() == 'true').lower()
+            outputFormatFields = outputFormatter.getArgument("field").getAll()
+            
+            # the literal length is an upper bound for the length of the (possibly escaped) delimiter
+            fixedWidth = [str(len(outputFormatDelimiter) * len(outputFormatFields) + 1)]
+            variableWidth = []
+            writeStatements = []
+            
+            for i, fieldRef in enumerate(outputFormatFields):
+                field = fieldRef.getFieldRef()
+                fieldType = field.getAttribute("type")
+                fieldName = field.getAttribute("name")
+                fieldGetter = "record." + StringTransformer.us2cc(fieldName)
+                fieldValue = StringTransformer.us2cc(fieldName) + "Value"
+                
+                if fieldType == "Enum":
+                    print >> wfile, '    const Myriad::MyriadEnumSet::Bytes %s = %s;' % (fieldValue, fieldGetter + "EnumBytes(Myriad::MyriadEnumSet::%s)" % ("QUOTED" if outputFormatIsQuoted == 'true' else "PLAIN"))
+                    variableWidth.append('maxFormattedLength(%s)' % (fieldValue))
+                    writeStatements.append('out = write(out, %s);' % (fieldValue))
+                elif fieldType == 'String' or field.isVectorType():
+                    print >> wfile, '    const %s& %s = %s();' % (field.sourceType(), fieldValue, fieldGetter)
+                    variableWidth.append('maxFormattedLength(%s)' % (fieldValue))
+                    if fieldType == 'String' or field.coreType() == 'Char':
+                        writeStatements.append('out = write(out, %s, %s);' % (fieldValue, outputFormatIsQuoted))
+                    else:
+                        writeStatements.append('out = write(out, %s, false);' % (fieldValue))
+                else:
+                    fixedWidth.append('ValueFormatter<%s>::MAX_LENGTH' % (field.sourceType()))
+                    writeStatements.append('out = write(out, %s(), false);' % (fieldGetter))
+                
+                if i < len(outputFormatFields) - 1:
+                    writeStatements.append('out = appendBytes(out, "%(d)s", sizeof("%(d)s") - 1);' % {'d': outputFormatDelimiter.replace('"', '\\"')})
+                else:
+                    writeStatements.append('out = appendBytes(out, "%(d)s\\n", sizeof("%(d)s\\n") - 1);' % {'d': outputFormatDelimiter.replace('"', '\\"')})
+            
+            if len(outputFormatFields) == 0:
+                writeStatements.append('out = appendBytes(out, "\\n", 1);')
+            
+            if len(variableWidth) > 0:
+                print >> wfile, ''
+            print >> wfile, '    // worst-case width of the fixed-width fields, the delimiters and the line end'
+            print >> wfile, '    const size_t fixedWidth = %s;' % (' + '.join(fixedWidth))
+            print >> wfile, ''
+            print >> wfile, '    if (static_cast<size_t>(end - cursor) < %s)' % (' + '.join(['fixedWidth'] + variableWidth))
+            print >> wfile, '    {'
+            print >> wfile, '        return false;'
+            print >> wfile, '    }'
+            print >> wfile, ''
+            print >> wfile, '    char* out = cursor;'
+            for statement in writeStatements:
+                print >> wfile, '    %s' % (statement)
+            print >> wfile, '    cursor = out;'
+            print >> wfile, ''
+        
+        print >> wfile, '    return true;'
+        print >> wfile, '}'
+        print >> wfile, ''
+        
+        # explicit scalar fields can be used for output partitioning
+        partitionFields = filter(lambda f: not f.isImplicit() and not f.isVectorType(), recordType.getFields())
+        
+        print >> wfile, 'template<>' 
+        print >> wfile, 'inline I32u AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionField(const String& name)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        for field in partitionFields:
+            print >> wfile, '    if (name == "%s")' % (field.getAttribute("name"))
+            print >> wfile, '    {'
+            print >> wfile, '        return RecordTraits<%s::%s>::%s;' % (self._args.dgen_ns, typeNameCC, StringTransformer.uc(field.getAttribute("name")))
+            print >> wfile, '    }'
+        print >> wfile, '    return 0;'
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>' 
+        print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionOrdered(I32u field)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    switch (field)'
+        print >> wfile, '    {'
+        for field in partitionFields:
+            print >> wfile, '    case RecordTraits<%s::%s>::%s:' % (self._args.dgen_ns, typeNameCC, StringTransformer.uc(field.getAttribute("name")))
+            print >> wfile, '        return PartitionKey<%s>::ORDERED;' % (field.sourceType())
+        print >> wfile, '    default:'
+        print >> wfile, '        return false;'
+        print >> wfile, '    }'
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>' 
+        print >> wfile, 'inline I64 AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionKey(const %(ns)s::Base%(t)s& record, I32u field)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    switch (field)'
+        print >> wfile, '    {'
+        for field in partitionFields:
+            print >> wfile, '    case RecordTraits<%s::%s>::%s:' % (self._args.dgen_ns, typeNameCC, StringTransformer.uc(field.getAttribute("name")))
+            print >> wfile, '        return PartitionKey<%s>::get(record.%s());' % (field.sourceType(), StringTransformer.us2cc(field.getAttribute("name")))
+        print >> wfile, '    default:'
+        print >> wfile, '        throw Poco::InvalidArgumentException("Unknown partitioning field");'
+        print >> wfile, '    }'
+        print >> wfile, '}'
+        print >> wfile, ''
+        
+        if recordSequence.hasOutputFormatter() and outputFormatter.getAttribute("type") == "columnar":
+            # produce the columnar layout and the columnar serialize method
+            outputFormatRowGroupSize = outputFormatter.getArgument("row_group_size").getAttribute("value")
+            outputFormatFields = outputFormatter.getArgument("field").getAll()
+            
+            columnTypes = []
+            for fieldRef in outputFormatFields:
+                field = fieldRef.getFieldRef()
+                if field.coreType() == "Enum":
+                    columnTypes.append("DictionaryColumn")
+                elif field.coreType() == "String":
+                    columnTypes.append("StringColumn")
+                else:
+                    columnTypes.append("PlainColumn<%s>" % (field.coreType()))
+            
+            print >> wfile, 'template<>' 
+            print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::Base%(t)s>::describe(ColumnarRowGroup& rowGroup)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+            print >> wfile, '{'
+            print >> wfile, '    rowGroup.capacity(%s);' % (outputFormatRowGroupSize)
+            for fieldRef, columnType in zip(outputFormatFields, columnTypes):
+                field = fieldRef.getFieldRef()
+                if field.isVectorType():
+                    print >> wfile, '    rowGroup.add(new %s("%s", %s));' % (columnType, field.getAttribute("name"), field.vectorTypeSize())
+                else:
+                    print >> wfile, '    rowGroup.add(new %s("%s"));' % (columnType, field.getAttribute("name"))
+            print >> wfile, '    return true;'
+            print >> wfile, '}'
+            print >> wfile, ''
+            print >> wfile, 'template<>' 
+            print >> wfile, 'inline void AbstractOutputCollector<%(ns)s::Base%(t)s>::serialize(ColumnarRowGroup& rowGroup, const %(ns)s::Base%(t)s& record)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+            print >> wfile, '{'
+            for i, (fieldRef, columnType) in enumerate(zip(outputFormatFields, columnTypes)):
+                field = fieldRef.getFieldRef()
+                fieldName = StringTransformer.us2cc(field.getAttribute("name"))
+                
+                if field.coreType() == "Enum" and field.isVectorType():
+                    print >> wfile, '    for (size_t i = 0; i < %s; i++)' % (field.vectorTypeSize())
+                    print >> wfile, '    {'
+                    print >> wfile, '        rowGroup.column< %s >(%d).append(record.%s().at(i), record.%sEnumValue(i));' % (columnType, i, fieldName, fieldName)
+                    print >> wfile, '    }'
+                elif field.coreType() == "Enum":
+                    print >> wfile, '    rowGroup.column< %s >(%d).append(record.%s(), record.%sEnumBytes(Myriad::MyriadEnumSet::PLAIN));' % (columnType, i, fieldName, fieldName)
+                else:
+                    print >> wfile, '    rowGroup.column< %s >(%d).append(record.%s());' % (columnType, i, fieldName)
+            print >> wfile, '    rowGroup.commitRow();'
+            print >> wfile, '}'
+            print >> wfile, ''
+        
         print >> wfile, '} // namespace Myriad'
         print >> wfile, ''
         print >> wfile, '#endif /* BASE%s_H_ */' % (typeNameUC)
@@ -1159,6 +1404,42 @@ class RecordTypeCompiler(SourceCompiler):
         print >> wfile, '    AbstractOutputCollector<%(ns)s::Base%(t)s>::serialize(out, record);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
         print >> wfile, '}'
         print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::%(t)s>::serialize(char*& cursor, char* end, const %(ns)s::%(t)s& record)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    return AbstractOutputCollector<%(ns)s::Base%(t)s>::serialize(cursor, end, record);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::%(t)s>::describe(ColumnarRowGroup& rowGroup)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    return AbstractOutputCollector<%(ns)s::Base%(t)s>::describe(rowGroup);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline void AbstractOutputCollector<%(ns)s::%(t)s>::serialize(ColumnarRowGroup& rowGroup, const %(ns)s::%(t)s& record)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    AbstractOutputCollector<%(ns)s::Base%(t)s>::serialize(rowGroup, record);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline I32u AbstractOutputCollector<%(ns)s::%(t)s>::partitionField(const String& name)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    return AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionField(name);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline bool AbstractOutputCollector<%(ns)s::%(t)s>::partitionOrdered(I32u field)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    return AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionOrdered(field);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
+        print >> wfile, 'template<>'
+        print >> wfile, 'inline I64 AbstractOutputCollector<%(ns)s::%(t)s>::partitionKey(const %(ns)s::%(t)s& record, I32u field)' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '{'
+        print >> wfile, '    return AbstractOutputCollector<%(ns)s::Base%(t)s>::partitionKey(record, field);' % {'ns': self._args.dgen_ns, 't': typeNameCC}
+        print >> wfile, '}'
+        print >> wfile, ''
         print >> wfile, '} // namespace Myriad'
         print >> wfile, ''
         print >> wfile, '#endif /* %s_H_ */' % (typeNameUC)
@@ -1334,6 +1615,7 @@ class SetterChainCompiler(SourceCompiler):
         print >> wfile, ''
         print >> wfile, '#include "config/GeneratorConfig.h"'
         print >> wfile, '#include "runtime/setter/SetterChain.h"'
+        print >> wfile, '#include "runtime/setter/SetterProfiler.h"'
         
         for referenceType in recordSequence.getRecordType().getReferenceTypes():
             print >> wfile, '#include "generator/%sGenerator.h"' % (referenceType)
@@ -1377,9 +1659,12 @@ class SetterChainCompiler(SourceCompiler):
             argsCode = ArgumentTransformer.compileConstructorArguments(node, {'config': 'config'})
             print >> wfile, '        %s(%s),' % (node.getAttribute("var_name"), ', '.join(argsCode))
         
+        print >> wfile, '        _profiler("%s", opMode == Myriad::BaseSetterChain::SEQUENTIAL ? config.setterProfileInterval() : 0),' % (typeNameUS)
         print >> wfile, '        _logger(Logger::get("%s.setter.chain"))' % (typeNameUS)
             
         print >> wfile, '    {'
+        for setter in recordSequence.getSetterChain().getAll():
+            print >> wfile, '        _profiler.add("%s");' % (setter.getAttribute("key"))
         print >> wfile, '    }'
         print >> wfile, ''
         print >> wfile, '    virtual ~Base%sSetterChain()' % (typeNameCC)
@@ -1395,6 +1680,18 @@ class SetterChainCompiler(SourceCompiler):
         print >> wfile, ''
         print >> wfile, '        Base%(t)sSetterChain* me = const_cast<Base%(t)sSetterChain*>(this);' % {'t': typeNameCC}
         print >> wfile, ''
+        print >> wfile, '        if (me->_profiler.sample())'
+        print >> wfile, '        {'
+        print >> wfile, '            // apply setter chain and profile each setter'
+        print >> wfile, '            I64u cycles = me->_profiler.start();'
+
+        for i, setter in enumerate(recordSequence.getSetterChain().getAll()):
+            print >> wfile, '            me->%s(recordPtr, me->_random);' % (setter.getAttribute("var_name"))
+            print >> wfile, '            cycles = me->_profiler.stop(%d, cycles);' % (i)
+        
+        print >> wfile, '            return;'
+        print >> wfile, '        }'
+        print >> wfile, ''
         print >> wfile, '        // apply setter chain'
 
         for setter in recordSequence.getSetterChain().getAll():
@@ -1444,6 +1741,9 @@ class SetterChainCompiler(SourceCompiler):
                 print >> wfile, '    %s %s;' % (node.getAttribute("type_alias"), node.getAttribute("var_name"))
             print >> wfile, ''
         
+        print >> wfile, '    // setter profiler'
+        print >> wfile, '    Myriad::SetterProfiler _profiler;'
+        print >> wfile, ''
         print >> wfile, '    // Logger instance.'
         print >> wfile, '    Logger& _logger;'
         print >> wfile, '};'
@@ -1581,6 +1881,8 @@ class AbstractSequenceGeneratorCompiler(SourceCompiler):
         print >> wfile, '    Base%sGenerator(const string& name, Myriad::GeneratorConfig& config, NotificationCenter& notificationCenter) :' % (typeNameCC)
         print >> wfile, '        Myriad::RandomSequenceGenerator<%s>(name, config, notificationCenter)' % (typeNameCC)
         print >> wfile, '    {'
+        for referenceKey in sorted(set(r.getAttribute('key') for r in recordSequence.getRecordType().getReferences() if isinstance(r, ResolvedRecordReferenceNode))):
+            print >> wfile, '        dependsOn("%s");' % (referenceKey)
         print >> wfile, '    }'
         print >> wfile, ''
         print >> wfile, '    void prepare(Stage stage, const Myriad::GeneratorPool& pool)'
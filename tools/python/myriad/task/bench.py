@@ -0,0 +1,344 @@
+'''
+Copyright 2010-2013 DIMA Research Group, TU Berlin
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Created on Oct 18, 2013
+
+@author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
+'''
+
+import json
+import optparse
+import os
+import re
+import shutil
+import socket
+import sys
+import tempfile
+import threading
+import time
+
+import myriad.task.common
+from subprocess import Popen, PIPE, STDOUT
+
+TASK_PREFIX = "bench"
+
+class PrototypesBenchmarkTask(myriad.task.common.AbstractTask):
+    '''
+    Builds a fixed set of prototype projects against the current toolkit
+    sources and measures the end-to-end generation throughput, the startup
+    time and the peak RSS of the compiled data generator nodes for different
+    output types. The results are compared against the baseline given with
+    `--baseline` and the task fails if the baseline is missing, if the number
+    of generated records differs, or if one of the metrics regresses beyond
+    the configured limits. With `--save-baseline`, the results are stored as
+    the new baseline instead.
+    '''
+
+    PROTOTYPES = ['customer', 'wide', 'reference', 'clustered']
+    OUTPUTS = ['void', 'file', 'socket']
+
+    __startupPattern = re.compile(r"Starting generation for node")
+    __progressPattern = re.compile(r"(\d+) records \(.*\), (\d+) bytes \(.*\)")
+
+    def __init__(self, *args, **kwargs):
+        '''
+        Constructor
+        '''
+        kwargs.update(group=TASK_PREFIX, name="prototypes", description="Benchmark the end-to-end throughput of a fixed set of prototypes.")
+        super(PrototypesBenchmarkTask, self).__init__(*args, **kwargs)
+
+    def argsParser(self):
+        parser = super(PrototypesBenchmarkTask, self).argsParser()
+
+        # options
+        parser.add_option("--poco-prefix", metavar="PREFIX", dest="poco_prefix", type="str",
+                          default="/usr/local", help="installation prefix of the Poco libraries (defaults to `/usr/local`)")
+        parser.add_option("--work-dir", metavar="DIR", dest="work_path", type="str",
+                          default=None, help="directory for the benchmark projects and results (defaults to `${TMPDIR}/myriad-bench`)")
+        parser.add_option("--prototypes", metavar="LIST", dest="prototypes", type="str",
+                          default=','.join(PrototypesBenchmarkTask.PROTOTYPES), help="comma separated list of prototypes to benchmark (defaults to `%s`)" % ','.join(PrototypesBenchmarkTask.PROTOTYPES))
+        parser.add_option("--outputs", metavar="LIST", dest="outputs", type="str",
+                          default=','.join(PrototypesBenchmarkTask.OUTPUTS), help="comma separated list of output types to benchmark (defaults to `%s`)" % ','.join(PrototypesBenchmarkTask.OUTPUTS))
+        parser.add_option("-s", "--scaling-factor", metavar="SF", dest="scaling_factor", type="float",
+                          default=1000.0, help="scaling factor passed to the data generator nodes (defaults to `1000`)")
+        parser.add_option("--repetitions", metavar="N", dest="repetitions", type="int",
+                          default=3, help="number of runs per prototype and output type, the median is reported (defaults to `3`)")
+        parser.add_option("--baseline", metavar="FILE", dest="baseline_path", type="str",
+                          default=None, help="baseline results to compare against or to save (required)")
+        parser.add_option("--save-baseline", dest="save_baseline", action="store_true",
+                          default=False, help="store the results as new baseline instead of comparing against it")
+        parser.add_option("--max-throughput-drop", metavar="RATIO", dest="max_throughput_drop", type="float",
+                          default=0.10, help="maximal relative throughput drop w.r.t. the baseline (defaults to `0.10`)")
+        parser.add_option("--max-rss-increase", metavar="RATIO", dest="max_rss_increase", type="float",
+                          default=0.20, help="maximal relative peak RSS increase w.r.t. the baseline (defaults to `0.20`)")
+        parser.add_option("--max-startup-increase", metavar="RATIO", dest="max_startup_increase", type="float",
+                          default=0.25, help="maximal relative startup time increase w.r.t. the baseline (defaults to `0.25`)")
+
+        return parser
+
+    def _fixArgs(self, args):
+        super(PrototypesBenchmarkTask, self)._fixArgs(args)
+
+        if args.work_path is None:
+            args.work_path = "%s/myriad-bench" % (tempfile.gettempdir())
+        args.work_path = os.path.realpath(args.work_path)
+
+        # baselines are host specific, so there is no implicit default
+        if args.baseline_path is None:
+            raise myriad.task.common.TaskExecutionException("Missing baseline file, use `--baseline` (together with `--save-baseline` to record a new one)")
+        args.baseline_path = os.path.realpath(args.baseline_path)
+
+        if not args.save_baseline and not os.path.exists(args.baseline_path):
+            raise myriad.task.common.TaskExecutionException("No baseline found at `%s`, record one with `--save-baseline`" % (args.baseline_path))
+
+        args.prototypes = [ p.strip() for p in args.prototypes.split(',') if p.strip() ]
+        args.outputs = [ o.strip() for o in args.outputs.split(',') if o.strip() ]
+
+        for p in args.prototypes:
+            if p not in PrototypesBenchmarkTask.PROTOTYPES:
+                raise myriad.task.common.TaskExecutionException("Unknown benchmark prototype `%s`" % (p))
+        for o in args.outputs:
+            if o not in PrototypesBenchmarkTask.OUTPUTS:
+                raise myriad.task.common.TaskExecutionException("Unsupported benchmark output type `%s`" % (o))
+
+        args.repetitions = max(1, args.repetitions)
+
+    def _requiresMyriadSettings(self):
+        return False
+
+    def _do(self, args):
+        toolkitBase = os.path.realpath(args.base_path)
+
+        results = {
+            'version': open("%s/VERSION" % (toolkitBase)).read().strip(),
+            'scaling_factor': args.scaling_factor,
+            'host': socket.gethostname(),
+            'runs': {}
+        }
+
+        for prototype in args.prototypes:
+            projectBase = self.__buildProject(prototype, toolkitBase, args)
+
+            for output in args.outputs:
+                runs = [ self.__runNode(prototype, projectBase, output, args) for _ in range(args.repetitions) ]
+                results['runs']["%s/%s" % (prototype, output)] = self.__median(runs)
+
+        self.__report(results)
+
+        resultsPath = "%s/results.json" % (args.work_path)
+        self.__dump(results, resultsPath)
+        self._log.info("Benchmark results written to `%s`." % (resultsPath))
+
+        if args.save_baseline:
+            self.__dump(results, args.baseline_path)
+            self._log.info("Benchmark baseline written to `%s`." % (args.baseline_path))
+        else:
+            self.__compare(results, json.load(open(args.baseline_path)), args)
+
+    def __buildProject(self, prototype, toolkitBase, args):
+        projectBase = "%s/%s" % (args.work_path, prototype)
+        vendorBase = "%s/vendor/myriad-toolkit" % (projectBase)
+
+        self._log.info("Building benchmark project for prototype `%s` in `%s`." % (prototype, projectBase))
+
+        # start from a clean project that links to the current toolkit sources
+        if os.path.exists(projectBase):
+            shutil.rmtree(projectBase)
+        os.makedirs(vendorBase)
+        for entry in os.listdir(toolkitBase):
+            if not entry.startswith('.'):
+                os.symlink("%s/%s" % (toolkitBase, entry), "%s/%s" % (vendorBase, entry))
+
+        assistant = [ sys.executable, "%s/bin/assistant" % (vendorBase) ]
+
+        self.__call(assistant + [ "initialize:project", "--ns=__%s" % (prototype), prototype ], projectBase)
+        if prototype != 'customer':
+            skeletonBase = "%s/tools/skeleton/task/%s/prototype/%s" % (toolkitBase, self.group(), prototype)
+            skeletonProcessor = myriad.task.common.SkeletonProcessor(skeletonBase)
+            skeletonProcessor.process(projectBase, optparse.Values({ 'dgen_name': prototype }))
+        # existing prototype files are kept, so this only adds the shared domains and distributions
+        self.__call(assistant + [ "initialize:prototype", "customer" ], projectBase)
+
+        self.__call([ "./configure", "--poco-prefix=%s" % (args.poco_prefix) ], projectBase)
+        for target in [ "prototype", "distributions", "all" ]:
+            self.__call([ "make", target ], "%s/build" % (projectBase))
+
+        return projectBase
+
+    def __runNode(self, prototype, projectBase, output, args):
+        buildBase = "%s/build" % (projectBase)
+        dataBase = "%s/data" % (projectBase)
+        jobID = "bench-%s" % (output)
+
+        if os.path.exists(dataBase):
+            shutil.rmtree(dataBase)
+        os.makedirs(dataBase)
+
+        listener = None
+        outputType = output
+        if output == 'socket':
+            listener = SocketDrain()
+            listener.start()
+            outputType = "socket[%d]" % (listener.port())
+
+        command = [ "%s/bin/%s-node" % (buildBase, prototype), "-s", "%s" % (args.scaling_factor), "-m", jobID, "-o", dataBase, "-t", outputType ]
+
+        self._log.info("Running `%s`." % ' '.join(command))
+
+        start = time.time()
+        startup = None
+        console = []
+        proc = Popen(command, cwd=buildBase, stdout=PIPE, stderr=STDOUT)
+        for line in iter(proc.stdout.readline, ''):
+            if startup is None and self.__startupPattern.search(line):
+                startup = time.time() - start
+            console.append(line)
+        (_, status, usage) = os.wait4(proc.pid, 0)
+        wall = time.time() - start
+
+        if listener is not None:
+            listener.stop()
+
+        if os.WIFSIGNALED(status):
+            raise myriad.task.common.TaskExecutionException("Node for prototype `%s` was killed by signal %d:\n%s" % (prototype, os.WTERMSIG(status), ''.join(console[-20:])))
+        if os.WEXITSTATUS(status) != 0:
+            raise myriad.task.common.TaskExecutionException("Node for prototype `%s` exited with status %d:\n%s" % (prototype, os.WEXITSTATUS(status), ''.join(console[-20:])))
+
+        # the progress totals are logged to the node log, or to the console if it is used for the output
+        logPath = "%s/%s/log/node000.log" % (dataBase, jobID)
+        lines = open(logPath).readlines() if os.path.exists(logPath) else console
+        totals = [ m for m in map(self.__progressPattern.search, lines) if m ]
+        if not totals:
+            raise myriad.task.common.TaskExecutionException("No progress totals found for prototype `%s`" % (prototype))
+
+        records = long(totals[-1].group(1))
+        bytes = long(totals[-1].group(2))
+        startup = startup if startup is not None else 0.0
+        elapsed = max(wall - startup, 1e-6)
+
+        return {
+            'records': records,
+            'bytes': bytes,
+            'startup_s': startup,
+            'wall_s': wall,
+            'records_per_s': records / elapsed,
+            'mb_per_s': bytes / elapsed / (1024.0 * 1024.0),
+            'peak_rss_kb': usage.ru_maxrss
+        }
+
+    def __median(self, runs):
+        result = {}
+        for key in runs[0].keys():
+            values = sorted([ r[key] for r in runs ])
+            result[key] = values[len(values) / 2]
+        return result
+
+    def __report(self, results):
+        self._log.info("")
+        self._log.info("%-24s %14s %10s %10s %12s" % ("prototype/output", "records/s", "MB/s", "startup s", "peak RSS KB"))
+        for key in sorted(results['runs'].keys()):
+            r = results['runs'][key]
+            self._log.info("%-24s %14.0f %10.2f %10.3f %12d" % (key, r['records_per_s'], r['mb_per_s'], r['startup_s'], r['peak_rss_kb']))
+        self._log.info("")
+
+    def __compare(self, results, baseline, args):
+        if baseline.get('scaling_factor') != results['scaling_factor']:
+            raise myriad.task.common.TaskExecutionException("Baseline scaling factor %s does not match %s" % (baseline.get('scaling_factor'), results['scaling_factor']))
+
+        regressions = []
+        for (key, r) in sorted(results['runs'].items()):
+            b = baseline['runs'].get(key)
+            if b is None:
+                regressions.append("%s: no baseline run" % (key))
+                continue
+
+            # the throughput is only comparable for the same output
+            if r['records'] != b['records']:
+                regressions.append("%s: generated %d records instead of %d" % (key, r['records'], b['records']))
+                continue
+
+            if r['records_per_s'] < b['records_per_s'] * (1.0 - args.max_throughput_drop):
+                regressions.append("%s: throughput dropped from %.0f to %.0f records/s" % (key, b['records_per_s'], r['records_per_s']))
+            if r['peak_rss_kb'] > b['peak_rss_kb'] * (1.0 + args.max_rss_increase):
+                regressions.append("%s: peak RSS increased from %d to %d KB" % (key, b['peak_rss_kb'], r['peak_rss_kb']))
+            # allow some absolute slack for very short startup times
+            if r['startup_s'] > b['startup_s'] * (1.0 + args.max_startup_increase) + 0.1:
+                regressions.append("%s: startup time increased from %.3f to %.3f s" % (key, b['startup_s'], r['startup_s']))
+
+        for regression in regressions:
+            self._log.error(regression)
+
+        if regressions:
+            raise myriad.task.common.TaskExecutionException("%d performance regression(s) w.r.t. baseline `%s`" % (len(regressions), args.baseline_path))
+
+        self._log.info("No performance regressions w.r.t. baseline `%s`." % (args.baseline_path))
+
+    def __call(self, command, cwd):
+        self._log.info("Running `%s` in `%s`." % (' '.join(command), cwd))
+
+        proc = Popen(command, cwd=cwd, stdout=PIPE, stderr=STDOUT)
+        (out, _) = proc.communicate()
+        if proc.returncode != 0:
+            for line in out.split('\n')[-40:]:
+                self._log.error(line)
+            raise myriad.task.common.TaskExecutionException("Command `%s` failed with status %d" % (' '.join(command), proc.returncode))
+
+    def __dump(self, results, path):
+        if not os.path.exists(os.path.dirname(path)):
+            os.makedirs(os.path.dirname(path))
+        f = open(path, 'w')
+        json.dump(results, f, indent=2, sort_keys=True)
+        f.close()
+
+
+class SocketDrain(threading.Thread):
+    '''
+    Accepts the connections of the socket output collectors on an ephemeral
+    localhost port and discards all received data.
+    '''
+
+    def __init__(self):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.__socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.__socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.__socket.bind(('localhost', 0))
+        self.__socket.listen(16)
+        self.__socket.settimeout(0.2)
+        self.__running = True
+
+    def port(self):
+        return self.__socket.getsockname()[1]
+
+    def stop(self):
+        self.__running = False
+        self.join()
+        self.__socket.close()
+
+    def run(self):
+        while self.__running:
+            try:
+                (connection, _) = self.__socket.accept()
+            except socket.timeout:
+                continue
+            drain = threading.Thread(target=self.__drain, args=(connection,))
+            drain.daemon = True
+            drain.start()
+
+    def __drain(self, connection):
+        connection.settimeout(None)
+        while connection.recv(1 << 16):
+            pass
+        connection.close()
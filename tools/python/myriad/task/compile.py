@@ -18,6 +18,7 @@ Created on Oct 14, 2011
 @author: Alexander Alexandrov <alexander.alexandrov@tu-berlin.de>
 '''
 
+from myriad.compiler.binary import BinarySpecificationCompiler
 from myriad.compiler.debug import PrintVisitor #@UnusedImport
 from myriad.compiler.reader import PrototypeSpecificationReader
 from myriad.compiler.source import * #@UnusedWildImport
@@ -68,6 +69,9 @@ class CompilePrototypeTask(AbstractTask):
         # compile output collector
         frontendCompiler = FrontendCompiler(args=args)
         frontendCompiler.compileCode(ast)
+        # compile benchmarks
+        benchmarkCompiler = BenchmarkCompiler(args=args)
+        benchmarkCompiler.compileCode(ast)
         # compile generator config
         generatorSubsystemCompiler = GeneratorSubsystemCompiler(args=args)
         generatorSubsystemCompiler.compileCode(ast)
@@ -85,6 +89,41 @@ class CompilePrototypeTask(AbstractTask):
         generatorCompiler.compileCode(ast.getSpecification().getRecordSequences())
 
 
+class CompileDistributionsTask(AbstractTask):
+    '''
+    classdocs
+    '''
+
+    def __init__(self, *args, **kwargs):
+        '''
+        Constructor
+        '''
+        kwargs.update(group=TASK_PREFIX, name="distributions", description="Compile *.distribution and *.domain files into binary specifications.")
+
+        super(CompileDistributionsTask, self).__init__(*args, **kwargs)
+
+    def argsParser(self):
+        parser = super(CompileDistributionsTask, self).argsParser()
+
+        # arguments
+        parser.add_option("--config-dir", metavar="CONFIG_DIR", dest="config_path", type="str",
+                          default=None, help="path to the config directory to be compiled (defaults to `${base-path}/../../src/config`)")
+
+        return parser
+
+    def _fixArgs(self, args):
+        super(CompileDistributionsTask, self)._fixArgs(args)
+
+        if (args.config_path == None):
+            args.config_path = "%s/../../src/config" % (args.base_path)
+
+        args.config_path = os.path.realpath(args.config_path)
+
+    def _do(self, args):
+        compiler = BinarySpecificationCompiler(args=args)
+        compiler.compileAll(args.config_path)
+
+
 class CompileOligosTask(AbstractTask):
     '''
     classdocs
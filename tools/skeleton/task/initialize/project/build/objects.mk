@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lPocoFoundation -lPocoNet -lPocoUtil -lPocoXML
+LIBS := -lPocoFoundation -lPocoNet -lPocoUtil -lPocoXML -lrt
 
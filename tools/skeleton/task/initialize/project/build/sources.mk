@@ -13,6 +13,7 @@ CXX_SRCS :=
 C++_SRCS := 
 CC_SRCS := 
 OBJS := 
+BENCH_OBJS := 
 C++_DEPS := 
 C_DEPS := 
 CC_DEPS := 
@@ -31,7 +32,9 @@ vendor/myriad-toolkit/src/cpp/core/types \
 vendor/myriad-toolkit/src/cpp/core \
 vendor/myriad-toolkit/src/cpp/config \
 vendor/myriad-toolkit/src/cpp/communication \
+vendor/myriad-toolkit/src/cpp/bench \
 src/cpp/generator/base \
+src/cpp/bench/base \
 src/cpp/generator \
 src/cpp/core \
 
@@ -0,0 +1,25 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+# (linked only into the benchmark binary, see `make bench`)
+CPP_SRCS += \
+../src/cpp/bench/base/BaseBenchmarks.cpp 
+
+BENCH_OBJS += \
+./src/cpp/bench/base/BaseBenchmarks.o 
+
+CPP_DEPS += \
+./src/cpp/bench/base/BaseBenchmarks.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+src/cpp/bench/base/%.o: ../src/cpp/bench/base/%.cpp
+	@echo 'Building file: $<'
+	@echo 'Invoking: GCC C++ Compiler'
+	g++ -I"$(POCO_INCLUDE_PATH)" $(LZ4_CPPFLAGS) -I"../src/cpp" -I"../vendor/myriad-toolkit/src/cpp" -O2 -Wall -c -fmessage-length=0 -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+